@@ -0,0 +1,351 @@
+// -------------------------------------------------------------------
+// benchmark.c
+//
+// Small benchmark for the stereo delay plugin. It loads
+// delay_stereo.so the way a host would, feeds it exponentially
+// decaying noise that ends up in the subnormal range and prints the
+// time spent per sample for consecutive segments of the tail. The
+// plugin runs with subnormals flushed to zero, so the last segments
+// count as silence and take the idle path of the channels, which
+// checks its input with the same vector kernels as the active path.
+// The numbers should therefore stay flat all the way down. A sudden
+// rise shows either subnormal numbers reaching the arithmetic or a
+// silence check that costs more than processing the signal.
+//
+// Afterwards it runs many instances side by side, the way a large
+// session does, once with equal delays on both channels and once with
+// delays far apart. Comparing these numbers between a library built
+// with and one built without SDL_INTERLEAVED_RING shows which layout
+// of the ring buffers suits a deployment.
+//
+// Usage: benchmark [plugin path...]
+// -------------------------------------------------------------------
+
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCHMARK_UNIT "cycles"
+#else
+#define BENCHMARK_UNIT "ns"
+#endif
+
+// -------------------------------------------------------------------
+
+#include "ladspa.h"
+
+// -------------------------------------------------------------------
+
+#define BENCHMARK_SAMPLE_RATE 44100
+#define BENCHMARK_BLOCK_SIZE 256
+#define BENCHMARK_INSTANCES 16
+#define BENCHMARK_SEGMENTS 16
+#define BENCHMARK_BLOCKS_PER_SEGMENT 64
+
+// The decay is chosen so that the input falls from full scale into
+// the subnormal range (below about 1e-38) in the last few segments.
+#define BENCHMARK_DECAY_PER_SEGMENT 1e-3
+
+// The layout benchmark runs this many instances, enough for their
+// ring buffers to exceed the caches and the reach of the TLB by far.
+#define BENCHMARK_LAYOUT_INSTANCES 64
+#define BENCHMARK_LAYOUT_BLOCKS 256
+
+// The delays of the tail benchmark and of both layout benchmarks (in
+// seconds).
+#define BENCHMARK_SHORT_DELAY 0.01
+#define BENCHMARK_LONG_DELAY 1.3
+
+// -------------------------------------------------------------------
+
+// Read a timestamp in BENCHMARK_UNIT.
+static unsigned long long readTimestamp(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  return __rdtsc();
+#else
+  struct timespec sTime;
+  clock_gettime(CLOCK_MONOTONIC, &sTime);
+  return (unsigned long long)sTime.tv_sec * 1000000000ULL + sTime.tv_nsec;
+#endif
+}
+
+// -------------------------------------------------------------------
+
+// Choose a value for every control input port: fDelayLeft for the
+// first delay, fDelayRight for any further one, a balanced dry/wet mix,
+// and the lower bound (or 0) for anything else.
+static void setupControls(const LADSPA_Descriptor* psDescriptor,
+			  LADSPA_Data* pfControls,
+			  LADSPA_Data fDelayLeft,
+			  LADSPA_Data fDelayRight) {
+
+  const LADSPA_PortRangeHint* psHint;
+  unsigned long lPort;
+  unsigned long lDelayCount;
+
+  // -----------------------------------------------------------------
+
+  lDelayCount = 0;
+  for (lPort = 0; lPort < psDescriptor->PortCount; lPort++) {
+    psHint = psDescriptor->PortRangeHints + lPort;
+    if (strncmp(psDescriptor->PortNames[lPort], "Delay", 5) == 0)
+      pfControls[lPort] = lDelayCount++ ? fDelayRight : fDelayLeft;
+    else if (strncmp(psDescriptor->PortNames[lPort], "Dry/Wet", 7) == 0)
+      pfControls[lPort] = 0.5;
+    else if (LADSPA_IS_HINT_BOUNDED_BELOW(psHint->HintDescriptor))
+      pfControls[lPort] = psHint->LowerBound;
+    else
+      pfControls[lPort] = 0;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Connect the ports of an instance. Both channels are fed the same
+// input; the outputs are assigned in port order.
+static void connectPorts(const LADSPA_Descriptor* psDescriptor,
+			 LADSPA_Handle hInstance,
+			 LADSPA_Data* pfControls,
+			 LADSPA_Data* pfInput,
+			 LADSPA_Data* pfOutputLeft,
+			 LADSPA_Data* pfOutputRight) {
+
+  LADSPA_PortDescriptor iPortDescriptor;
+  unsigned long lPort;
+  unsigned long lOutputCount;
+
+  // -----------------------------------------------------------------
+
+  lOutputCount = 0;
+  for (lPort = 0; lPort < psDescriptor->PortCount; lPort++) {
+    iPortDescriptor = psDescriptor->PortDescriptors[lPort];
+    if (LADSPA_IS_PORT_CONTROL(iPortDescriptor))
+      psDescriptor->connect_port(hInstance, lPort, pfControls + lPort);
+    else if (LADSPA_IS_PORT_INPUT(iPortDescriptor))
+      psDescriptor->connect_port(hInstance, lPort, pfInput);
+    else
+      psDescriptor->connect_port(hInstance, lPort,
+				 lOutputCount++ ? pfOutputRight
+				 : pfOutputLeft);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run the tail of decaying noise through BENCHMARK_INSTANCES instances
+// and print the time per sample for each segment.
+static void runTailBenchmark(const LADSPA_Descriptor* psDescriptor) {
+
+  LADSPA_Handle ahInstances[BENCHMARK_INSTANCES];
+  LADSPA_Data* pfInput;
+  LADSPA_Data* pfOutputLeft;
+  LADSPA_Data* pfOutputRight;
+  LADSPA_Data* pfControls;
+  double dLevel;
+  double dDecayPerSample;
+  unsigned long long llStart;
+  unsigned long long llElapsed;
+  unsigned long lInstance;
+  unsigned long lSegment;
+  unsigned long lBlock;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  pfInput = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfOutputLeft = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfOutputRight = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfControls = malloc(sizeof(LADSPA_Data) * psDescriptor->PortCount);
+  setupControls(psDescriptor, pfControls,
+		BENCHMARK_SHORT_DELAY, BENCHMARK_SHORT_DELAY);
+
+  for (lInstance = 0; lInstance < BENCHMARK_INSTANCES; lInstance++) {
+    ahInstances[lInstance]
+      = psDescriptor->instantiate(psDescriptor, BENCHMARK_SAMPLE_RATE);
+    connectPorts(psDescriptor, ahInstances[lInstance], pfControls,
+		 pfInput, pfOutputLeft, pfOutputRight);
+    if (psDescriptor->activate)
+      psDescriptor->activate(ahInstances[lInstance]);
+  }
+
+  // -----------------------------------------------------------------
+
+  printf("segment  input level  %s/sample\n", BENCHMARK_UNIT);
+
+  dLevel = 1;
+  dDecayPerSample = pow(BENCHMARK_DECAY_PER_SEGMENT,
+			1.0 / (BENCHMARK_BLOCKS_PER_SEGMENT
+			       * BENCHMARK_BLOCK_SIZE));
+  srand(1);
+
+  for (lSegment = 0; lSegment < BENCHMARK_SEGMENTS; lSegment++) {
+
+    printf("%7lu  %11.3g", lSegment, dLevel);
+    llElapsed = 0;
+
+    for (lBlock = 0; lBlock < BENCHMARK_BLOCKS_PER_SEGMENT; lBlock++) {
+
+      // The input is generated with the default floating point
+      // environment, so it really contains subnormal numbers.
+      for (lSampleIndex = 0;
+	   lSampleIndex < BENCHMARK_BLOCK_SIZE;
+	   lSampleIndex++) {
+	pfInput[lSampleIndex]
+	  = (LADSPA_Data)(dLevel * (2.0 * rand() / RAND_MAX - 1));
+	dLevel *= dDecayPerSample;
+      }
+
+      llStart = readTimestamp();
+      for (lInstance = 0; lInstance < BENCHMARK_INSTANCES; lInstance++)
+	psDescriptor->run(ahInstances[lInstance], BENCHMARK_BLOCK_SIZE);
+      llElapsed += readTimestamp() - llStart;
+    }
+
+    printf("  %15.3f\n",
+	   (double)llElapsed
+	   / ((double)BENCHMARK_INSTANCES
+	      * BENCHMARK_BLOCKS_PER_SEGMENT
+	      * BENCHMARK_BLOCK_SIZE));
+  }
+
+  // -----------------------------------------------------------------
+
+  for (lInstance = 0; lInstance < BENCHMARK_INSTANCES; lInstance++) {
+    if (psDescriptor->deactivate)
+      psDescriptor->deactivate(ahInstances[lInstance]);
+    psDescriptor->cleanup(ahInstances[lInstance]);
+  }
+  free(pfInput);
+  free(pfOutputLeft);
+  free(pfOutputRight);
+  free(pfControls);
+}
+
+// -------------------------------------------------------------------
+
+// Run noise through BENCHMARK_LAYOUT_INSTANCES instances, each with
+// delays of fDelayLeft and fDelayRight seconds, and print the time per
+// sample. Every instance is run once per block in turn, so the caches
+// are cold for each of them just like in a large session.
+static void runLayoutBenchmark(const LADSPA_Descriptor* psDescriptor,
+			       LADSPA_Data fDelayLeft,
+			       LADSPA_Data fDelayRight) {
+
+  LADSPA_Handle* phInstances;
+  LADSPA_Data* pfInput;
+  LADSPA_Data* pfOutputLeft;
+  LADSPA_Data* pfOutputRight;
+  LADSPA_Data* pfControls;
+  unsigned long long llStart;
+  unsigned long long llElapsed;
+  unsigned long lInstance;
+  unsigned long lBlock;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  phInstances = malloc(sizeof(LADSPA_Handle) * BENCHMARK_LAYOUT_INSTANCES);
+  pfInput = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfOutputLeft = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfOutputRight = malloc(sizeof(LADSPA_Data) * BENCHMARK_BLOCK_SIZE);
+  pfControls = malloc(sizeof(LADSPA_Data) * psDescriptor->PortCount);
+  setupControls(psDescriptor, pfControls, fDelayLeft, fDelayRight);
+
+  for (lInstance = 0; lInstance < BENCHMARK_LAYOUT_INSTANCES; lInstance++) {
+    phInstances[lInstance]
+      = psDescriptor->instantiate(psDescriptor, BENCHMARK_SAMPLE_RATE);
+    connectPorts(psDescriptor, phInstances[lInstance], pfControls,
+		 pfInput, pfOutputLeft, pfOutputRight);
+    if (psDescriptor->activate)
+      psDescriptor->activate(phInstances[lInstance]);
+  }
+
+  // -----------------------------------------------------------------
+
+  srand(1);
+  llElapsed = 0;
+
+  for (lBlock = 0; lBlock < BENCHMARK_LAYOUT_BLOCKS; lBlock++) {
+    for (lSampleIndex = 0;
+	 lSampleIndex < BENCHMARK_BLOCK_SIZE;
+	 lSampleIndex++)
+      pfInput[lSampleIndex] = (LADSPA_Data)(2.0 * rand() / RAND_MAX - 1);
+
+    llStart = readTimestamp();
+    for (lInstance = 0; lInstance < BENCHMARK_LAYOUT_INSTANCES; lInstance++)
+      psDescriptor->run(phInstances[lInstance], BENCHMARK_BLOCK_SIZE);
+    llElapsed += readTimestamp() - llStart;
+  }
+
+  printf("delays %5.2f s / %5.2f s  %15.3f %s/sample\n",
+	 fDelayLeft, fDelayRight,
+	 (double)llElapsed
+	 / ((double)BENCHMARK_LAYOUT_INSTANCES
+	    * BENCHMARK_LAYOUT_BLOCKS
+	    * BENCHMARK_BLOCK_SIZE),
+	 BENCHMARK_UNIT);
+
+  // -----------------------------------------------------------------
+
+  for (lInstance = 0; lInstance < BENCHMARK_LAYOUT_INSTANCES; lInstance++) {
+    if (psDescriptor->deactivate)
+      psDescriptor->deactivate(phInstances[lInstance]);
+    psDescriptor->cleanup(phInstances[lInstance]);
+  }
+  free(phInstances);
+  free(pfInput);
+  free(pfOutputLeft);
+  free(pfOutputRight);
+  free(pfControls);
+}
+
+// -------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+
+  const char* pcPluginPath;
+  void* pvPlugin;
+  LADSPA_Descriptor_Function fnDescriptor;
+  const LADSPA_Descriptor* psDescriptor;
+  int iPlugin;
+
+  // -----------------------------------------------------------------
+
+  for (iPlugin = 1; iPlugin < argc || iPlugin == 1; iPlugin++) {
+
+    pcPluginPath = iPlugin < argc ? argv[iPlugin] : "./delay_stereo.so";
+    pvPlugin = dlopen(pcPluginPath, RTLD_NOW);
+    if (!pvPlugin) {
+      fprintf(stderr, "Unable to load %s: %s\n", pcPluginPath, dlerror());
+      return 1;
+    }
+    fnDescriptor
+      = (LADSPA_Descriptor_Function)dlsym(pvPlugin, "ladspa_descriptor");
+    psDescriptor = fnDescriptor ? fnDescriptor(0) : NULL;
+    if (!psDescriptor) {
+      fprintf(stderr, "No plugin descriptor in %s.\n", pcPluginPath);
+      return 1;
+    }
+
+    // ---------------------------------------------------------------
+
+    printf("%s\n\n", pcPluginPath);
+    runTailBenchmark(psDescriptor);
+    printf("\n");
+    runLayoutBenchmark(psDescriptor,
+		       BENCHMARK_SHORT_DELAY, BENCHMARK_SHORT_DELAY);
+    runLayoutBenchmark(psDescriptor,
+		       BENCHMARK_SHORT_DELAY, BENCHMARK_LONG_DELAY);
+    printf("\n");
+    dlclose(pvPlugin);
+  }
+
+  return 0;
+}
+
+// -------------------------------------------------------------------
@@ -5,16 +5,34 @@
 // W.E. Furse. Do with as you will. No warranty.
 //
 // This LADSPA plugin provides a simple stereo delay line implemented
-// in C. There is a fixed maximum delay length and no feedback is
-// provided.
+// in C. There is a fixed maximum delay length. Only the echo and the
+// ping-pong flavours feed the delayed signal back into the delay line.
+// The reverse flavour plays it backwards in segments and the pitch
+// shifting one at another speed. A plain delay line for 1 to
+// SDL_MAX_CHANNELS channels sharing one write pointer is provided as
+// well, a stereo delay line read by up to SDL_MAX_TAPS taps, and one
+// read by a fixed list of any number of taps loaded from a file,
+// which is convolved with the input where the taps are dense.
+// Finally, there are reverbs made of 8 or 16 delay lines fed back
+// into each other, and banks of 8 to 32 combs tuned to a chord.
 //
 // This file has poor memory protection. Failures during malloc() will
 // not recover nicely.
 // -------------------------------------------------------------------
 
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// The SIMD kernels are only available on x86. All other platforms
+// fall back to the generic C kernels.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SDL_X86_SIMD
+#include <immintrin.h>
+#endif
+
 // -------------------------------------------------------------------
 
 // Include headers shipped in this repo.
@@ -26,9 +44,140 @@
 // The maximum delay valid for the delay line (in seconds).
 #define MAX_DELAY 5
 
+// The most taps any of the fractional delay interpolators reads.
+#define SDL_INTERPOLATION_TAPS 4
+
+// The maximum duration of a crossfade between two delays (in
+// seconds).
+#define MAX_CROSSFADE_TIME 0.5
+
+// The range of the rate at which a glide changes the delay (in
+// seconds of delay per second). At the maximum, a glide to a longer
+// delay brings the playback to a halt and one to a shorter delay
+// doubles its speed.
+#define MIN_GLIDE_RATE 0.01
+#define MAX_GLIDE_RATE 1
+
+// The ranges of the rate (in Hz) and the depth (in seconds) of the
+// LFO of the chorus flavour.
+#define MIN_LFO_RATE 0.01
+#define MAX_LFO_RATE 20
+#define MAX_LFO_DEPTH 0.05
+
+// The largest phase offset of the LFO of the right channel (in
+// degrees).
+#define MAX_LFO_STEREO_PHASE 180
+
+// The range of the cutoff frequencies of the tone filter in the
+// feedback path of the echo flavours (in Hz).
+#define MIN_FEEDBACK_CUTOFF 20
+#define MAX_FEEDBACK_CUTOFF 20000
+
+// The range of the longest delay of the feedback delay network
+// reverbs (in seconds), which sets the size of the room.
+#define MIN_FDN_SIZE 0.01
+#define MAX_FDN_SIZE 0.1
+
+// The range of the decay time of the reverbs (in seconds), in which
+// the tail falls by 60 dB.
+#define MIN_DECAY_TIME 0.1
+#define MAX_DECAY_TIME 20
+
+// The range of the root note of the comb filter banks (as a MIDI note
+// number), which their longest comb is tuned to.
+#define MIN_ROOT_NOTE 24
+#define MAX_ROOT_NOTE 96
+
+// The range of the shift of the pitch shifting flavour (in
+// semitones), and the time it takes each of its read heads to sweep
+// through the delay line once (in seconds).
+#define MIN_PITCH_SHIFT -24
+#define MAX_PITCH_SHIFT 24
+#define PITCH_SWEEP_TIME 0.05
+
+// The time it takes a smoothed control like the dry/wet mix to follow
+// a change (in seconds).
+#define SMOOTHING_TIME 0.02
+
+// Fractional delays are processed in chunks of at most this many
+// samples. The ring buffer always leaves room for one chunk in front
+// of the longest delay.
+#define SDL_CHUNK_SIZE 1024
+
+// The most channels an instance of the N-channel delay line can have.
+#define SDL_MAX_CHANNELS 16
+
+// The most taps an instance of the multi-tap delay line can have.
+#define SDL_MAX_TAPS 32
+
+// The tap kernels read this many taps in one pass over a span, so the
+// sum of their reads is loaded and stored only once per group.
+#define SDL_TAP_GROUP_SIZE 4
+
+// The tap file delay line reads its taps from the file named by this
+// environment variable when an instance is created.
+#define SDL_TAP_FILE_VARIABLE "DELAY_STEREO_TAP_FILE"
+
+// Taps of the tap file delay line at least SDL_PARTITION_SIZE samples
+// long may be convolved instead of read one by one. The convolution
+// works on partitions of this many samples, each transformed by an FFT
+// of twice the size, and runs one partition ahead of the output, so it
+// adds no latency. Its cost is dominated by streaming the spectra of
+// all partitions through the cache once per partition of output, which
+// makes long partitions pay off.
+#define SDL_PARTITION_SIZE SDL_CHUNK_SIZE
+#define SDL_FFT_SIZE (2 * SDL_PARTITION_SIZE)
+
+// Estimated cost of the convolution per sample and channel, in
+// multiply-adds like one tap read directly: a fixed part for the two
+// FFTs and a part for each partition. The long taps are convolved if
+// reading them directly would cost more.
+#define SDL_CONVOLUTION_COST 256
+#define SDL_PARTITION_COST   6
+
+// The most delay lines of a feedback delay network reverb. Their
+// lengths are spread evenly on a log scale from SDL_FDN_SHORTEST of
+// the longest one up to it.
+#define SDL_MAX_FDN_LINES 16
+#define SDL_FDN_SHORTEST  0.4
+
+// At full damping, the highest frequencies die away this much faster
+// than the decay time.
+#define SDL_FDN_MAX_DAMPING 0.9
+
+// The tail of a reverb or a comb filter bank is dropped once the
+// input has been silent for this many decay times (120 dB) and the
+// longest delay.
+#define SDL_FDN_TAIL_DECAYS 2
+
+// The most combs of a comb filter bank. Combs tuned so high that their
+// delay would be shorter than SDL_MIN_COMB_DELAY samples are left
+// silent.
+#define SDL_MAX_COMBS      32
+#define SDL_MIN_COMB_DELAY 4
+
+// The read heads of the pitch shifting flavour are faded in and out by
+// a window looked up in a table of this many entries, a power of two.
+#define SDL_PITCH_WINDOW_SIZE 4096
+
+// Building with -DSDL_INTERLEAVED_RING keeps both channels of the
+// plain flavour in a single ring buffer of frames, each holding the
+// left sample followed by the right one. The reads and writes of a
+// sample then share their cache lines and pages whenever the delays
+// of both channels are close. The other flavours always keep a ring
+// buffer per channel, which their interpolators read as one run of
+// consecutive samples.
+#ifdef SDL_INTERLEAVED_RING
+#define SDL_INTERLEAVED_PLAIN_RING 1
+#else
+#define SDL_INTERLEAVED_PLAIN_RING 0
+#endif
+
 // -------------------------------------------------------------------
 
-// The port numbers for the plugin
+// The port numbers for the plugin. Flavours whose ports do not follow
+// this numbering map their own port numbers to these in a table
+// stored as the ImplementationData of their descriptor.
 #define SDL_DELAY_LENGTH_LEFT  0
 #define SDL_DELAY_LENGTH_RIGHT 1
 #define SDL_DRY_WET_LEFT       2
@@ -37,14 +186,295 @@
 #define SDL_INPUT_RIGHT        5
 #define SDL_OUTPUT_LEFT        6
 #define SDL_OUTPUT_RIGHT       7
+#define SDL_INTERPOLATION      8
+#define SDL_DELAY_CHANGE       9
+#define SDL_CROSSFADE_TIME     10
+#define SDL_GLIDE_RATE         11
+#define SDL_MODULATION_LEFT    12
+#define SDL_MODULATION_RIGHT   13
+#define SDL_LFO_RATE           14
+#define SDL_LFO_DEPTH          15
+#define SDL_LFO_SHAPE          16
+#define SDL_LFO_STEREO_PHASE   17
+#define SDL_FEEDBACK           18
+#define SDL_FEEDBACK_LOW_PASS  19
+#define SDL_FEEDBACK_HIGH_PASS 20
+#define SDL_SATURATION         21
+#define SDL_CROSS_FEEDBACK     22
+#define SDL_REVERSE            23
+#define SDL_PITCH_SHIFT        24
+#define SDL_FOUR_READ_HEADS    25
+
+// The chorus flavour has the ports of the fractional one followed by
+// the controls of its LFO.
+#define SDL_CHORUS_LFO_RATE         12
+#define SDL_CHORUS_LFO_DEPTH        13
+#define SDL_CHORUS_LFO_SHAPE        14
+#define SDL_CHORUS_LFO_STEREO_PHASE 15
+#define SDL_CHORUS_PORT_COUNT       16
+
+// The echo flavour has the ports of the fractional one followed by
+// the controls of its feedback path.
+#define SDL_ECHO_FEEDBACK           12
+#define SDL_ECHO_FEEDBACK_LOW_PASS  13
+#define SDL_ECHO_FEEDBACK_HIGH_PASS 14
+#define SDL_ECHO_SATURATION         15
+#define SDL_ECHO_PORT_COUNT         16
+
+// The ping-pong flavour has the ports of the echo one followed by the
+// share of the feedback which crosses over to the other channel.
+#define SDL_PING_PONG_CROSS_FEEDBACK 16
+#define SDL_PING_PONG_PORT_COUNT     17
+
+// The plain flavour only has the first eight ports.
+#define SDL_PLAIN_PORT_COUNT 8
+
+// The reverse flavour has the ports of the plain one followed by the
+// switch which makes it play the delayed signal backwards.
+#define SDL_REVERSE_SWITCH     8
+#define SDL_REVERSE_PORT_COUNT 9
+
+// The pitch shifting flavour has the ports of the plain one followed
+// by the shift and the choice of two or four read heads.
+#define SDL_PITCH_SHIFT_SEMITONES 8
+#define SDL_PITCH_FOUR_READ_HEADS 9
+#define SDL_PITCH_PORT_COUNT      10
+
+// The ports of the N-channel delay line come in these groups, each of
+// which has one port per channel. Port lChannel of group iGroup is
+// number iGroup * (channel count) + lChannel.
+#define SDL_MULTI_DELAY_LENGTH 0
+#define SDL_MULTI_DRY_WET      1
+#define SDL_MULTI_INPUT        2
+#define SDL_MULTI_OUTPUT       3
+#define SDL_MULTI_PORT_GROUPS  4
+
+// The multi-tap delay line starts with these ports. They are followed
+// by groups of ports with one port per tap: port lTap of group iGroup
+// is number SDL_MULTI_TAP_SHARED_PORTS + iGroup * (tap count) + lTap.
+#define SDL_MULTI_TAP_DRY          0
+#define SDL_MULTI_TAP_INPUT_LEFT   1
+#define SDL_MULTI_TAP_INPUT_RIGHT  2
+#define SDL_MULTI_TAP_OUTPUT_LEFT  3
+#define SDL_MULTI_TAP_OUTPUT_RIGHT 4
+#define SDL_MULTI_TAP_SHARED_PORTS 5
+#define SDL_TAP_DELAY_LENGTH 0
+#define SDL_TAP_GAIN         1
+#define SDL_TAP_PAN          2
+#define SDL_TAP_PORT_GROUPS  3
+
+// The ports of the tap file delay line.
+#define SDL_TAP_FILE_DRY_WET      0
+#define SDL_TAP_FILE_INPUT_LEFT   1
+#define SDL_TAP_FILE_INPUT_RIGHT  2
+#define SDL_TAP_FILE_OUTPUT_LEFT  3
+#define SDL_TAP_FILE_OUTPUT_RIGHT 4
+#define SDL_TAP_FILE_PORT_COUNT   5
+
+// The ports of the feedback delay network reverbs.
+#define SDL_FDN_SIZE         0
+#define SDL_FDN_DECAY_TIME   1
+#define SDL_FDN_DAMPING      2
+#define SDL_FDN_DRY_WET      3
+#define SDL_FDN_INPUT_LEFT   4
+#define SDL_FDN_INPUT_RIGHT  5
+#define SDL_FDN_OUTPUT_LEFT  6
+#define SDL_FDN_OUTPUT_RIGHT 7
+#define SDL_FDN_PORT_COUNT   8
+
+// The ports of the comb filter banks.
+#define SDL_COMB_ROOT_NOTE    0
+#define SDL_COMB_TUNING       1
+#define SDL_COMB_DECAY_TIME   2
+#define SDL_COMB_DAMPING      3
+#define SDL_COMB_DRY_WET      4
+#define SDL_COMB_INPUT_LEFT   5
+#define SDL_COMB_INPUT_RIGHT  6
+#define SDL_COMB_OUTPUT_LEFT  7
+#define SDL_COMB_OUTPUT_RIGHT 8
+#define SDL_COMB_PORT_COUNT   9
+
+// The interpolation modes selected by the SDL_INTERPOLATION port.
+#define SDL_INTERPOLATION_NONE    0
+#define SDL_INTERPOLATION_LINEAR  1
+#define SDL_INTERPOLATION_CUBIC   2
+#define SDL_INTERPOLATION_ALLPASS 3
+
+// The ways to follow a change of the delay selected by the
+// SDL_DELAY_CHANGE port.
+#define SDL_DELAY_CHANGE_JUMP      0
+#define SDL_DELAY_CHANGE_CROSSFADE 1
+#define SDL_DELAY_CHANGE_GLIDE     2
+
+// The shapes of the LFO selected by the SDL_LFO_SHAPE port.
+#define SDL_LFO_SHAPE_SINE     0
+#define SDL_LFO_SHAPE_TRIANGLE 1
+
+// The intervals between the combs of a comb filter bank selected by
+// the SDL_COMB_TUNING port: the harmonic series of the root note, or
+// a chord repeated in every octave above it.
+#define SDL_TUNING_HARMONICS 0
+#define SDL_TUNING_FIFTHS    1
+#define SDL_TUNING_MAJOR     2
+#define SDL_TUNING_MINOR     3
+
+// The sources the delay of a channel can be modulated by, the input
+// port or the LFO in one of its shapes.
+#define SDL_MODULATION_INPUT    0
+#define SDL_MODULATION_SINE     (1 + SDL_LFO_SHAPE_SINE)
+#define SDL_MODULATION_TRIANGLE (1 + SDL_LFO_SHAPE_TRIANGLE)
+#define SDL_MODULATION_SOURCES  3
 
 // -------------------------------------------------------------------
 
 // A couple of helper macros.
 #define LIMIT_BETWEEN_0_AND_1(x)		\
   (((x) < 0) ? 0 : (((x) > 1) ? 1 : (x)))
+#define LIMIT_BETWEEN_MINUS_1_AND_1(x)			\
+  (((x) < -1) ? -1 : (((x) > 1) ? 1 : (x)))
 #define LIMIT_BETWEEN_0_AND_MAX_DELAY(x)			\
   (((x) < 0) ? 0 : (((x) > MAX_DELAY) ? MAX_DELAY : (x)))
+#define LIMIT_BETWEEN_0_AND_MAX_CROSSFADE_TIME(x)			\
+  (((x) < 0) ? 0 : (((x) > MAX_CROSSFADE_TIME) ? MAX_CROSSFADE_TIME : (x)))
+#define LIMIT_BETWEEN_0_AND_ALLPASS(x)					\
+  (((x) < 0) ? 0 : (((x) > SDL_INTERPOLATION_ALLPASS)			\
+		    ? SDL_INTERPOLATION_ALLPASS : (x)))
+#define LIMIT_BETWEEN_0_AND_GLIDE(x)					\
+  (((x) < 0) ? 0 : (((x) > SDL_DELAY_CHANGE_GLIDE)			\
+		    ? SDL_DELAY_CHANGE_GLIDE : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_GLIDE_RATE(x)				\
+  (((x) < MIN_GLIDE_RATE) ? MIN_GLIDE_RATE				\
+   : (((x) > MAX_GLIDE_RATE) ? MAX_GLIDE_RATE : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_LFO_RATE(x)				\
+  (((x) < MIN_LFO_RATE) ? MIN_LFO_RATE					\
+   : (((x) > MAX_LFO_RATE) ? MAX_LFO_RATE : (x)))
+#define LIMIT_BETWEEN_0_AND_MAX_LFO_DEPTH(x)			\
+  (((x) < 0) ? 0 : (((x) > MAX_LFO_DEPTH) ? MAX_LFO_DEPTH : (x)))
+#define LIMIT_BETWEEN_0_AND_TRIANGLE(x)					\
+  (((x) < 0) ? 0 : (((x) > SDL_LFO_SHAPE_TRIANGLE)			\
+		    ? SDL_LFO_SHAPE_TRIANGLE : (x)))
+#define LIMIT_BETWEEN_0_AND_MAX_LFO_STEREO_PHASE(x)			\
+  (((x) < 0) ? 0 : (((x) > MAX_LFO_STEREO_PHASE)			\
+		    ? MAX_LFO_STEREO_PHASE : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_FEEDBACK_CUTOFF(x)			\
+  (((x) < MIN_FEEDBACK_CUTOFF) ? MIN_FEEDBACK_CUTOFF			\
+   : (((x) > MAX_FEEDBACK_CUTOFF) ? MAX_FEEDBACK_CUTOFF : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_FDN_SIZE(x)				\
+  (((x) < MIN_FDN_SIZE) ? MIN_FDN_SIZE					\
+   : (((x) > MAX_FDN_SIZE) ? MAX_FDN_SIZE : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_DECAY_TIME(x)				\
+  (((x) < MIN_DECAY_TIME) ? MIN_DECAY_TIME				\
+   : (((x) > MAX_DECAY_TIME) ? MAX_DECAY_TIME : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_ROOT_NOTE(x)				\
+  (((x) < MIN_ROOT_NOTE) ? MIN_ROOT_NOTE				\
+   : (((x) > MAX_ROOT_NOTE) ? MAX_ROOT_NOTE : (x)))
+#define LIMIT_BETWEEN_MIN_AND_MAX_PITCH_SHIFT(x)			\
+  (((x) < MIN_PITCH_SHIFT) ? MIN_PITCH_SHIFT				\
+   : (((x) > MAX_PITCH_SHIFT) ? MAX_PITCH_SHIFT : (x)))
+#define LIMIT_BETWEEN_0_AND_MINOR(x)					\
+  (((x) < 0) ? 0 : (((x) > SDL_TUNING_MINOR)				\
+		    ? SDL_TUNING_MINOR : (x)))
+#define FLUSH_DENORMAL(x)					\
+  ((((x) < FLT_MIN) && ((x) > -FLT_MIN)) ? 0 : (x))
+
+// Filter states which have decayed below this are flushed to zero.
+// Their updates underflow long before they reach the subnormal range,
+// which can leave them stuck at a tiny value for good.
+#define SDL_FEEDBACK_FLOOR 1e-30f
+#define FLUSH_FEEDBACK_STATE(x)						\
+  ((((x) < SDL_FEEDBACK_FLOOR) && ((x) > -SDL_FEEDBACK_FLOOR)) ? 0 : (x))
+
+// -------------------------------------------------------------------
+
+// A position the delay line of a channel is read from.
+typedef struct {
+
+  // Delay in samples. Negative before the first block has been run.
+  LADSPA_Data m_fDelay;
+
+  // Output of the allpass interpolator for the previous sample.
+  LADSPA_Data m_fAllpassState;
+
+} ReadHead;
+
+// The read heads of a channel. Usually only the first one is in use.
+// While the delay is crossfaded, the second one reads the new delay
+// and takes over once the crossfade is complete.
+typedef struct {
+
+  ReadHead m_sHead;
+  ReadHead m_sNextHead;
+
+  // Progress and length of the running crossfade (in samples). The
+  // length is zero while there is none.
+  unsigned long m_lFadePosition;
+  unsigned long m_lFadeLength;
+
+} ReadHeads;
+
+// A gain control smoothed by a linear ramp. A change of the control
+// is followed over a fixed number of samples, a change during a ramp
+// starts a new ramp from wherever the old one has got to.
+typedef struct {
+
+  // Value reached so far and value the ramp is heading for.
+  LADSPA_Data m_fValue;
+  LADSPA_Data m_fTarget;
+
+  // Change per sample and number of samples left in the ramp.
+  LADSPA_Data m_fIncrement;
+  unsigned long m_lRemaining;
+
+  // Zero until the first target is set, which is taken over without a
+  // ramp.
+  int m_iPrimed;
+
+} SmoothedGain;
+
+// -------------------------------------------------------------------
+
+// The feedback path of both channels. What is read from the delay
+// line passes a one-pole low-pass and a one-pole high-pass before it
+// is added to the input written to the ring buffers. The filtered
+// signals are mixed by a symmetric 2x2 matrix: m_fGain scales what a
+// channel feeds back into its own ring buffer, m_fCrossGain what it
+// feeds into the one of the other channel. The filter coefficients
+// are shared by the channels, the filter states are indexed by the
+// channel.
+typedef struct {
+
+  LADSPA_Data m_fGain;
+  LADSPA_Data m_fCrossGain;
+  LADSPA_Data m_fLowPass;
+  LADSPA_Data m_fHighPass;
+
+  // Outputs of the low-pass and of the low-pass smoothing the high-pass
+  // subtracts from it.
+  LADSPA_Data m_afLowPassState[2];
+  LADSPA_Data m_afHighPassState[2];
+
+} Feedback;
+
+// -------------------------------------------------------------------
+
+// The two read heads of a channel of the reverse flavour. The segment
+// of m_lLength samples preceding the start of a segment of the first
+// head is played backwards, so the delay grows by two samples every
+// sample. The second head does the same half a segment later, and a
+// triangular window crossfades from each head to the other before it
+// jumps back to the start of the next segment. m_lPhase counts the
+// samples since the first head started its segment, which is
+// m_lLength samples long. The second head started its segment at
+// half the segment of the first one that was m_lSecondLength samples
+// long. Both lengths are latched as the heads start, so a new delay
+// never moves a head that is being heard.
+typedef struct {
+
+  unsigned long m_lLength;
+  unsigned long m_lSecondLength;
+  unsigned long m_lPhase;
+
+} ReverseHeads;
 
 // -------------------------------------------------------------------
 
@@ -53,17 +483,70 @@ typedef struct {
 
   LADSPA_Data m_fSampleRate;
 
+  // Table mapping the port numbers of the flavour of the plugin to the
+  // ones above, NULL if they are the same. It has one entry for each
+  // of the m_lPortCount ports of the descriptor.
+  const unsigned long* m_plPortRoles;
+  unsigned long m_lPortCount;
+
   // Buffers which will contain the information of the left and right
-  // channel.
+  // channel. NULL if the instance uses m_pfFrames instead.
   LADSPA_Data* m_pfBufferLeft;
   LADSPA_Data* m_pfBufferRight;
 
+  // Ring buffer of frames holding both channels, with twice as many
+  // samples as m_lBufferSize. Only used by the plain flavour if
+  // SDL_INTERLEAVED_PLAIN_RING is set, NULL otherwise.
+  LADSPA_Data* m_pfFrames;
+
   // Buffer size, a power of two.
   unsigned long m_lBufferSize;
 
   // Write pointer in buffers. Both will share the some pointer.
   unsigned long m_lWritePointer;
 
+  // Gain applied to the output by run_adding().
+  LADSPA_Data m_fRunAddingGain;
+
+  // Longest delay (in samples) a read can reach back, including the
+  // taps of the interpolators.
+  unsigned long m_lMaxDelay;
+
+  // Read heads of the fractional flavour of the plugin.
+  ReadHeads m_sReadHeadsLeft;
+  ReadHeads m_sReadHeadsRight;
+
+  // Read heads of the reverse flavour of the plugin.
+  ReverseHeads m_sReverseHeadsLeft;
+  ReverseHeads m_sReverseHeadsRight;
+
+  // Phases of the first read head of the pitch shifting flavour of
+  // the plugin, from 0 to 1 along its sweep.
+  LADSPA_Data m_fPitchPhaseLeft;
+  LADSPA_Data m_fPitchPhaseRight;
+
+  // Smoothed wet gains.
+  SmoothedGain m_sWetLeft;
+  SmoothedGain m_sWetRight;
+
+  // Phase of the LFO of the left channel (in cycles).
+  double m_dLfoPhase;
+
+  // Feedback path of the echo flavours of the plugin.
+  Feedback m_sFeedback;
+
+  // Number of consecutive digitally silent input samples, up to
+  // m_lMaxDelay. Once it reached m_lMaxDelay, the delay line of the
+  // channel is idle.
+  unsigned long m_lSilentSamplesLeft;
+  unsigned long m_lSilentSamplesRight;
+
+  // Number of samples preceding the write pointer which have been
+  // skipped while the channel was idle, up to m_lMaxDelay. They have
+  // to be zeroed before the channel is processed again.
+  unsigned long m_lUnwrittenSamplesLeft;
+  unsigned long m_lUnwrittenSamplesRight;
+
   // Ports:
   // ------
   // Delay controls, in seconds. Accepted between 0 and 1 (only 1 sec
@@ -83,16 +566,398 @@ typedef struct {
   LADSPA_Data* m_pfOutputLeft;
   LADSPA_Data* m_pfOutputRight;
 
+  // Interpolation mode for fractional delays, the way to follow
+  // changes of the delay, the crossfade time (in seconds) and the
+  // glide rate (in seconds per second). Only available in the
+  // fractional flavour of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfInterpolation;
+  LADSPA_Data* m_pfDelayChange;
+  LADSPA_Data* m_pfCrossfadeTime;
+  LADSPA_Data* m_pfGlideRate;
+
+  // Audio rate modulation of the delays (in seconds). Only available
+  // in the modulated flavour of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfModulationLeft;
+  LADSPA_Data* m_pfModulationRight;
+
+  // LFO rate (in Hz), depth (in seconds), shape and the phase offset
+  // of the right channel (in degrees). Only available in the chorus
+  // flavour of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfLfoRate;
+  LADSPA_Data* m_pfLfoDepth;
+  LADSPA_Data* m_pfLfoShape;
+  LADSPA_Data* m_pfLfoStereoPhase;
+
+  // Feedback gain, the cutoff frequencies of the low-pass and the
+  // high-pass in the feedback path (in Hz) and the switch for the
+  // saturation of what is written to the delay line. Only available in
+  // the echo flavours of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfFeedback;
+  LADSPA_Data* m_pfFeedbackLowPass;
+  LADSPA_Data* m_pfFeedbackHighPass;
+  LADSPA_Data* m_pfSaturation;
+
+  // Share of the feedback crossing over to the other channel. Only
+  // available in the ping-pong flavour of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfCrossFeedback;
+
+  // Switch for playing the delayed signal backwards. Only available in
+  // the reverse flavour of the plugin, NULL otherwise.
+  LADSPA_Data* m_pfReverse;
+
+  // Pitch shift (in semitones) and switch for four instead of two read
+  // heads. Only available in the pitch shifting flavour of the plugin,
+  // NULL otherwise.
+  LADSPA_Data* m_pfPitchShift;
+  LADSPA_Data* m_pfFourReadHeads;
+
 } SimpleDelayLine;
 
 // -------------------------------------------------------------------
 
+// State of one channel of the N-channel delay line. The members are
+// used just like their counterparts in SimpleDelayLine.
+typedef struct {
+
+  ReadHeads m_sReadHeads;
+  SmoothedGain m_sWet;
+  unsigned long m_lSilentSamples;
+  unsigned long m_lUnwrittenSamples;
+
+  // Ports: delay control (in seconds), dry/wet control, input and
+  // output.
+  LADSPA_Data* m_pfDelay;
+  LADSPA_Data* m_pfDryWet;
+  LADSPA_Data* m_pfInput;
+  LADSPA_Data* m_pfOutput;
+
+} DelayChannel;
+
+// Instance data for the N-channel delay line plugin. It behaves like
+// the plain flavour of the stereo plugin, for any number of channels.
+// The ring buffers of all channels are allocated in one piece, one
+// after the other, and share a single write pointer.
+typedef struct {
+
+  LADSPA_Data m_fSampleRate;
+  unsigned long m_lChannelCount;
+
+  // Ring buffers of all channels. The one of channel lChannel starts
+  // at lChannel * m_lBufferSize.
+  LADSPA_Data* m_pfBuffers;
+
+  // Size of the ring buffer of each channel, a power of two.
+  unsigned long m_lBufferSize;
+
+  unsigned long m_lWritePointer;
+  LADSPA_Data m_fRunAddingGain;
+  unsigned long m_lMaxDelay;
+
+  DelayChannel m_asChannels[SDL_MAX_CHANNELS];
+
+} MultiDelayLine;
+
+// -------------------------------------------------------------------
+
+// State and ports of one tap of the multi-tap delay line.
+typedef struct {
+
+  // Gains of the tap in the left and the right channel, following its
+  // gain and pan controls.
+  SmoothedGain m_sGainLeft;
+  SmoothedGain m_sGainRight;
+
+  // Delay (in samples) read in the current block.
+  unsigned long m_lDelay;
+
+  // Ports: delay control (in seconds), gain and pan (-1 for left, 1
+  // for right).
+  LADSPA_Data* m_pfDelay;
+  LADSPA_Data* m_pfGain;
+  LADSPA_Data* m_pfPan;
+
+} DelayTap;
+
+// Instance data for the multi-tap delay line plugin. A single stereo
+// ring buffer is read by all taps, each of which adds the delayed
+// signal of both channels to the output with a gain and a balance of
+// its own. The members are used like their counterparts in
+// SimpleDelayLine, except that the unwritten samples of both channels
+// are counted together.
+typedef struct {
+
+  LADSPA_Data m_fSampleRate;
+  unsigned long m_lTapCount;
+
+  LADSPA_Data* m_pfBufferLeft;
+  LADSPA_Data* m_pfBufferRight;
+  unsigned long m_lBufferSize;
+  unsigned long m_lWritePointer;
+  LADSPA_Data m_fRunAddingGain;
+  unsigned long m_lMaxDelay;
+  unsigned long m_lSilentSamplesLeft;
+  unsigned long m_lSilentSamplesRight;
+  unsigned long m_lUnwrittenSamples;
+
+  // Smoothed gain of the dry signal.
+  SmoothedGain m_sDry;
+
+  // Ports: dry level, inputs and outputs.
+  LADSPA_Data* m_pfDry;
+  LADSPA_Data* m_pfInputLeft;
+  LADSPA_Data* m_pfInputRight;
+  LADSPA_Data* m_pfOutputLeft;
+  LADSPA_Data* m_pfOutputRight;
+
+  DelayTap m_asTaps[SDL_MAX_TAPS];
+
+} MultiTapDelayLine;
+
+// -------------------------------------------------------------------
+
+// Twiddle factors and bit reversed indices of a complex FFT of
+// SDL_FFT_SIZE points.
+typedef struct {
+  LADSPA_Data m_afCos[SDL_FFT_SIZE / 2];
+  LADSPA_Data m_afSin[SDL_FFT_SIZE / 2];
+  unsigned short m_aiBitReversed[SDL_FFT_SIZE];
+} Fft;
+
+// Uniformly partitioned convolution of both channels with the long
+// taps of a tap list. The left channel is transformed as the real part
+// and the right one as the imaginary part of the same FFT, which keeps
+// them apart because the taps are real. A spectrum holds the
+// SDL_FFT_SIZE real parts followed by the imaginary parts.
+typedef struct {
+
+  // Spectra of the partitions of the taps, taken SDL_PARTITION_SIZE
+  // samples early and already scaled for the inverse FFT.
+  unsigned long m_lPartitionCount;
+  LADSPA_Data* m_pfFilterSpectra;
+
+  // Spectra of the last m_lPartitionCount blocks of input, used as a
+  // ring starting with the newest one. Only the newest m_lValidSpectra
+  // of them hold input, the others stand for silence.
+  LADSPA_Data* m_pfInputSpectra;
+  unsigned long m_lNewestSpectrum;
+  unsigned long m_lValidSpectra;
+
+  // Position in the current block and the output of the convolution
+  // for it, computed at the end of the block before.
+  unsigned long m_lPosition;
+  LADSPA_Data m_afOutputLeft[SDL_PARTITION_SIZE];
+  LADSPA_Data m_afOutputRight[SDL_PARTITION_SIZE];
+
+  // Scratch space for the spectrum of the input and the sum of the
+  // products.
+  LADSPA_Data m_afSpectrum[2 * SDL_FFT_SIZE];
+  LADSPA_Data m_afSum[2 * SDL_FFT_SIZE];
+
+} Convolution;
+
+// Instance data for the tap file delay line plugin. Its taps are read
+// from a file and have fixed delays and gains, which are the same in
+// both channels. The taps read directly are summed up like the ones of
+// the multi-tap delay line, the others are left to the convolution.
+// The remaining members are used like their counterparts in
+// MultiTapDelayLine.
+typedef struct {
+
+  LADSPA_Data m_fSampleRate;
+
+  LADSPA_Data* m_pfBufferLeft;
+  LADSPA_Data* m_pfBufferRight;
+  unsigned long m_lBufferSize;
+  unsigned long m_lWritePointer;
+  LADSPA_Data m_fRunAddingGain;
+  unsigned long m_lMaxDelay;
+  unsigned long m_lSilentSamplesLeft;
+  unsigned long m_lSilentSamplesRight;
+  unsigned long m_lUnwrittenSamples;
+
+  // Smoothed dry/wet balance.
+  SmoothedGain m_sWet;
+
+  // Taps read directly from the ring buffers: all of them for a sparse
+  // tap list, otherwise the ones shorter than SDL_PARTITION_SIZE. The
+  // gains never ramp.
+  unsigned long m_lDirectTapCount;
+  unsigned long* m_plDirectDelays;
+  SmoothedGain* m_psDirectGains;
+  SmoothedGain** m_ppsDirectGains;
+
+  // Convolution with the other taps, NULL if there are none.
+  Convolution* m_psConvolution;
+
+  // Ports: dry/wet balance, inputs and outputs.
+  LADSPA_Data* m_pfDryWet;
+  LADSPA_Data* m_pfInputLeft;
+  LADSPA_Data* m_pfInputRight;
+  LADSPA_Data* m_pfOutputLeft;
+  LADSPA_Data* m_pfOutputRight;
+
+} TapFileDelayLine;
+
+// -------------------------------------------------------------------
+
+// Instance data for the feedback delay network reverbs. The delay
+// lines share a ring buffer of frames holding one sample per line, so
+// the lines sit side by side in the lanes of SIMD vectors. For every
+// sample, each line is read at its own delay and passed through its
+// damping filter. Then the lines are mixed by the Householder matrix
+// I - 2/N (N being the line count), and the result is written back
+// with the input added. The arrays hold one value per line.
+typedef struct {
+
+  LADSPA_Data m_fSampleRate;
+  unsigned long m_lLineCount;
+
+  LADSPA_Data* m_pfFrames;
+  unsigned long m_lFrameCount;
+  unsigned long m_lWritePointer;
+  LADSPA_Data m_fRunAddingGain;
+
+  // Number of silent input samples in a row, and whether the ring
+  // buffer and the filters have been cleared since the tail died away.
+  unsigned long m_lSilentSamples;
+  int m_iCleared;
+
+  // Control values the lines are set up for.
+  LADSPA_Data m_fSize;
+  LADSPA_Data m_fDecayTime;
+  LADSPA_Data m_fDamping;
+
+  // Smoothed dry/wet balance.
+  SmoothedGain m_sWet;
+
+  // Mutually prime delays (in samples) and the position of each read
+  // relative to the start of the frame written, in samples of the
+  // ring buffer. The latter are kept as floats for the gathers.
+  unsigned long m_alDelays[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afReadIndices[SDL_MAX_FDN_LINES];
+
+  // The damping filters. The new state is m_afFilterGains times the
+  // sample read plus m_afFilterPoles times the old one, which makes
+  // the decay time of high frequencies shorter.
+  LADSPA_Data m_afFilterGains[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afFilterPoles[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afFilterStates[SDL_MAX_FDN_LINES];
+
+  // Gains of the inputs fed into the lines and of the lines in the
+  // outputs.
+  LADSPA_Data m_afInputLeft[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afInputRight[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afOutputLeft[SDL_MAX_FDN_LINES];
+  LADSPA_Data m_afOutputRight[SDL_MAX_FDN_LINES];
+
+  // Ports: size (in seconds), decay time (in seconds), damping,
+  // dry/wet balance, inputs and outputs.
+  LADSPA_Data* m_pfSize;
+  LADSPA_Data* m_pfDecayTime;
+  LADSPA_Data* m_pfDamping;
+  LADSPA_Data* m_pfDryWet;
+  LADSPA_Data* m_pfInputLeft;
+  LADSPA_Data* m_pfInputRight;
+  LADSPA_Data* m_pfOutputLeft;
+  LADSPA_Data* m_pfOutputRight;
+
+} FeedbackDelayNetwork;
+
+// -------------------------------------------------------------------
+
+// The instance data of a comb filter bank. Each comb feeds its output
+// back into itself through a damping filter and shares the input with
+// all others. Like the lines of a feedback delay network, the combs
+// are interleaved in one ring buffer of frames, so they can be
+// processed side by side in SIMD lanes. The ring buffer only holds the
+// longest comb at the lowest root note.
+typedef struct {
+
+  LADSPA_Data m_fSampleRate;
+  unsigned long m_lCombCount;
+
+  LADSPA_Data* m_pfFrames;
+  unsigned long m_lFrameCount;
+  unsigned long m_lWritePointer;
+  LADSPA_Data m_fRunAddingGain;
+
+  // Number of silent input samples in a row, and whether the ring
+  // buffer and the filters have been cleared since the tail died away.
+  unsigned long m_lSilentSamples;
+  int m_iCleared;
+
+  // Control values the combs are set up for.
+  LADSPA_Data m_fRootNote;
+  unsigned long m_lTuning;
+  LADSPA_Data m_fDecayTime;
+  LADSPA_Data m_fDamping;
+
+  // Smoothed dry/wet balance.
+  SmoothedGain m_sWet;
+
+  // Delay of each comb (in samples, 0 if the comb is silent), its
+  // whole and fractional parts, and the position of the newer of the
+  // two samples read relative to the start of the frame written, in
+  // samples of the ring buffer. The latter are kept as floats for the
+  // gathers.
+  LADSPA_Data m_afDelays[SDL_MAX_COMBS];
+  unsigned long m_alDelays[SDL_MAX_COMBS];
+  LADSPA_Data m_afFractions[SDL_MAX_COMBS];
+  LADSPA_Data m_afReadIndices[SDL_MAX_COMBS];
+
+  // The damping filters, like in the feedback delay network.
+  LADSPA_Data m_afFilterGains[SDL_MAX_COMBS];
+  LADSPA_Data m_afFilterPoles[SDL_MAX_COMBS];
+  LADSPA_Data m_afFilterStates[SDL_MAX_COMBS];
+
+  // Gains of the combs in the outputs.
+  LADSPA_Data m_afOutputLeft[SDL_MAX_COMBS];
+  LADSPA_Data m_afOutputRight[SDL_MAX_COMBS];
+
+  // Ports: root note, tuning, decay time (in seconds), damping,
+  // dry/wet balance, inputs and outputs.
+  LADSPA_Data* m_pfRootNote;
+  LADSPA_Data* m_pfTuning;
+  LADSPA_Data* m_pfDecayTime;
+  LADSPA_Data* m_pfDamping;
+  LADSPA_Data* m_pfDryWet;
+  LADSPA_Data* m_pfInputLeft;
+  LADSPA_Data* m_pfInputRight;
+  LADSPA_Data* m_pfOutputLeft;
+  LADSPA_Data* m_pfOutputRight;
+
+} CombFilterBank;
+
+// -------------------------------------------------------------------
+
+// Longest delay (in samples) a read can reach back at a sample rate
+// of SampleRate, including the taps of the interpolators.
+static unsigned long getMaxDelay(unsigned long SampleRate) {
+  return ((unsigned long)((LADSPA_Data)SampleRate * MAX_DELAY)
+	  + SDL_INTERPOLATION_TAPS);
+}
+
+// Buffer size is a power of two bigger than max delay time plus one
+// chunk.
+static unsigned long getBufferSize(unsigned long lMaxDelay) {
+
+  unsigned long lBufferSize;
+
+  // -----------------------------------------------------------------
+
+  lBufferSize = 1;
+  while (lBufferSize < lMaxDelay + SDL_CHUNK_SIZE)
+    lBufferSize <<= 1;
+  return lBufferSize;
+}
+
+// -------------------------------------------------------------------
+
 // Construct a new plugin instance.
 static LADSPA_Handle 
 instantiateSimpleDelayLine(const LADSPA_Descriptor*  Descriptor,
 			   unsigned long             SampleRate) {
 
-  unsigned long lMinimumBufferSize;
   SimpleDelayLine* psDelayLine;
   
   // -----------------------------------------------------------------
@@ -107,31 +972,65 @@ instantiateSimpleDelayLine(const LADSPA_Descriptor*  Descriptor,
   // -----------------------------------------------------------------
     
   psDelayLine->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psDelayLine->m_plPortRoles
+    = (const unsigned long*)Descriptor->ImplementationData;
+  psDelayLine->m_lPortCount = Descriptor->PortCount;
 
   // -----------------------------------------------------------------
   
-  // Buffer size is a power of two bigger than max delay time.
-  lMinimumBufferSize = (unsigned long)((LADSPA_Data)SampleRate * MAX_DELAY);
-  psDelayLine->m_lBufferSize = 1;
-  while (psDelayLine->m_lBufferSize < lMinimumBufferSize) {
-    psDelayLine->m_lBufferSize <<= 1;
-  }
+  psDelayLine->m_lMaxDelay = getMaxDelay(SampleRate);
+  psDelayLine->m_lBufferSize = getBufferSize(psDelayLine->m_lMaxDelay);
   
   // -----------------------------------------------------------------
   
-  psDelayLine->m_pfBufferLeft
-    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
-  psDelayLine->m_pfBufferRight
-    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
-  if (psDelayLine->m_pfBufferLeft == NULL || 
-      psDelayLine->m_pfBufferRight == NULL) {
-    free(psDelayLine);
-    return NULL;
+  if (SDL_INTERLEAVED_PLAIN_RING
+      && Descriptor->PortCount == SDL_PLAIN_PORT_COUNT) {
+    psDelayLine->m_pfBufferLeft = NULL;
+    psDelayLine->m_pfBufferRight = NULL;
+    psDelayLine->m_pfFrames
+      = (LADSPA_Data*)calloc(2 * psDelayLine->m_lBufferSize,
+			     sizeof(LADSPA_Data));
+    if (psDelayLine->m_pfFrames == NULL) {
+      free(psDelayLine);
+      return NULL;
+    }
+  } else {
+    psDelayLine->m_pfFrames = NULL;
+    psDelayLine->m_pfBufferLeft
+      = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize,
+			     sizeof(LADSPA_Data));
+    psDelayLine->m_pfBufferRight
+      = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize,
+			     sizeof(LADSPA_Data));
+    if (psDelayLine->m_pfBufferLeft == NULL || 
+	psDelayLine->m_pfBufferRight == NULL) {
+      free(psDelayLine);
+      return NULL;
+    }
   }
 
   // -----------------------------------------------------------------
   
   psDelayLine->m_lWritePointer = 0;
+  psDelayLine->m_fRunAddingGain = 1;
+  psDelayLine->m_pfInterpolation = NULL;
+  psDelayLine->m_pfDelayChange = NULL;
+  psDelayLine->m_pfCrossfadeTime = NULL;
+  psDelayLine->m_pfGlideRate = NULL;
+  psDelayLine->m_pfModulationLeft = NULL;
+  psDelayLine->m_pfModulationRight = NULL;
+  psDelayLine->m_pfLfoRate = NULL;
+  psDelayLine->m_pfLfoDepth = NULL;
+  psDelayLine->m_pfLfoShape = NULL;
+  psDelayLine->m_pfLfoStereoPhase = NULL;
+  psDelayLine->m_pfFeedback = NULL;
+  psDelayLine->m_pfFeedbackLowPass = NULL;
+  psDelayLine->m_pfFeedbackHighPass = NULL;
+  psDelayLine->m_pfSaturation = NULL;
+  psDelayLine->m_pfCrossFeedback = NULL;
+  psDelayLine->m_pfReverse = NULL;
+  psDelayLine->m_pfPitchShift = NULL;
+  psDelayLine->m_pfFourReadHeads = NULL;
   
   // -----------------------------------------------------------------
   
@@ -140,6 +1039,77 @@ instantiateSimpleDelayLine(const LADSPA_Descriptor*  Descriptor,
 
 // -------------------------------------------------------------------
 
+// Put a single read head at a delay of fDelay samples, dropping any
+// crossfade and interpolator state.
+static void resetReadHeads(ReadHeads* psReadHeads, LADSPA_Data fDelay) {
+  psReadHeads->m_sHead.m_fDelay = fDelay;
+  psReadHeads->m_sHead.m_fAllpassState = 0;
+  psReadHeads->m_sNextHead = psReadHeads->m_sHead;
+  psReadHeads->m_lFadePosition = 0;
+  psReadHeads->m_lFadeLength = 0;
+}
+
+// -------------------------------------------------------------------
+
+// Start both heads of a channel of the reverse flavour from scratch.
+// The second head has no segment yet and plays along with the first
+// until it fades out.
+static void resetReverseHeads(ReverseHeads* psReverseHeads) {
+  psReverseHeads->m_lSecondLength = 0;
+  psReverseHeads->m_lPhase = 0;
+}
+
+// -------------------------------------------------------------------
+
+// Forget the value of a smoothed gain. The next target is taken over
+// right away.
+static void resetSmoothedGain(SmoothedGain* psGain) {
+  psGain->m_fValue = 0;
+  psGain->m_fTarget = 0;
+  psGain->m_fIncrement = 0;
+  psGain->m_lRemaining = 0;
+  psGain->m_iPrimed = 0;
+}
+
+// Let a smoothed gain head for fTarget, taking lRampLength samples to
+// get there.
+static void setSmoothedGainTarget(SmoothedGain* psGain,
+				  LADSPA_Data fTarget,
+				  unsigned long lRampLength) {
+  if (!psGain->m_iPrimed || lRampLength == 0) {
+    psGain->m_fValue = fTarget;
+    psGain->m_fTarget = fTarget;
+    psGain->m_lRemaining = 0;
+    psGain->m_iPrimed = 1;
+  } else if (fTarget != psGain->m_fTarget) {
+    psGain->m_fTarget = fTarget;
+    psGain->m_fIncrement = (fTarget - psGain->m_fValue) / lRampLength;
+    psGain->m_lRemaining = lRampLength;
+  }
+}
+
+// Move a smoothed gain on by lSampleCount samples.
+static void advanceSmoothedGain(SmoothedGain* psGain,
+				unsigned long lSampleCount) {
+  if (lSampleCount >= psGain->m_lRemaining) {
+    psGain->m_fValue = psGain->m_fTarget;
+    psGain->m_lRemaining = 0;
+  } else {
+    psGain->m_fValue += psGain->m_fIncrement * lSampleCount;
+    psGain->m_lRemaining -= lSampleCount;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Clear the filter states of the feedback path of one channel.
+static void resetFeedbackChannel(Feedback* psFeedback, int iChannel) {
+  psFeedback->m_afLowPassState[iChannel] = 0;
+  psFeedback->m_afHighPassState[iChannel] = 0;
+}
+
+// -------------------------------------------------------------------
+
 // Initialise and activate a plugin instance.
 static void activateSimpleDelayLine(LADSPA_Handle Instance) {
 
@@ -151,12 +1121,37 @@ static void activateSimpleDelayLine(LADSPA_Handle Instance) {
   // Need to reset the delay history in this function rather than
   // instantiate() in case deactivate() followed by activate() have
   // been called to reinitialise a delay line.
-  memset(psSimpleDelayLine->m_pfBufferLeft, 
-	 0, 
-	 sizeof(LADSPA_Data) * psSimpleDelayLine->m_lBufferSize);
-  memset(psSimpleDelayLine->m_pfBufferRight, 
-	 0, 
-	 sizeof(LADSPA_Data) * psSimpleDelayLine->m_lBufferSize);
+  if (psSimpleDelayLine->m_pfFrames != NULL) {
+    memset(psSimpleDelayLine->m_pfFrames,
+	   0,
+	   2 * sizeof(LADSPA_Data) * psSimpleDelayLine->m_lBufferSize);
+  } else {
+    memset(psSimpleDelayLine->m_pfBufferLeft, 
+	   0, 
+	   sizeof(LADSPA_Data) * psSimpleDelayLine->m_lBufferSize);
+    memset(psSimpleDelayLine->m_pfBufferRight, 
+	   0, 
+	   sizeof(LADSPA_Data) * psSimpleDelayLine->m_lBufferSize);
+  }
+
+  // -----------------------------------------------------------------
+
+  // An empty delay history is as good as a silent one.
+  psSimpleDelayLine->m_lSilentSamplesLeft = psSimpleDelayLine->m_lMaxDelay;
+  psSimpleDelayLine->m_lSilentSamplesRight = psSimpleDelayLine->m_lMaxDelay;
+  psSimpleDelayLine->m_lUnwrittenSamplesLeft = 0;
+  psSimpleDelayLine->m_lUnwrittenSamplesRight = 0;
+  resetReadHeads(&psSimpleDelayLine->m_sReadHeadsLeft, -1);
+  resetReadHeads(&psSimpleDelayLine->m_sReadHeadsRight, -1);
+  resetReverseHeads(&psSimpleDelayLine->m_sReverseHeadsLeft);
+  resetReverseHeads(&psSimpleDelayLine->m_sReverseHeadsRight);
+  psSimpleDelayLine->m_fPitchPhaseLeft = 0;
+  psSimpleDelayLine->m_fPitchPhaseRight = 0;
+  resetSmoothedGain(&psSimpleDelayLine->m_sWetLeft);
+  resetSmoothedGain(&psSimpleDelayLine->m_sWetRight);
+  psSimpleDelayLine->m_dLfoPhase = 0;
+  resetFeedbackChannel(&psSimpleDelayLine->m_sFeedback, 0);
+  resetFeedbackChannel(&psSimpleDelayLine->m_sFeedback, 1);
 }
 
 // -------------------------------------------------------------------
@@ -172,6 +1167,10 @@ connectPortToSimpleDelayLine(LADSPA_Handle Instance,
   // -----------------------------------------------------------------
   
   psSimpleDelayLine = (SimpleDelayLine*)Instance;
+  if (Port >= psSimpleDelayLine->m_lPortCount)
+    return;
+  if (psSimpleDelayLine->m_plPortRoles)
+    Port = psSimpleDelayLine->m_plPortRoles[Port];
   
   // -----------------------------------------------------------------
   
@@ -200,348 +1199,9337 @@ connectPortToSimpleDelayLine(LADSPA_Handle Instance,
   case SDL_OUTPUT_RIGHT:
     psSimpleDelayLine->m_pfOutputRight = DataLocation;
     break;
-  }
-}
-
-// -------------------------------------------------------------------
-
-// Run a delay line instance for a block of SampleCount samples.
-static void runSimpleDelayLine(LADSPA_Handle Instance,
-			       unsigned long SampleCount) {
-  
-  LADSPA_Data* pfBufferLeft;
-  LADSPA_Data* pfBufferRight;
-  LADSPA_Data* pfInputLeft;
-  LADSPA_Data* pfInputRight;
-  LADSPA_Data* pfOutputLeft;
-  LADSPA_Data* pfOutputRight;
-  LADSPA_Data fDryLeft;
-  LADSPA_Data fDryRight;
-  LADSPA_Data fInputSampleLeft;
-  LADSPA_Data fInputSampleRight;
-  LADSPA_Data fWetLeft;
-  LADSPA_Data fWetRight;
-  SimpleDelayLine* psSimpleDelayLine;
-  unsigned long lBufferReadOffsetLeft;
-  unsigned long lBufferReadOffsetRight;
+  case SDL_INTERPOLATION:
+    psSimpleDelayLine->m_pfInterpolation = DataLocation;
+    break;
+  case SDL_DELAY_CHANGE:
+    psSimpleDelayLine->m_pfDelayChange = DataLocation;
+    break;
+  case SDL_CROSSFADE_TIME:
+    psSimpleDelayLine->m_pfCrossfadeTime = DataLocation;
+    break;
+  case SDL_GLIDE_RATE:
+    psSimpleDelayLine->m_pfGlideRate = DataLocation;
+    break;
+  case SDL_MODULATION_LEFT:
+    psSimpleDelayLine->m_pfModulationLeft = DataLocation;
+    break;
+  case SDL_MODULATION_RIGHT:
+    psSimpleDelayLine->m_pfModulationRight = DataLocation;
+    break;
+  case SDL_LFO_RATE:
+    psSimpleDelayLine->m_pfLfoRate = DataLocation;
+    break;
+  case SDL_LFO_DEPTH:
+    psSimpleDelayLine->m_pfLfoDepth = DataLocation;
+    break;
+  case SDL_LFO_SHAPE:
+    psSimpleDelayLine->m_pfLfoShape = DataLocation;
+    break;
+  case SDL_LFO_STEREO_PHASE:
+    psSimpleDelayLine->m_pfLfoStereoPhase = DataLocation;
+    break;
+  case SDL_FEEDBACK:
+    psSimpleDelayLine->m_pfFeedback = DataLocation;
+    break;
+  case SDL_FEEDBACK_LOW_PASS:
+    psSimpleDelayLine->m_pfFeedbackLowPass = DataLocation;
+    break;
+  case SDL_FEEDBACK_HIGH_PASS:
+    psSimpleDelayLine->m_pfFeedbackHighPass = DataLocation;
+    break;
+  case SDL_SATURATION:
+    psSimpleDelayLine->m_pfSaturation = DataLocation;
+    break;
+  case SDL_CROSS_FEEDBACK:
+    psSimpleDelayLine->m_pfCrossFeedback = DataLocation;
+    break;
+  case SDL_REVERSE:
+    psSimpleDelayLine->m_pfReverse = DataLocation;
+    break;
+  case SDL_PITCH_SHIFT:
+    psSimpleDelayLine->m_pfPitchShift = DataLocation;
+    break;
+  case SDL_FOUR_READ_HEADS:
+    psSimpleDelayLine->m_pfFourReadHeads = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// The kernels below come in several modes. The plain ones replace the
+// content of the output buffer (run()), the ones carrying the Adding
+// suffix accumulate onto it (run_adding()). In the latter case the
+// caller scales the mix by the run_adding gain.
+//
+// The mix-and-copy kernels additionally come in InPlace modes used
+// whenever the host connected the input and the output port of a
+// channel to the same buffer. They ignore pfOutput and load and store
+// each sample of the host buffer exactly once.
+//
+// SDL_ADDING##Mode and SDL_IN_PLACE##Mode expand to compile time
+// constants to tell the modes apart.
+#define SDL_ADDING                    0
+#define SDL_ADDINGAdding              1
+#define SDL_ADDINGInPlace             0
+#define SDL_ADDINGAddingInPlace       1
+#define SDL_IN_PLACE                  0
+#define SDL_IN_PLACEAdding            0
+#define SDL_IN_PLACEInPlace           1
+#define SDL_IN_PLACEAddingInPlace     1
+
+// -------------------------------------------------------------------
+
+// Mix and copy a span of samples in which neither the read nor the
+// write region wraps around the end of the ring buffer. The output is
+// computed before the input is stored so that a read from a location
+// written later on in the same span still sees the old content, just
+// as in the per-sample loop this replaces.
+//
+// The second version is to be inlined with a constant lSampleCount.
+// The caller has to ensure the delay is not shorter than the block.
+// Fully unrolling the scalar loop would only bloat the library, so
+// the compiler is left to vectorise it instead.
+#define DEFINE_MIX_AND_COPY_SPAN_GENERIC(Name, Attributes, Mode)	\
+  static Attributes void						\
+  Name##Generic##Mode(const LADSPA_Data* pfInput,			\
+		      const LADSPA_Data* pfRead,			\
+		      LADSPA_Data* pfWrite,				\
+		      LADSPA_Data* pfOutput,				\
+		      LADSPA_Data fDry,					\
+		      LADSPA_Data fWet,					\
+		      unsigned long lSampleCount) {			\
+									\
+    LADSPA_Data fInputSample;						\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    if (SDL_IN_PLACE##Mode)						\
+      pfOutput = (LADSPA_Data*)pfInput;					\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fInputSample = pfInput[lSampleIndex];				\
+      fOutputSample = (fDry * fInputSample				\
+		       + fWet * pfRead[lSampleIndex]);			\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += (SDL_IN_PLACE##Mode				\
+			  ? fInputSample				\
+			  : pfOutput[lSampleIndex]);			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+      pfWrite[lSampleIndex] = FLUSH_DENORMAL(fInputSample);		\
+    }									\
+  }
+
+#define DEFINE_MIX_AND_COPY_SPANS_GENERIC(Mode)				\
+  DEFINE_MIX_AND_COPY_SPAN_GENERIC(mixAndCopySpan, , Mode)		\
+  DEFINE_MIX_AND_COPY_SPAN_GENERIC(mixAndCopyFixedSpan,			\
+				   inline __attribute__((always_inline)), \
+				   Mode)
+
+DEFINE_MIX_AND_COPY_SPANS_GENERIC()
+DEFINE_MIX_AND_COPY_SPANS_GENERIC(Adding)
+DEFINE_MIX_AND_COPY_SPANS_GENERIC(InPlace)
+DEFINE_MIX_AND_COPY_SPANS_GENERIC(AddingInPlace)
+
+// -------------------------------------------------------------------
+
+// The block sizes hosts use most frequently. Blocks of exactly one of
+// these sizes which do not wrap around the end of the ring buffer are
+// processed by kernels with a trip count fixed at compile time, which
+// the compiler unrolls entirely.
+#define SDL_FIXED_BLOCK_SIZES(Apply, Kernel)	\
+  Apply(Kernel, 32)				\
+  Apply(Kernel, 64)				\
+  Apply(Kernel, 128)				\
+  Apply(Kernel, 256)				\
+  Apply(Kernel, 512)				\
+  Apply(Kernel, 1024)
+
+// -------------------------------------------------------------------
+
+// Process a whole block which does not wrap around the end of the
+// ring buffer and whose delay is not shorter than the block. A switch
+// on the block size picks the fully unrolled kernel, all other sizes
+// go to the span kernel.
+#define SDL_CASE_FIXED_BLOCK_SIZE(Kernel, Size)				\
+  case Size:								\
+    Kernel(pfInput, pfRead, pfWrite, pfOutput, fDry, fWet, Size);	\
+    break;
+
+#define DEFINE_MIX_AND_COPY_BLOCK(Isa, Attributes, Mode)		\
+  static Attributes void						\
+  mixAndCopyBlock##Isa##Mode(const LADSPA_Data* pfInput,		\
+			     const LADSPA_Data* pfRead,			\
+			     LADSPA_Data* pfWrite,			\
+			     LADSPA_Data* pfOutput,			\
+			     LADSPA_Data fDry,				\
+			     LADSPA_Data fWet,				\
+			     unsigned long lSampleCount) {		\
+									\
+    switch (lSampleCount) {						\
+      SDL_FIXED_BLOCK_SIZES(SDL_CASE_FIXED_BLOCK_SIZE,			\
+			    mixAndCopyFixedSpan##Isa##Mode)		\
+    default:								\
+      mixAndCopySpan##Isa##Mode(pfInput, pfRead, pfWrite, pfOutput,	\
+				fDry, fWet, lSampleCount);		\
+      break;								\
+    }									\
+  }
+
+DEFINE_MIX_AND_COPY_BLOCK(Generic, , )
+DEFINE_MIX_AND_COPY_BLOCK(Generic, , Adding)
+DEFINE_MIX_AND_COPY_BLOCK(Generic, , InPlace)
+DEFINE_MIX_AND_COPY_BLOCK(Generic, , AddingInPlace)
+
+// -------------------------------------------------------------------
+
+// Mix the input with a second, delayed source without touching the
+// ring buffer. The span is processed back to front. This way the
+// source may be the input itself at a negative offset even if input
+// and output share the same memory, since every input sample is read
+// before the output overwrites it.
+#define DEFINE_MIX_SPAN_BACKWARDS_GENERIC(Mode)				\
+  static void								\
+  mixSpanBackwardsGeneric##Mode(const LADSPA_Data* pfInput,		\
+				const LADSPA_Data* pfDelayed,		\
+				LADSPA_Data* pfOutput,			\
+				LADSPA_Data fDry,			\
+				LADSPA_Data fWet,			\
+				unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = lSampleCount; lSampleIndex-- > 0; ) {		\
+      fOutputSample = (fDry * pfInput[lSampleIndex]			\
+		       + fWet * pfDelayed[lSampleIndex]);		\
+      if (SDL_ADDING##Mode)						\
+	pfOutput[lSampleIndex] += fOutputSample;			\
+      else								\
+	pfOutput[lSampleIndex] = fOutputSample;				\
+    }									\
+  }
+
+DEFINE_MIX_SPAN_BACKWARDS_GENERIC()
+DEFINE_MIX_SPAN_BACKWARDS_GENERIC(Adding)
+
+// -------------------------------------------------------------------
+
+// Copy (or accumulate) a span of samples to the output, scaled by
+// fGain. The plain version is only ever called with a gain of one and
+// skips the copy altogether for in-place buffers.
+static void copySpanGeneric(const LADSPA_Data* pfSource,
+			    LADSPA_Data* pfOutput,
+			    LADSPA_Data fGain,
+			    unsigned long lSampleCount) {
+  (void)fGain;
+  if (pfOutput != pfSource) {
+    memcpy(pfOutput, pfSource, sizeof(LADSPA_Data) * lSampleCount);
+  }
+}
+
+static void copySpanGenericAdding(const LADSPA_Data* pfSource,
+				  LADSPA_Data* pfOutput,
+				  LADSPA_Data fGain,
+				  unsigned long lSampleCount) {
+
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+    pfOutput[lSampleIndex] += fGain * pfSource[lSampleIndex];
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Copy a span of samples into the ring buffer, flushing subnormal
+// numbers to zero on the way. This way no decaying tail written into
+// the ring buffer can slow down the arithmetic reading it back later
+// on, regardless of the floating point environment.
+static void flushSpanGeneric(const LADSPA_Data* pfSource,
+			     LADSPA_Data* pfDestination,
+			     unsigned long lSampleCount) {
+
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+    pfDestination[lSampleIndex] = FLUSH_DENORMAL(pfSource[lSampleIndex]);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Silence the output of an idle channel. When accumulating onto the
+// output there is nothing to do at all and in place the silent input
+// already is the output.
+static void silenceSpanGeneric(const LADSPA_Data* pfInput,
+			       LADSPA_Data* pfOutput,
+			       unsigned long lSampleCount) {
+  if (pfOutput != pfInput) {
+    memset(pfOutput, 0, sizeof(LADSPA_Data) * lSampleCount);
+  }
+}
+
+static void silenceSpanGenericAdding(const LADSPA_Data* pfInput,
+				     LADSPA_Data* pfOutput,
+				     unsigned long lSampleCount) {
+  (void)pfInput;
+  (void)pfOutput;
+  (void)lSampleCount;
+}
+
+// -------------------------------------------------------------------
+
+// Count the digitally silent samples at the end of a span. The scan
+// runs backwards, so a span ending in sound costs a single comparison.
+static unsigned long
+countTrailingSilenceGeneric(const LADSPA_Data* pfInput,
+			    unsigned long lSampleCount) {
+
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = lSampleCount; lSampleIndex > 0; lSampleIndex--) {
+    if (pfInput[lSampleIndex - 1] != 0)
+      break;
+  }
+  return lSampleCount - lSampleIndex;
+}
+
+// -------------------------------------------------------------------
+
+// Mix the input with the fully wet signal pfWet while the wet gain
+// ramps: it is fWet + fWetIncrement at the first sample and changes
+// by fWetIncrement per sample. The mix is scaled by fGain.
+#define DEFINE_MIX_RAMP_SPAN_GENERIC(Mode)				\
+  static void								\
+  mixRampSpanGeneric##Mode(const LADSPA_Data* pfInput,			\
+			   const LADSPA_Data* pfWet,			\
+			   LADSPA_Data* pfOutput,			\
+			   LADSPA_Data fWet,				\
+			   LADSPA_Data fWetIncrement,			\
+			   LADSPA_Data fGain,				\
+			   unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fOutputSample = (fGain						\
+		       * (pfInput[lSampleIndex]				\
+			  + ((fWet + fWetIncrement * (lSampleIndex + 1)) \
+			     * (pfWet[lSampleIndex]			\
+				- pfInput[lSampleIndex]))));		\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += pfOutput[lSampleIndex];			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+    }									\
+  }
+
+DEFINE_MIX_RAMP_SPAN_GENERIC()
+DEFINE_MIX_RAMP_SPAN_GENERIC(Adding)
+
+// -------------------------------------------------------------------
+
+// Run both channels of the plain flavour on a span of samples in a
+// ring buffer of frames. The frames of the span are written to pfWrite
+// before the ones at pfReadLeft and pfReadRight are read back, so the
+// span may overlap the ones it reads from; a delay of zero simply
+// passes the input on. The left samples are read from the frames at
+// pfReadLeft, the right ones from those at pfReadRight. The wet gains
+// ramp like in mixRampSpanGeneric() and the mix is scaled by fGain.
+#define DEFINE_MIX_INTERLEAVED_SPAN_GENERIC(Mode)			\
+  static void								\
+  mixInterleavedSpanGeneric##Mode(const LADSPA_Data* pfInputLeft,	\
+				  const LADSPA_Data* pfInputRight,	\
+				  LADSPA_Data* pfOutputLeft,		\
+				  LADSPA_Data* pfOutputRight,		\
+				  LADSPA_Data* pfWrite,			\
+				  const LADSPA_Data* pfReadLeft,	\
+				  const LADSPA_Data* pfReadRight,	\
+				  LADSPA_Data fWetLeft,			\
+				  LADSPA_Data fWetIncrementLeft,	\
+				  LADSPA_Data fWetRight,		\
+				  LADSPA_Data fWetIncrementRight,	\
+				  LADSPA_Data fGain,			\
+				  unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data fInputLeft;						\
+    LADSPA_Data fInputRight;						\
+    LADSPA_Data fOutputLeft;						\
+    LADSPA_Data fOutputRight;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fInputLeft = pfInputLeft[lSampleIndex];				\
+      fInputRight = pfInputRight[lSampleIndex];				\
+      pfWrite[2 * lSampleIndex] = FLUSH_DENORMAL(fInputLeft);		\
+      pfWrite[2 * lSampleIndex + 1] = FLUSH_DENORMAL(fInputRight);	\
+      fOutputLeft = (fGain						\
+		     * (fInputLeft					\
+			+ ((fWetLeft + fWetIncrementLeft * (lSampleIndex + 1)) \
+			   * (pfReadLeft[2 * lSampleIndex] - fInputLeft)))); \
+      fOutputRight = (fGain						\
+		      * (fInputRight					\
+			 + ((fWetRight					\
+			     + fWetIncrementRight * (lSampleIndex + 1))	\
+			    * (pfReadRight[2 * lSampleIndex + 1]	\
+			       - fInputRight))));			\
+      if (SDL_ADDING##Mode) {						\
+	fOutputLeft += pfOutputLeft[lSampleIndex];			\
+	fOutputRight += pfOutputRight[lSampleIndex];			\
+      }									\
+      pfOutputLeft[lSampleIndex] = fOutputLeft;				\
+      pfOutputRight[lSampleIndex] = fOutputRight;			\
+    }									\
+  }
+
+DEFINE_MIX_INTERLEAVED_SPAN_GENERIC()
+DEFINE_MIX_INTERLEAVED_SPAN_GENERIC(Adding)
+
+// -------------------------------------------------------------------
+
+// Add lTapCount (up to SDL_TAP_GROUP_SIZE) taps read from spans of the
+// ring buffer at ppfRead to pfAccumulator. The gain of each tap ramps
+// like the wet gain in mixRampSpanGeneric(): it is pfGain[lTap] +
+// pfGainIncrement[lTap] at the first sample.
+static void accumulateTapsSpanGeneric(const LADSPA_Data* const* ppfRead,
+				      const LADSPA_Data* pfGain,
+				      const LADSPA_Data* pfGainIncrement,
+				      unsigned long lTapCount,
+				      LADSPA_Data* pfAccumulator,
+				      unsigned long lSampleCount) {
+
+  LADSPA_Data fSum;
+  unsigned long lSampleIndex;
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+    fSum = pfAccumulator[lSampleIndex];
+    for (lTap = 0; lTap < lTapCount; lTap++)
+      fSum += ((pfGain[lTap] + pfGainIncrement[lTap] * (lSampleIndex + 1))
+	       * ppfRead[lTap][lSampleIndex]);
+    pfAccumulator[lSampleIndex] = fSum;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Multiply lBinCount bins of two spectra and add the products to the
+// spectrum pfSum. Each spectrum holds the real parts of its bins
+// followed by the imaginary parts.
+static void multiplyAddSpectraSpanGeneric(const LADSPA_Data* pfInput,
+					  const LADSPA_Data* pfFilter,
+					  LADSPA_Data* pfSum,
+					  unsigned long lBinCount) {
+
+  unsigned long lBin;
+
+  // -----------------------------------------------------------------
+
+  for (lBin = 0; lBin < lBinCount; lBin++) {
+    pfSum[lBin] += (pfInput[lBin] * pfFilter[lBin]
+		    - pfInput[lBinCount + lBin] * pfFilter[lBinCount + lBin]);
+    pfSum[lBinCount + lBin]
+      += (pfInput[lBin] * pfFilter[lBinCount + lBin]
+	  + pfInput[lBinCount + lBin] * pfFilter[lBin]);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Play the two read heads of a channel of the reverse flavour for
+// lSampleCount samples. pfReadFirst and pfReadSecond point to the
+// first samples the heads read, the following ones lie at lower
+// addresses. The window of the first head is fWindow at the first
+// sample and changes by fWindowIncrement every sample, the second
+// head gets the rest. The fully wet output is written to pfWet.
+static void reverseSpanGeneric(const LADSPA_Data* pfReadFirst,
+			       const LADSPA_Data* pfReadSecond,
+			       LADSPA_Data* pfWet,
+			       LADSPA_Data fWindow,
+			       LADSPA_Data fWindowIncrement,
+			       unsigned long lSampleCount) {
+
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++)
+    pfWet[lSampleIndex]
+      = (*(pfReadSecond - lSampleIndex)
+	 + ((fWindow + fWindowIncrement * lSampleIndex)
+	    * (*(pfReadFirst - lSampleIndex)
+	       - *(pfReadSecond - lSampleIndex))));
+}
+
+// -------------------------------------------------------------------
+
+// The window of the read heads of the pitch shifting flavour over a
+// sweep, a raised cosine which is zero at both ends. The windows of
+// two or more heads spread evenly over the sweep add up to half
+// their number. The table is filled when the library is loaded.
+static LADSPA_Data g_afPitchWindow[SDL_PITCH_WINDOW_SIZE];
+
+// Mix lHeads read heads of a channel of the pitch shifting flavour
+// for lSampleCount samples. Sample lSampleIndex of each head is read
+// with linear interpolation at lSampleIndex - fSweep * (its phase)
+// samples from pfBuffer[lReadOffset]. The phase of the first head is
+// fPhase at the first sample and changes by fPhaseIncrement every
+// sample, the other heads follow at equal distances. Each read is
+// weighted by the window at the phase of its head and the fully wet
+// output is written to pfWet.
+static void pitchShiftSpanGeneric(const LADSPA_Data* pfBuffer,
+				  unsigned long lBufferSize,
+				  unsigned long lReadOffset,
+				  LADSPA_Data* pfWet,
+				  LADSPA_Data fPhase,
+				  LADSPA_Data fPhaseIncrement,
+				  LADSPA_Data fSweep,
+				  unsigned long lHeads,
+				  unsigned long lSampleCount) {
+
+  LADSPA_Data fHeadPhase;
+  LADSPA_Data fIndex;
+  LADSPA_Data fPosition;
+  LADSPA_Data fRead;
+  LADSPA_Data fWet;
   unsigned long lBufferSizeMinusOne;
-  unsigned long lBufferWriteOffset;
-  unsigned long lDelayLeft;
-  unsigned long lDelayRight;
+  unsigned long lHead;
+  unsigned long lRead;
   unsigned long lSampleIndex;
 
   // -----------------------------------------------------------------
-  
-  psSimpleDelayLine = (SimpleDelayLine*)Instance;
+
+  lBufferSizeMinusOne = lBufferSize - 1;
+  for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+    fWet = 0;
+    for (lHead = 0; lHead < lHeads; lHead++) {
+      fHeadPhase = ((fPhase + (LADSPA_Data)lHead / lHeads)
+		    + fPhaseIncrement * lSampleIndex);
+      fHeadPhase -= floorf(fHeadPhase);
+      fPosition = lSampleIndex - fSweep * fHeadPhase;
+      fIndex = floorf(fPosition);
+      lRead = (lReadOffset + (long)fIndex) & lBufferSizeMinusOne;
+      fRead = pfBuffer[lRead];
+      fRead += ((fPosition - fIndex)
+		* (pfBuffer[(lRead + 1) & lBufferSizeMinusOne] - fRead));
+      fWet += (g_afPitchWindow[(unsigned long)(fHeadPhase
+					       * SDL_PITCH_WINDOW_SIZE)
+			       & (SDL_PITCH_WINDOW_SIZE - 1)]
+	       * fRead);
+    }
+    pfWet[lSampleIndex] = fWet * (2.0f / lHeads);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run the Lines delay lines of a feedback delay network for
+// lSampleCount samples. The fully wet output is written to
+// pfOutputLeft and pfOutputRight.
+#define DEFINE_FDN_SPAN_GENERIC(Lines)					\
+  static void								\
+  fdn##Lines##SpanGeneric(const LADSPA_Data* pfInputLeft,		\
+			  const LADSPA_Data* pfInputRight,		\
+			  LADSPA_Data* pfOutputLeft,			\
+			  LADSPA_Data* pfOutputRight,			\
+			  FeedbackDelayNetwork* psNetwork,		\
+			  unsigned long lSampleCount) {			\
+									\
+    LADSPA_Data afState[Lines];						\
+    LADSPA_Data* pfFrames = psNetwork->m_pfFrames;			\
+    LADSPA_Data* pfWrite;						\
+    LADSPA_Data fLeft;							\
+    LADSPA_Data fRight;							\
+    LADSPA_Data fRead;							\
+    LADSPA_Data fSum;							\
+    unsigned long lFrameMask = psNetwork->m_lFrameCount - 1;		\
+    unsigned long lWritePointer = psNetwork->m_lWritePointer;		\
+    unsigned long lLine;						\
+    unsigned long lSampleIndex;						\
+									\
+    memcpy(afState, psNetwork->m_afFilterStates, sizeof(afState));	\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fLeft = 0;							\
+      fRight = 0;							\
+      fSum = 0;								\
+      for (lLine = 0; lLine < Lines; lLine++) {				\
+	fRead = pfFrames[(((lWritePointer - psNetwork->m_alDelays[lLine]) \
+			   & lFrameMask) * Lines)			\
+			 + lLine];					\
+	fLeft += psNetwork->m_afOutputLeft[lLine] * fRead;		\
+	fRight += psNetwork->m_afOutputRight[lLine] * fRead;		\
+	afState[lLine]							\
+	  = FLUSH_DENORMAL(psNetwork->m_afFilterGains[lLine] * fRead	\
+			   + (psNetwork->m_afFilterPoles[lLine]		\
+			      * afState[lLine]));			\
+	fSum += afState[lLine];						\
+      }									\
+      pfOutputLeft[lSampleIndex] = fLeft;				\
+      pfOutputRight[lSampleIndex] = fRight;				\
+									\
+      fSum *= -2.0f / Lines;						\
+      pfWrite = pfFrames + lWritePointer * Lines;			\
+      for (lLine = 0; lLine < Lines; lLine++)				\
+	pfWrite[lLine] = (afState[lLine] + fSum				\
+			  + (psNetwork->m_afInputLeft[lLine]		\
+			     * pfInputLeft[lSampleIndex])		\
+			  + (psNetwork->m_afInputRight[lLine]		\
+			     * pfInputRight[lSampleIndex]));		\
+      lWritePointer = (lWritePointer + 1) & lFrameMask;			\
+    }									\
+									\
+    memcpy(psNetwork->m_afFilterStates, afState, sizeof(afState));	\
+    psNetwork->m_lWritePointer = lWritePointer;				\
+  }
+
+DEFINE_FDN_SPAN_GENERIC(8)
+DEFINE_FDN_SPAN_GENERIC(16)
+
+// -------------------------------------------------------------------
+
+// Run the Combs combs of a comb filter bank for lSampleCount samples.
+// The sum of the inputs is fed into every comb, and the reads are
+// interpolated linearly. The fully wet output is written to
+// pfOutputLeft and pfOutputRight.
+#define DEFINE_COMB_SPAN_GENERIC(Combs)					\
+  static void								\
+  comb##Combs##SpanGeneric(const LADSPA_Data* pfInputLeft,		\
+			   const LADSPA_Data* pfInputRight,		\
+			   LADSPA_Data* pfOutputLeft,			\
+			   LADSPA_Data* pfOutputRight,			\
+			   CombFilterBank* psBank,			\
+			   unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data afState[Combs];						\
+    LADSPA_Data* pfFrames = psBank->m_pfFrames;				\
+    LADSPA_Data fInput;							\
+    LADSPA_Data fLeft;							\
+    LADSPA_Data fRight;							\
+    LADSPA_Data fRead;							\
+    LADSPA_Data fOlder;							\
+    unsigned long lFrameMask = psBank->m_lFrameCount - 1;		\
+    unsigned long lWritePointer = psBank->m_lWritePointer;		\
+    unsigned long lComb;						\
+    unsigned long lSampleIndex;						\
+									\
+    memcpy(afState, psBank->m_afFilterStates, sizeof(afState));		\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fInput = 0.5f * (pfInputLeft[lSampleIndex]			\
+		       + pfInputRight[lSampleIndex]);			\
+      fLeft = 0;							\
+      fRight = 0;							\
+      for (lComb = 0; lComb < Combs; lComb++) {				\
+	fRead = pfFrames[(((lWritePointer - psBank->m_alDelays[lComb])	\
+			   & lFrameMask) * Combs)			\
+			 + lComb];					\
+	fOlder = pfFrames[(((lWritePointer - psBank->m_alDelays[lComb] - 1) \
+			    & lFrameMask) * Combs)			\
+			  + lComb];					\
+	fRead += psBank->m_afFractions[lComb] * (fOlder - fRead);	\
+	fLeft += psBank->m_afOutputLeft[lComb] * fRead;			\
+	fRight += psBank->m_afOutputRight[lComb] * fRead;		\
+	afState[lComb]							\
+	  = FLUSH_DENORMAL(psBank->m_afFilterGains[lComb] * fRead	\
+			   + psBank->m_afFilterPoles[lComb] * afState[lComb]); \
+	pfFrames[lWritePointer * Combs + lComb] = afState[lComb] + fInput; \
+      }									\
+      pfOutputLeft[lSampleIndex] = fLeft;				\
+      pfOutputRight[lSampleIndex] = fRight;				\
+      lWritePointer = (lWritePointer + 1) & lFrameMask;			\
+    }									\
+									\
+    memcpy(psBank->m_afFilterStates, afState, sizeof(afState));		\
+    psBank->m_lWritePointer = lWritePointer;				\
+  }
+
+DEFINE_COMB_SPAN_GENERIC(8)
+DEFINE_COMB_SPAN_GENERIC(16)
+DEFINE_COMB_SPAN_GENERIC(32)
+
+// -------------------------------------------------------------------
+
+// Soft clipping for the feedback path. The cubic x - 4/27 x^3 is a
+// cheap stand-in for tanh: it has a slope of one at zero and levels
+// out at +-1 for inputs of +-1.5, beyond which it is held there.
+static inline LADSPA_Data saturate(LADSPA_Data fSample) {
+  if (fSample > 1.5f)
+    return 1;
+  if (fSample < -1.5f)
+    return -1;
+  return fSample - (LADSPA_Data)(4.0 / 27) * fSample * fSample * fSample;
+}
+
+// Add the feedback to a span of both channels already written to the
+// ring buffers. pfReadLeft and pfReadRight hold what the delay lines
+// read for the span, fully wet. They are filtered, mixed by the
+// feedback matrix, optionally saturated and added to the samples at
+// pfWriteLeft and pfWriteRight. The filters of both channels run in
+// the same loop, so their recursions overlap and the cross terms come
+// for free.
+#define DEFINE_FEEDBACK_SPAN_GENERIC(Name, Saturate)			\
+  static void								\
+  feedback##Name##SpanGeneric(const LADSPA_Data* pfReadLeft,		\
+			      const LADSPA_Data* pfReadRight,		\
+			      LADSPA_Data* pfWriteLeft,			\
+			      LADSPA_Data* pfWriteRight,		\
+			      Feedback* psFeedback,			\
+			      unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data fLowPassLeft = psFeedback->m_afLowPassState[0];		\
+    LADSPA_Data fLowPassRight = psFeedback->m_afLowPassState[1];	\
+    LADSPA_Data fHighPassLeft = psFeedback->m_afHighPassState[0];	\
+    LADSPA_Data fHighPassRight = psFeedback->m_afHighPassState[1];	\
+    LADSPA_Data fFilteredLeft;						\
+    LADSPA_Data fFilteredRight;						\
+    LADSPA_Data fLeft;							\
+    LADSPA_Data fRight;							\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fLowPassLeft += (psFeedback->m_fLowPass				\
+		       * (pfReadLeft[lSampleIndex] - fLowPassLeft));	\
+      fLowPassRight += (psFeedback->m_fLowPass				\
+			* (pfReadRight[lSampleIndex] - fLowPassRight));	\
+      fHighPassLeft += (psFeedback->m_fHighPass				\
+			* (fLowPassLeft - fHighPassLeft));		\
+      fHighPassRight += (psFeedback->m_fHighPass			\
+			 * (fLowPassRight - fHighPassRight));		\
+      fFilteredLeft = fLowPassLeft - fHighPassLeft;			\
+      fFilteredRight = fLowPassRight - fHighPassRight;			\
+      fLeft = (psFeedback->m_fGain * fFilteredLeft			\
+	       + psFeedback->m_fCrossGain * fFilteredRight);		\
+      fRight = (psFeedback->m_fGain * fFilteredRight			\
+		+ psFeedback->m_fCrossGain * fFilteredLeft);		\
+      if (Saturate) {							\
+	fLeft = saturate(fLeft);					\
+	fRight = saturate(fRight);					\
+      }									\
+      pfWriteLeft[lSampleIndex]						\
+	= FLUSH_DENORMAL(pfWriteLeft[lSampleIndex] + fLeft);		\
+      pfWriteRight[lSampleIndex]					\
+	= FLUSH_DENORMAL(pfWriteRight[lSampleIndex] + fRight);		\
+    }									\
+									\
+    psFeedback->m_afLowPassState[0] = fLowPassLeft;			\
+    psFeedback->m_afLowPassState[1] = fLowPassRight;			\
+    psFeedback->m_afHighPassState[0] = fHighPassLeft;			\
+    psFeedback->m_afHighPassState[1] = fHighPassRight;			\
+  }
+
+DEFINE_FEEDBACK_SPAN_GENERIC(, 0)
+DEFINE_FEEDBACK_SPAN_GENERIC(Saturating, 1)
+
+// -------------------------------------------------------------------
+
+// Coefficients of a fractional delay interpolator for one block. Tap
+// k of an output sample is read k samples before the newest one, so
+// an interpolator reaches m_lTaps - 1 samples further back than the
+// delay of its newest tap.
+//
+// The coefficients of the FIR interpolators already include the wet
+// gain. The allpass keeps its coefficient in the first and the wet
+// gain in the second slot.
+typedef struct {
+  unsigned long m_lTaps;
+  LADSPA_Data m_afCoefficients[SDL_INTERPOLATION_TAPS];
+
+  // Output of the allpass for the previous sample.
+  LADSPA_Data m_fState;
+} Interpolator;
+
+// -------------------------------------------------------------------
+
+// Mix the input with the output of an FIR interpolator reading Taps
+// consecutive samples of the ring buffer. pfRead points to the newest
+// tap of the first output sample and none of the taps of the span may
+// wrap around the end of the ring buffer.
+#define DEFINE_INTERPOLATE_SPAN_GENERIC(Name, Taps, Mode)		\
+  static void								\
+  interpolate##Name##SpanGeneric##Mode(const LADSPA_Data* pfRead,	\
+				       const LADSPA_Data* pfInput,	\
+				       LADSPA_Data* pfOutput,		\
+				       Interpolator* psInterpolator,	\
+				       LADSPA_Data fDry,		\
+				       unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data afCoefficients[Taps];					\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+    unsigned long lTap;							\
+									\
+    for (lTap = 0; lTap < Taps; lTap++)					\
+      afCoefficients[lTap] = psInterpolator->m_afCoefficients[lTap];	\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fOutputSample = fDry * pfInput[lSampleIndex];			\
+      for (lTap = 0; lTap < Taps; lTap++)				\
+	fOutputSample += (afCoefficients[lTap]				\
+			  * (pfRead - lTap)[lSampleIndex]);		\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += pfOutput[lSampleIndex];			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+    }									\
+  }
+
+DEFINE_INTERPOLATE_SPAN_GENERIC(Linear, 2, )
+DEFINE_INTERPOLATE_SPAN_GENERIC(Linear, 2, Adding)
+DEFINE_INTERPOLATE_SPAN_GENERIC(Cubic, 4, )
+DEFINE_INTERPOLATE_SPAN_GENERIC(Cubic, 4, Adding)
+
+// -------------------------------------------------------------------
+
+// Same as above for the first-order allpass interpolator. The
+// non-recursive part is kept off the dependency chain, which leaves a
+// single multiply-add per sample on it.
+#define DEFINE_INTERPOLATE_ALLPASS_SPAN_GENERIC(Mode)			\
+  static void								\
+  interpolateAllpassSpanGeneric##Mode(const LADSPA_Data* pfRead,	\
+				      const LADSPA_Data* pfInput,	\
+				      LADSPA_Data* pfOutput,		\
+				      Interpolator* psInterpolator,	\
+				      LADSPA_Data fDry,			\
+				      unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data fCoefficient;						\
+    LADSPA_Data fOutputSample;						\
+    LADSPA_Data fState;							\
+    LADSPA_Data fWet;							\
+    unsigned long lSampleIndex;						\
+									\
+    fCoefficient = psInterpolator->m_afCoefficients[0];			\
+    fWet = psInterpolator->m_afCoefficients[1];				\
+    fState = psInterpolator->m_fState;					\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fState = ((fCoefficient * pfRead[lSampleIndex]			\
+		 + (pfRead - 1)[lSampleIndex])				\
+		- fCoefficient * fState);				\
+      fOutputSample = fDry * pfInput[lSampleIndex] + fWet * fState;	\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += pfOutput[lSampleIndex];			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+    }									\
+    psInterpolator->m_fState = FLUSH_DENORMAL(fState);			\
+  }
+
+DEFINE_INTERPOLATE_ALLPASS_SPAN_GENERIC()
+DEFINE_INTERPOLATE_ALLPASS_SPAN_GENERIC(Adding)
+
+// -------------------------------------------------------------------
+
+// Mix the input with two read heads crossfaded with equal power. The
+// gain of the fading head is the cosine, the one of the next head the
+// sine of an angle running from 0 to pi / 2 over the crossfade. It
+// starts at fAngle and grows by fAngleIncrement per sample. Both gains
+// are advanced by a rotation, which needs no trigonometric functions
+// per sample and drifts by far less than audible over a span.
+//
+// Other than that, this works like the interpolation kernels above.
+#define DEFINE_CROSSFADE_SPAN_GENERIC(Name, Taps, Mode)			\
+  static void								\
+  crossfade##Name##SpanGeneric##Mode(const LADSPA_Data* pfRead,		\
+				     const LADSPA_Data* pfNextRead,	\
+				     const LADSPA_Data* pfInput,	\
+				     LADSPA_Data* pfOutput,		\
+				     Interpolator* psInterpolator,	\
+				     Interpolator* psNextInterpolator,	\
+				     LADSPA_Data fAngle,		\
+				     LADSPA_Data fAngleIncrement,	\
+				     LADSPA_Data fDry,			\
+				     unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data afCoefficients[Taps];					\
+    LADSPA_Data afNextCoefficients[Taps];				\
+    LADSPA_Data fCos;							\
+    LADSPA_Data fCosIncrement;						\
+    LADSPA_Data fHead;							\
+    LADSPA_Data fNextHead;						\
+    LADSPA_Data fOutputSample;						\
+    LADSPA_Data fSin;							\
+    LADSPA_Data fSinIncrement;						\
+    LADSPA_Data fRotatedCos;						\
+    unsigned long lSampleIndex;						\
+    unsigned long lTap;							\
+									\
+    for (lTap = 0; lTap < Taps; lTap++) {				\
+      afCoefficients[lTap] = psInterpolator->m_afCoefficients[lTap];	\
+      afNextCoefficients[lTap]						\
+	= psNextInterpolator->m_afCoefficients[lTap];			\
+    }									\
+    fCos = cosf(fAngle);						\
+    fSin = sinf(fAngle);						\
+    fCosIncrement = cosf(fAngleIncrement);				\
+    fSinIncrement = sinf(fAngleIncrement);				\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fHead = 0;							\
+      fNextHead = 0;							\
+      for (lTap = 0; lTap < Taps; lTap++) {				\
+	fHead += afCoefficients[lTap] * (pfRead - lTap)[lSampleIndex];	\
+	fNextHead += (afNextCoefficients[lTap]				\
+		      * (pfNextRead - lTap)[lSampleIndex]);		\
+      }									\
+      fOutputSample = (fDry * pfInput[lSampleIndex]			\
+		       + fCos * fHead + fSin * fNextHead);		\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += pfOutput[lSampleIndex];			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+      fRotatedCos = fCos * fCosIncrement - fSin * fSinIncrement;	\
+      fSin = fSin * fCosIncrement + fCos * fSinIncrement;		\
+      fCos = fRotatedCos;						\
+    }									\
+  }
+
+DEFINE_CROSSFADE_SPAN_GENERIC(Linear, 2, )
+DEFINE_CROSSFADE_SPAN_GENERIC(Linear, 2, Adding)
+DEFINE_CROSSFADE_SPAN_GENERIC(Cubic, 4, )
+DEFINE_CROSSFADE_SPAN_GENERIC(Cubic, 4, Adding)
+
+// -------------------------------------------------------------------
+
+// Same as above with two allpass interpolators. The next head starts
+// out with an empty state, but its transient is faded out along with
+// the head which is faded in. Only this generic version exists.
+#define DEFINE_CROSSFADE_ALLPASS_SPAN_GENERIC(Mode)			\
+  static void								\
+  crossfadeAllpassSpanGeneric##Mode(const LADSPA_Data* pfRead,		\
+				    const LADSPA_Data* pfNextRead,	\
+				    const LADSPA_Data* pfInput,		\
+				    LADSPA_Data* pfOutput,		\
+				    Interpolator* psInterpolator,	\
+				    Interpolator* psNextInterpolator,	\
+				    LADSPA_Data fAngle,			\
+				    LADSPA_Data fAngleIncrement,	\
+				    LADSPA_Data fDry,			\
+				    unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data fCoefficient;						\
+    LADSPA_Data fCos;							\
+    LADSPA_Data fCosIncrement;						\
+    LADSPA_Data fNextCoefficient;					\
+    LADSPA_Data fNextState;						\
+    LADSPA_Data fNextWet;						\
+    LADSPA_Data fOutputSample;						\
+    LADSPA_Data fRotatedCos;						\
+    LADSPA_Data fSin;							\
+    LADSPA_Data fSinIncrement;						\
+    LADSPA_Data fState;							\
+    LADSPA_Data fWet;							\
+    unsigned long lSampleIndex;						\
+									\
+    fCoefficient = psInterpolator->m_afCoefficients[0];			\
+    fWet = psInterpolator->m_afCoefficients[1];				\
+    fState = psInterpolator->m_fState;					\
+    fNextCoefficient = psNextInterpolator->m_afCoefficients[0];		\
+    fNextWet = psNextInterpolator->m_afCoefficients[1];			\
+    fNextState = psNextInterpolator->m_fState;				\
+    fCos = cosf(fAngle);						\
+    fSin = sinf(fAngle);						\
+    fCosIncrement = cosf(fAngleIncrement);				\
+    fSinIncrement = sinf(fAngleIncrement);				\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      fState = ((fCoefficient * pfRead[lSampleIndex]			\
+		 + (pfRead - 1)[lSampleIndex])				\
+		- fCoefficient * fState);				\
+      fNextState = ((fNextCoefficient * pfNextRead[lSampleIndex]	\
+		     + (pfNextRead - 1)[lSampleIndex])			\
+		    - fNextCoefficient * fNextState);			\
+      fOutputSample = (fDry * pfInput[lSampleIndex]			\
+		       + fCos * fWet * fState				\
+		       + fSin * fNextWet * fNextState);			\
+      if (SDL_ADDING##Mode)						\
+	fOutputSample += pfOutput[lSampleIndex];			\
+      pfOutput[lSampleIndex] = fOutputSample;				\
+      fRotatedCos = fCos * fCosIncrement - fSin * fSinIncrement;	\
+      fSin = fSin * fCosIncrement + fCos * fSinIncrement;		\
+      fCos = fRotatedCos;						\
+    }									\
+    psInterpolator->m_fState = FLUSH_DENORMAL(fState);			\
+    psNextInterpolator->m_fState = FLUSH_DENORMAL(fNextState);		\
+  }
+
+DEFINE_CROSSFADE_ALLPASS_SPAN_GENERIC()
+DEFINE_CROSSFADE_ALLPASS_SPAN_GENERIC(Adding)
+
+// -------------------------------------------------------------------
+
+// A span of a glide, during which the delay moves towards a new value
+// at a limited rate. The delay of the i-th sample of the span is its
+// whole sample part at the start of the span (which the read offset
+// passed to the kernels refers to) plus
+//
+//   m_fFraction + m_fDistance limited to m_fRate * (i + 1) either way
+//
+// but never less than m_fMinimum, the negative whole sample part,
+// which keeps rounding errors from reaching ahead of the input.
+typedef struct {
+  LADSPA_Data m_fFraction;
+  LADSPA_Data m_fDistance;
+  LADSPA_Data m_fRate;
+  LADSPA_Data m_fMinimum;
+  LADSPA_Data m_fWet;
+} Glide;
+
+// Delay of sample lSampleIndex of a glide span relative to its whole
+// sample part at the start of the span.
+static inline LADSPA_Data getGlideOffset(const Glide* psGlide,
+					 unsigned long lSampleIndex) {
+
+  LADSPA_Data fLimit;
+  LADSPA_Data fOffset;
+
+  // -----------------------------------------------------------------
+
+  fLimit = psGlide->m_fRate * (LADSPA_Data)(lSampleIndex + 1);
+  fOffset = psGlide->m_fDistance;
+  if (fOffset > fLimit)
+    fOffset = fLimit;
+  else if (fOffset < -fLimit)
+    fOffset = -fLimit;
+  fOffset += psGlide->m_fFraction;
+  return fOffset < psGlide->m_fMinimum ? psGlide->m_fMinimum : fOffset;
+}
+
+// A span whose delay is modulated at audio rate. The delay of each
+// sample is the one of the glide span it is read by (a constant one
+// if there is no glide) plus m_fScale times the modulation, but no
+// more than m_fMaximum relative to the whole sample part at the start
+// of the span. The modulation of the SDL_MODULATION_INPUT source is
+// the corresponding sample of m_pfModulation. The LFO sources sweep
+// it between 0 and 2, starting at 0 when their phase (in cycles) is
+// whole; m_fPhase is the phase of the first sample and
+// m_fPhaseIncrement the change from one sample to the next.
+typedef struct {
+  int m_iSource;
+  const LADSPA_Data* m_pfModulation;
+  LADSPA_Data m_fScale;
+  LADSPA_Data m_fPhase;
+  LADSPA_Data m_fPhaseIncrement;
+  LADSPA_Data m_fMaximum;
+} Modulation;
+
+// Limit the delay fOffset of a modulated span to the range the taps
+// can reach. The comparisons are written so that NaN ends up at the
+// maximum, just like in the SIMD versions.
+static inline LADSPA_Data limitModulatedOffset(const Glide* psGlide,
+					       const Modulation* psModulation,
+					       LADSPA_Data fOffset) {
+  fOffset = fOffset < psModulation->m_fMaximum
+    ? fOffset : psModulation->m_fMaximum;
+  return fOffset > psGlide->m_fMinimum ? fOffset : psGlide->m_fMinimum;
+}
+
+// Delay of sample lSampleIndex of a span modulated by its input
+// relative to the whole sample part at its start.
+static inline LADSPA_Data getModulatedOffset(const Glide* psGlide,
+					     const Modulation* psModulation,
+					     unsigned long lSampleIndex) {
+  return limitModulatedOffset(psGlide, psModulation,
+			      getGlideOffset(psGlide, lSampleIndex)
+			      + (psModulation->m_fScale
+				 * psModulation->m_pfModulation[lSampleIndex]));
+}
+
+// Same as above for the triangle LFO, which is computed straight from
+// its phase.
+static inline LADSPA_Data getTriangleOffset(const Glide* psGlide,
+					    const Modulation* psModulation,
+					    unsigned long lSampleIndex) {
+
+  LADSPA_Data fPhase;
+
+  // -----------------------------------------------------------------
+
+  fPhase = (psModulation->m_fPhase
+	    + psModulation->m_fPhaseIncrement * (LADSPA_Data)lSampleIndex);
+  fPhase -= floorf(fPhase + 0.5f);
+  return limitModulatedOffset(psGlide, psModulation,
+			      getGlideOffset(psGlide, lSampleIndex)
+			      + (4 * psModulation->m_fScale
+				 * fabsf(fPhase)));
+}
+
+// The sine LFO is a rotating phasor, which saves calling cosf() for
+// every sample. Its cosine is 1 at a whole phase, the modulation is 1
+// minus the cosine.
+typedef struct {
+  LADSPA_Data m_fCos;
+  LADSPA_Data m_fSin;
+  LADSPA_Data m_fCosIncrement;
+  LADSPA_Data m_fSinIncrement;
+} Oscillator;
+
+// Start psOscillator at sample lSampleIndex of the sine LFO of
+// psModulation.
+static inline void startOscillator(Oscillator* psOscillator,
+				   const Modulation* psModulation,
+				   unsigned long lSampleIndex) {
+
+  LADSPA_Data fAngle;
+  LADSPA_Data fAngleIncrement;
+
+  // -----------------------------------------------------------------
+
+  fAngleIncrement = (LADSPA_Data)(2 * M_PI) * psModulation->m_fPhaseIncrement;
+  fAngle = ((LADSPA_Data)(2 * M_PI) * psModulation->m_fPhase
+	    + fAngleIncrement * (LADSPA_Data)lSampleIndex);
+  psOscillator->m_fCos = cosf(fAngle);
+  psOscillator->m_fSin = sinf(fAngle);
+  psOscillator->m_fCosIncrement = cosf(fAngleIncrement);
+  psOscillator->m_fSinIncrement = sinf(fAngleIncrement);
+}
+
+// Return the modulation of the current sample of the sine LFO and
+// move on to the next one.
+static inline LADSPA_Data advanceOscillator(Oscillator* psOscillator) {
+
+  LADSPA_Data fCos;
+
+  // -----------------------------------------------------------------
+
+  fCos = psOscillator->m_fCos;
+  psOscillator->m_fCos = (fCos * psOscillator->m_fCosIncrement
+			  - psOscillator->m_fSin
+			  * psOscillator->m_fSinIncrement);
+  psOscillator->m_fSin = (psOscillator->m_fSin
+			  * psOscillator->m_fCosIncrement
+			  + fCos * psOscillator->m_fSinIncrement);
+  return 1 - fCos;
+}
+
+// Delay of sample lSampleIndex of a span modulated by the sine LFO,
+// whose oscillator psOscillator has got to that sample.
+static inline LADSPA_Data getSineOffset(const Glide* psGlide,
+					const Modulation* psModulation,
+					Oscillator* psOscillator,
+					unsigned long lSampleIndex) {
+  return limitModulatedOffset(psGlide, psModulation,
+			      getGlideOffset(psGlide, lSampleIndex)
+			      + (psModulation->m_fScale
+				 * advanceOscillator(psOscillator)));
+}
+
+// Delay of a single sample of a span modulated by any of the sources,
+// for use outside of the kernels.
+static LADSPA_Data getAnyModulatedOffset(const Glide* psGlide,
+					 const Modulation* psModulation,
+					 unsigned long lSampleIndex) {
+
+  Oscillator sOscillator;
+
+  // -----------------------------------------------------------------
+
+  switch (psModulation->m_iSource) {
+  case SDL_MODULATION_SINE:
+    startOscillator(&sOscillator, psModulation, lSampleIndex);
+    return getSineOffset(psGlide, psModulation, &sOscillator, lSampleIndex);
+  case SDL_MODULATION_TRIANGLE:
+    return getTriangleOffset(psGlide, psModulation, lSampleIndex);
+  default:
+    return getModulatedOffset(psGlide, psModulation, lSampleIndex);
+  }
+}
+
+// Read sample lSampleIndex of a span with a varying delay from the
+// ring buffer with linear interpolation. The delay is fOffset relative
+// to the whole sample part at the start of the span, whose newest
+// sample is found at lReadOffset; fMinimum is the negative whole
+// sample part. The read position wraps around the end of the buffer.
+static inline LADSPA_Data readLinearSample(const LADSPA_Data* pfBuffer,
+					   unsigned long lBufferSize,
+					   unsigned long lReadOffset,
+					   LADSPA_Data fOffset,
+					   LADSPA_Data fMinimum,
+					   unsigned long lSampleIndex) {
+
+  LADSPA_Data fNewest;
+  LADSPA_Data fWhole;
+  unsigned long lNewestTap;
+
+  // -----------------------------------------------------------------
+
+  (void)fMinimum;
+  fWhole = floorf(fOffset);
+  lNewestTap = ((lReadOffset + lSampleIndex - (unsigned long)(long)fWhole)
+		& (lBufferSize - 1));
+  fNewest = pfBuffer[lNewestTap];
+  return fNewest + ((fOffset - fWhole)
+		    * (pfBuffer[(lNewestTap - 1) & (lBufferSize - 1)]
+		       - fNewest));
+}
+
+// Same as above with third order Lagrange interpolation. As for
+// constant delays, the newest tap is the sample before the delay
+// unless that would be ahead of the input.
+static inline LADSPA_Data readCubicSample(const LADSPA_Data* pfBuffer,
+					  unsigned long lBufferSize,
+					  unsigned long lReadOffset,
+					  LADSPA_Data fOffset,
+					  LADSPA_Data fMinimum,
+					  unsigned long lSampleIndex) {
+
+  LADSPA_Data fFraction;
+  LADSPA_Data fWhole;
+  unsigned long lNewestTap;
+
+  // -----------------------------------------------------------------
+
+  fWhole = floorf(fOffset) - 1;
+  if (fWhole < fMinimum)
+    fWhole = fMinimum;
+  fFraction = fOffset - fWhole;
+  lNewestTap = ((lReadOffset + lSampleIndex - (unsigned long)(long)fWhole)
+		& (lBufferSize - 1));
+  return (-(fFraction - 1) * (fFraction - 2) * (fFraction - 3) / 6
+	  * pfBuffer[lNewestTap]
+	  + fFraction * (fFraction - 2) * (fFraction - 3) / 2
+	  * pfBuffer[(lNewestTap - 1) & (lBufferSize - 1)]
+	  - fFraction * (fFraction - 1) * (fFraction - 3) / 2
+	  * pfBuffer[(lNewestTap - 2) & (lBufferSize - 1)]
+	  + fFraction * (fFraction - 1) * (fFraction - 2) / 6
+	  * pfBuffer[(lNewestTap - 3) & (lBufferSize - 1)]);
+}
+
+// Mix the input with a span read by read##Name##Sample() at the delay
+// fOffset, an expression of lSampleIndex, starting at sample
+// lFirstSample. Shared by all versions of the glide and modulation
+// kernels.
+#define SDL_READ_SAMPLES(Name, Mode, lFirstSample, fOffset)		\
+  for (lSampleIndex = (lFirstSample);					\
+       lSampleIndex < lSampleCount;					\
+       lSampleIndex++) {						\
+    fOutputSample = (fDry * pfInput[lSampleIndex]			\
+		     + psGlide->m_fWet					\
+		     * read##Name##Sample(pfBuffer, lBufferSize,	\
+					  lReadOffset, (fOffset),	\
+					  psGlide->m_fMinimum,		\
+					  lSampleIndex));		\
+    if (SDL_ADDING##Mode)						\
+      fOutputSample += pfOutput[lSampleIndex];				\
+    pfOutput[lSampleIndex] = fOutputSample;				\
+  }
+
+#define DEFINE_GLIDE_SPAN_GENERIC(Name, Mode)				\
+  static void								\
+  glide##Name##SpanGeneric##Mode(const LADSPA_Data* pfBuffer,		\
+				 unsigned long lBufferSize,		\
+				 unsigned long lReadOffset,		\
+				 const LADSPA_Data* pfInput,		\
+				 LADSPA_Data* pfOutput,			\
+				 const Glide* psGlide,			\
+				 LADSPA_Data fDry,			\
+				 unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_READ_SAMPLES(Name, Mode, 0,					\
+		     getGlideOffset(psGlide, lSampleIndex))		\
+  }
+
+DEFINE_GLIDE_SPAN_GENERIC(Linear, )
+DEFINE_GLIDE_SPAN_GENERIC(Linear, Adding)
+DEFINE_GLIDE_SPAN_GENERIC(Cubic, )
+DEFINE_GLIDE_SPAN_GENERIC(Cubic, Adding)
+
+// Mix the input with a span whose delay is modulated by psModulation
+// on top of the one of psGlide.
+#define DEFINE_MODULATE_SPAN_GENERIC(Name, Mode)			\
+  static void								\
+  modulate##Name##SpanGeneric##Mode(const LADSPA_Data* pfBuffer,	\
+				    unsigned long lBufferSize,		\
+				    unsigned long lReadOffset,		\
+				    const LADSPA_Data* pfInput,		\
+				    LADSPA_Data* pfOutput,		\
+				    const Glide* psGlide,		\
+				    const Modulation* psModulation,	\
+				    LADSPA_Data fDry,			\
+				    unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_READ_SAMPLES(Name, Mode, 0,					\
+		     getModulatedOffset(psGlide, psModulation,		\
+					lSampleIndex))			\
+  }
+
+DEFINE_MODULATE_SPAN_GENERIC(Linear, )
+DEFINE_MODULATE_SPAN_GENERIC(Linear, Adding)
+DEFINE_MODULATE_SPAN_GENERIC(Cubic, )
+DEFINE_MODULATE_SPAN_GENERIC(Cubic, Adding)
+
+// Mix the input with a span whose delay is modulated by the LFO of
+// psModulation on top of the one of psGlide. The same kernel reads
+// the delay line and runs the LFO, so a chorus voice takes a single
+// pass over the block.
+#define DEFINE_LFO_SINE_SPAN_GENERIC(Name, Mode)			\
+  static void								\
+  lfoSine##Name##SpanGeneric##Mode(const LADSPA_Data* pfBuffer,		\
+				   unsigned long lBufferSize,		\
+				   unsigned long lReadOffset,		\
+				   const LADSPA_Data* pfInput,		\
+				   LADSPA_Data* pfOutput,		\
+				   const Glide* psGlide,		\
+				   const Modulation* psModulation,	\
+				   LADSPA_Data fDry,			\
+				   unsigned long lSampleCount) {	\
+									\
+    Oscillator sOscillator;						\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    startOscillator(&sOscillator, psModulation, 0);			\
+    SDL_READ_SAMPLES(Name, Mode, 0,					\
+		     getSineOffset(psGlide, psModulation, &sOscillator,	\
+				   lSampleIndex))			\
+  }
+
+#define DEFINE_LFO_TRIANGLE_SPAN_GENERIC(Name, Mode)			\
+  static void								\
+  lfoTriangle##Name##SpanGeneric##Mode(const LADSPA_Data* pfBuffer,	\
+				       unsigned long lBufferSize,	\
+				       unsigned long lReadOffset,	\
+				       const LADSPA_Data* pfInput,	\
+				       LADSPA_Data* pfOutput,		\
+				       const Glide* psGlide,		\
+				       const Modulation* psModulation,	\
+				       LADSPA_Data fDry,		\
+				       unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data fOutputSample;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_READ_SAMPLES(Name, Mode, 0,					\
+		     getTriangleOffset(psGlide, psModulation,		\
+				       lSampleIndex))			\
+  }
+
+DEFINE_LFO_SINE_SPAN_GENERIC(Linear, )
+DEFINE_LFO_SINE_SPAN_GENERIC(Linear, Adding)
+DEFINE_LFO_SINE_SPAN_GENERIC(Cubic, )
+DEFINE_LFO_SINE_SPAN_GENERIC(Cubic, Adding)
+DEFINE_LFO_TRIANGLE_SPAN_GENERIC(Linear, )
+DEFINE_LFO_TRIANGLE_SPAN_GENERIC(Linear, Adding)
+DEFINE_LFO_TRIANGLE_SPAN_GENERIC(Cubic, )
+DEFINE_LFO_TRIANGLE_SPAN_GENERIC(Cubic, Adding)
+
+// -------------------------------------------------------------------
+
+#ifdef SDL_X86_SIMD
+
+// Hand-written SSE2, AVX2+FMA and AVX-512 versions of the span
+// kernels. All of them are compiled into the same shared object using
+// per-function target attributes (so the Makefile does not have to
+// target a particular instruction set) and the best one supported by
+// the CPU is picked when the library is loaded.
+//
+// Each instruction set provides the same handful of primitives, the
+// kernels themselves are written only once as macro templates below.
+#define SDL_TARGET_Sse2   "sse2"
+#define SDL_TARGET_Avx2   "avx2,fma"
+#define SDL_TARGET_Avx512 "avx512f"
+
+#define SDL_WIDTH_Sse2   4
+#define SDL_WIDTH_Avx2   8
+#define SDL_WIDTH_Avx512 16
+
+#define SDL_SIMD_INLINE(Isa)						\
+  static inline __attribute__((always_inline, target(SDL_TARGET_##Isa)))
+
+// -------------------------------------------------------------------
+
+typedef __m128 SdlVectorSse2;
+
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlLoadSse2(const LADSPA_Data* pfData) {
+  return _mm_loadu_ps(pfData);
+}
+SDL_SIMD_INLINE(Sse2) void sdlStoreSse2(LADSPA_Data* pfData,
+					SdlVectorSse2 vData) {
+  _mm_storeu_ps(pfData, vData);
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlSet1Sse2(LADSPA_Data fData) {
+  return _mm_set1_ps(fData);
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlAddSse2(SdlVectorSse2 vA,
+					       SdlVectorSse2 vB) {
+  return _mm_add_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlMulSse2(SdlVectorSse2 vA,
+					       SdlVectorSse2 vB) {
+  return _mm_mul_ps(vA, vB);
+}
+// vA * vB + vC. SSE2 has no fused multiply-add.
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlMulAddSse2(SdlVectorSse2 vA,
+						  SdlVectorSse2 vB,
+						  SdlVectorSse2 vC) {
+  return _mm_add_ps(_mm_mul_ps(vA, vB), vC);
+}
+// Zero all lanes whose magnitude is below FLT_MIN.
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlFlushDenormalsSse2(SdlVectorSse2 vA) {
+  return _mm_and_ps(vA,
+		    _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), vA),
+				 _mm_set1_ps(FLT_MIN)));
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlSubSse2(SdlVectorSse2 vA,
+					       SdlVectorSse2 vB) {
+  return _mm_sub_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlMinSse2(SdlVectorSse2 vA,
+					       SdlVectorSse2 vB) {
+  return _mm_min_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlMaxSse2(SdlVectorSse2 vA,
+					       SdlVectorSse2 vB) {
+  return _mm_max_ps(vA, vB);
+}
+// SSE2 can only truncate, lanes truncated upwards are corrected.
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlFloorSse2(SdlVectorSse2 vA) {
+  SdlVectorSse2 vTruncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(vA));
+  return _mm_sub_ps(vTruncated,
+		    _mm_and_ps(_mm_cmpgt_ps(vTruncated, vA),
+			       _mm_set1_ps(1)));
+}
+// Load pfBuffer[(lOffset + vIndex) & lMask] for whole numbers in
+// vIndex. SSE2 has no gather, the lanes are loaded one by one.
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2 sdlGatherSse2(const LADSPA_Data* pfBuffer,
+						  unsigned long lMask,
+						  unsigned long lOffset,
+						  SdlVectorSse2 vIndex) {
+  int aiIndex[4];
+  _mm_storeu_si128((__m128i*)aiIndex,
+		   _mm_and_si128(_mm_add_epi32(_mm_cvttps_epi32(vIndex),
+					       _mm_set1_epi32((int)(lOffset & lMask))),
+				 _mm_set1_epi32((int)lMask)));
+  return _mm_setr_ps(pfBuffer[aiIndex[0]], pfBuffer[aiIndex[1]],
+		     pfBuffer[aiIndex[2]], pfBuffer[aiIndex[3]]);
+}
+// Sum of all lanes.
+SDL_SIMD_INLINE(Sse2) LADSPA_Data sdlSumSse2(SdlVectorSse2 vA) {
+  vA = _mm_add_ps(vA, _mm_movehl_ps(vA, vA));
+  return _mm_cvtss_f32(_mm_add_ss(vA, _mm_shuffle_ps(vA, vA, 1)));
+}
+// Nonzero if any lane is not digitally silent. Under DAZ subnormal
+// lanes count as silent, just like they do for the scalar comparison.
+SDL_SIMD_INLINE(Sse2) int sdlAnyNonZeroSse2(SdlVectorSse2 vA) {
+  return _mm_movemask_ps(_mm_cmpneq_ps(vA, _mm_setzero_ps()));
+}
+// Load pfData[0], pfData[-1] and so on into the lanes from the lowest
+// one up.
+SDL_SIMD_INLINE(Sse2) SdlVectorSse2
+sdlLoadReversedSse2(const LADSPA_Data* pfData) {
+  SdlVectorSse2 vData = _mm_loadu_ps(pfData - 3);
+  return _mm_shuffle_ps(vData, vData, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// -------------------------------------------------------------------
+
+typedef __m256 SdlVectorAvx2;
+
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlLoadAvx2(const LADSPA_Data* pfData) {
+  return _mm256_loadu_ps(pfData);
+}
+SDL_SIMD_INLINE(Avx2) void sdlStoreAvx2(LADSPA_Data* pfData,
+					SdlVectorAvx2 vData) {
+  _mm256_storeu_ps(pfData, vData);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlSet1Avx2(LADSPA_Data fData) {
+  return _mm256_set1_ps(fData);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlAddAvx2(SdlVectorAvx2 vA,
+					       SdlVectorAvx2 vB) {
+  return _mm256_add_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlMulAvx2(SdlVectorAvx2 vA,
+					       SdlVectorAvx2 vB) {
+  return _mm256_mul_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlMulAddAvx2(SdlVectorAvx2 vA,
+						  SdlVectorAvx2 vB,
+						  SdlVectorAvx2 vC) {
+  return _mm256_fmadd_ps(vA, vB, vC);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlFlushDenormalsAvx2(SdlVectorAvx2 vA) {
+  return _mm256_and_ps(vA,
+		       _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), vA),
+				     _mm256_set1_ps(FLT_MIN),
+				     _CMP_GE_OQ));
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlSubAvx2(SdlVectorAvx2 vA,
+					       SdlVectorAvx2 vB) {
+  return _mm256_sub_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlMinAvx2(SdlVectorAvx2 vA,
+					       SdlVectorAvx2 vB) {
+  return _mm256_min_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlMaxAvx2(SdlVectorAvx2 vA,
+					       SdlVectorAvx2 vB) {
+  return _mm256_max_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlFloorAvx2(SdlVectorAvx2 vA) {
+  return _mm256_floor_ps(vA);
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2 sdlGatherAvx2(const LADSPA_Data* pfBuffer,
+						  unsigned long lMask,
+						  unsigned long lOffset,
+						  SdlVectorAvx2 vIndex) {
+  return _mm256_i32gather_ps(pfBuffer,
+			     _mm256_and_si256(_mm256_add_epi32(_mm256_cvttps_epi32(vIndex),
+							       _mm256_set1_epi32((int)(lOffset & lMask))),
+					      _mm256_set1_epi32((int)lMask)),
+			     sizeof(LADSPA_Data));
+}
+SDL_SIMD_INLINE(Avx2) LADSPA_Data sdlSumAvx2(SdlVectorAvx2 vA) {
+  __m128 vHalf = _mm_add_ps(_mm256_castps256_ps128(vA),
+			    _mm256_extractf128_ps(vA, 1));
+  vHalf = _mm_add_ps(vHalf, _mm_movehl_ps(vHalf, vHalf));
+  return _mm_cvtss_f32(_mm_add_ss(vHalf, _mm_shuffle_ps(vHalf, vHalf, 1)));
+}
+SDL_SIMD_INLINE(Avx2) int sdlAnyNonZeroAvx2(SdlVectorAvx2 vA) {
+  return _mm256_movemask_ps(_mm256_cmp_ps(vA, _mm256_setzero_ps(),
+					  _CMP_NEQ_UQ));
+}
+SDL_SIMD_INLINE(Avx2) SdlVectorAvx2
+sdlLoadReversedAvx2(const LADSPA_Data* pfData) {
+  return _mm256_permutevar8x32_ps(_mm256_loadu_ps(pfData - 7),
+				  _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// -------------------------------------------------------------------
+
+typedef __m512 SdlVectorAvx512;
+
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512
+sdlLoadAvx512(const LADSPA_Data* pfData) {
+  return _mm512_loadu_ps(pfData);
+}
+SDL_SIMD_INLINE(Avx512) void sdlStoreAvx512(LADSPA_Data* pfData,
+					    SdlVectorAvx512 vData) {
+  _mm512_storeu_ps(pfData, vData);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlSet1Avx512(LADSPA_Data fData) {
+  return _mm512_set1_ps(fData);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlAddAvx512(SdlVectorAvx512 vA,
+						     SdlVectorAvx512 vB) {
+  return _mm512_add_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlMulAvx512(SdlVectorAvx512 vA,
+						     SdlVectorAvx512 vB) {
+  return _mm512_mul_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlMulAddAvx512(SdlVectorAvx512 vA,
+							SdlVectorAvx512 vB,
+							SdlVectorAvx512 vC) {
+  return _mm512_fmadd_ps(vA, vB, vC);
+}
+// AVX-512F lacks the floating point and, a zero mask does the job.
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512
+sdlFlushDenormalsAvx512(SdlVectorAvx512 vA) {
+  return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(_mm512_abs_ps(vA),
+						_mm512_set1_ps(FLT_MIN),
+						_CMP_GE_OQ),
+			     vA);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlSubAvx512(SdlVectorAvx512 vA,
+						     SdlVectorAvx512 vB) {
+  return _mm512_sub_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlMinAvx512(SdlVectorAvx512 vA,
+						     SdlVectorAvx512 vB) {
+  return _mm512_min_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlMaxAvx512(SdlVectorAvx512 vA,
+						     SdlVectorAvx512 vB) {
+  return _mm512_max_ps(vA, vB);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512 sdlFloorAvx512(SdlVectorAvx512 vA) {
+  return _mm512_roundscale_ps(vA, _MM_FROUND_TO_NEG_INF);
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512
+sdlGatherAvx512(const LADSPA_Data* pfBuffer,
+		unsigned long lMask,
+		unsigned long lOffset,
+		SdlVectorAvx512 vIndex) {
+  return _mm512_i32gather_ps(_mm512_and_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(vIndex),
+							       _mm512_set1_epi32((int)(lOffset & lMask))),
+					      _mm512_set1_epi32((int)lMask)),
+			     pfBuffer,
+			     sizeof(LADSPA_Data));
+}
+SDL_SIMD_INLINE(Avx512) LADSPA_Data sdlSumAvx512(SdlVectorAvx512 vA) {
+  return _mm512_reduce_add_ps(vA);
+}
+SDL_SIMD_INLINE(Avx512) int sdlAnyNonZeroAvx512(SdlVectorAvx512 vA) {
+  return _mm512_cmp_ps_mask(vA, _mm512_setzero_ps(), _CMP_NEQ_UQ) != 0;
+}
+SDL_SIMD_INLINE(Avx512) SdlVectorAvx512
+sdlLoadReversedAvx512(const LADSPA_Data* pfData) {
+  return _mm512_permutexvar_ps(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8,
+						 7, 6, 5, 4, 3, 2, 1, 0),
+			       _mm512_loadu_ps(pfData - 15));
+}
+
+// -------------------------------------------------------------------
+
+// Store a vector to the output according to the mode of the kernel.
+// In place, the previous content of the output is the input vector
+// already loaded.
+#define SDL_STORE_OUTPUT(Isa, Mode, pfOutput, vInput, vOutput)		\
+  sdlStore##Isa((pfOutput),						\
+		SDL_ADDING##Mode					\
+		? sdlAdd##Isa(SDL_IN_PLACE##Mode			\
+			      ? (vInput)				\
+			      : sdlLoad##Isa(pfOutput),			\
+			      (vOutput))				\
+		: (vOutput))
+
+// -------------------------------------------------------------------
+
+// SIMD version of mixAndCopySpanGeneric(). For delays shorter than
+// one vector a read depends on a write of the very same vector. Such
+// spans (and the remainder of a span not filling a whole vector) are
+// left to the generic kernel.
+#define DEFINE_MIX_AND_COPY_SPAN(Isa, Mode)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  mixAndCopySpan##Isa##Mode(const LADSPA_Data* pfInput,		\
+			    const LADSPA_Data* pfRead,			\
+			    LADSPA_Data* pfWrite,			\
+			    LADSPA_Data* pfOutput,			\
+			    LADSPA_Data fDry,				\
+			    LADSPA_Data fWet,				\
+			    unsigned long lSampleCount) {		\
+									\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vWet;						\
+    unsigned long lSampleIndex;						\
+									\
+    if (SDL_IN_PLACE##Mode)						\
+      pfOutput = (LADSPA_Data*)pfInput;					\
+									\
+    if (pfWrite > pfRead && pfWrite - pfRead < SDL_WIDTH_##Isa) {	\
+      mixAndCopySpanGeneric##Mode(pfInput, pfRead, pfWrite, pfOutput,	\
+				  fDry, fWet, lSampleCount);		\
+      return;								\
+    }									\
+									\
+    vDry = sdlSet1##Isa(fDry);						\
+    vWet = sdlSet1##Isa(fWet);						\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vInput = sdlLoad##Isa(pfInput + lSampleIndex);			\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vInput,	\
+		       sdlMulAdd##Isa(vWet,				\
+				      sdlLoad##Isa(pfRead + lSampleIndex), \
+				      sdlMul##Isa(vDry, vInput)));	\
+      sdlStore##Isa(pfWrite + lSampleIndex,				\
+		    sdlFlushDenormals##Isa(vInput));			\
+    }									\
+									\
+    mixAndCopySpanGeneric##Mode(pfInput + lSampleIndex,			\
+				pfRead + lSampleIndex,			\
+				pfWrite + lSampleIndex,			\
+				pfOutput + lSampleIndex,		\
+				fDry, fWet,				\
+				lSampleCount - lSampleIndex);		\
+  }
+
+// -------------------------------------------------------------------
+
+// SIMD version of mixSpanBackwardsGeneric(). All loads of a vector
+// happen before its store and later vectors only read samples further
+// to the front, so this is safe for in-place processing with any
+// positive offset of the delayed source.
+#define DEFINE_MIX_SPAN_BACKWARDS(Isa, Mode)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  mixSpanBackwards##Isa##Mode(const LADSPA_Data* pfInput,		\
+			      const LADSPA_Data* pfDelayed,		\
+			      LADSPA_Data* pfOutput,			\
+			      LADSPA_Data fDry,				\
+			      LADSPA_Data fWet,				\
+			      unsigned long lSampleCount) {		\
+									\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vWet;						\
+    unsigned long lSampleIndex;						\
+									\
+    vDry = sdlSet1##Isa(fDry);						\
+    vWet = sdlSet1##Isa(fWet);						\
+    for (lSampleIndex = lSampleCount;					\
+	 lSampleIndex >= SDL_WIDTH_##Isa;				\
+	 lSampleIndex -= SDL_WIDTH_##Isa) {				\
+      vInput = sdlLoad##Isa(pfInput + lSampleIndex - SDL_WIDTH_##Isa);	\
+      SDL_STORE_OUTPUT(Isa, Mode,					\
+		       pfOutput + lSampleIndex - SDL_WIDTH_##Isa,	\
+		       vInput,						\
+		       sdlMulAdd##Isa(vWet,				\
+				      sdlLoad##Isa(pfDelayed		\
+						   + lSampleIndex	\
+						   - SDL_WIDTH_##Isa),	\
+				      sdlMul##Isa(vDry, vInput)));	\
+    }									\
+									\
+    mixSpanBackwardsGeneric##Mode(pfInput, pfDelayed, pfOutput,		\
+				  fDry, fWet, lSampleIndex);		\
+  }
+
+// -------------------------------------------------------------------
+
+// SIMD version of mixAndCopyFixedSpanGeneric(). All fixed block sizes
+// are multiples of the widest vector, so there is no remainder.
+#define DEFINE_MIX_AND_COPY_FIXED_SPAN(Isa, Mode)			\
+  SDL_SIMD_INLINE(Isa) void						\
+  mixAndCopyFixedSpan##Isa##Mode(const LADSPA_Data* pfInput,		\
+				 const LADSPA_Data* pfRead,		\
+				 LADSPA_Data* pfWrite,			\
+				 LADSPA_Data* pfOutput,			\
+				 LADSPA_Data fDry,			\
+				 LADSPA_Data fWet,			\
+				 unsigned long lSampleCount) {		\
+									\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vWet;						\
+    unsigned long lSampleIndex;						\
+									\
+    if (SDL_IN_PLACE##Mode)						\
+      pfOutput = (LADSPA_Data*)pfInput;					\
+									\
+    vDry = sdlSet1##Isa(fDry);						\
+    vWet = sdlSet1##Isa(fWet);						\
+    _Pragma("GCC unroll 256")						\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex < lSampleCount;					\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vInput = sdlLoad##Isa(pfInput + lSampleIndex);			\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vInput,	\
+		       sdlMulAdd##Isa(vWet,				\
+				      sdlLoad##Isa(pfRead + lSampleIndex), \
+				      sdlMul##Isa(vDry, vInput)));	\
+      sdlStore##Isa(pfWrite + lSampleIndex,				\
+		    sdlFlushDenormals##Isa(vInput));			\
+    }									\
+  }
+
+// -------------------------------------------------------------------
+
+// SIMD version of copySpanGenericAdding(). The plain copy is left to
+// memcpy() in copySpanGeneric().
+#define DEFINE_COPY_SPAN_ADDING(Isa)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  copySpan##Isa##Adding(const LADSPA_Data* pfSource,			\
+			LADSPA_Data* pfOutput,				\
+			LADSPA_Data fGain,				\
+			unsigned long lSampleCount) {			\
+									\
+    SdlVector##Isa vGain;						\
+    unsigned long lSampleIndex;						\
+									\
+    vGain = sdlSet1##Isa(fGain);					\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      sdlStore##Isa(pfOutput + lSampleIndex,				\
+		    sdlMulAdd##Isa(vGain,				\
+				   sdlLoad##Isa(pfSource + lSampleIndex), \
+				   sdlLoad##Isa(pfOutput + lSampleIndex))); \
+    }									\
+									\
+    copySpanGenericAdding(pfSource + lSampleIndex,			\
+			  pfOutput + lSampleIndex,			\
+			  fGain,					\
+			  lSampleCount - lSampleIndex);			\
+  }
+
+// SIMD version of flushSpanGeneric().
+#define DEFINE_FLUSH_SPAN(Isa)						\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  flushSpan##Isa(const LADSPA_Data* pfSource,				\
+		 LADSPA_Data* pfDestination,				\
+		 unsigned long lSampleCount) {				\
+									\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      sdlStore##Isa(pfDestination + lSampleIndex,			\
+		    sdlFlushDenormals##Isa(sdlLoad##Isa(pfSource	\
+							+ lSampleIndex))); \
+    }									\
+									\
+    flushSpanGeneric(pfSource + lSampleIndex,				\
+		     pfDestination + lSampleIndex,			\
+		     lSampleCount - lSampleIndex);			\
+  }
+
+// SIMD version of countTrailingSilenceGeneric(). Whole vectors are
+// checked from the end until one holds sound, which the scalar scan
+// then pins down within the vector. The last sample is checked on its
+// own first, so a span ending in sound still costs a single
+// comparison.
+#define DEFINE_COUNT_TRAILING_SILENCE(Isa)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) unsigned long	\
+  countTrailingSilence##Isa(const LADSPA_Data* pfInput,			\
+			    unsigned long lSampleCount) {		\
+									\
+    unsigned long lSampleIndex;						\
+									\
+    if (lSampleCount == 0 || pfInput[lSampleCount - 1] != 0)		\
+      return 0;								\
+    for (lSampleIndex = lSampleCount;					\
+	 lSampleIndex >= SDL_WIDTH_##Isa;				\
+	 lSampleIndex -= SDL_WIDTH_##Isa) {				\
+      if (sdlAnyNonZero##Isa(sdlLoad##Isa(pfInput + lSampleIndex	\
+					  - SDL_WIDTH_##Isa)))		\
+	break;								\
+    }									\
+									\
+    return (lSampleCount - lSampleIndex					\
+	    + countTrailingSilenceGeneric(pfInput, lSampleIndex));	\
+  }
+
+// SIMD version of accumulateTapsSpanGeneric(). The taps of the group
+// are summed up in registers, one vector of samples at a time.
+#define DEFINE_ACCUMULATE_TAPS_SPAN(Isa)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  accumulateTapsSpan##Isa(const LADSPA_Data* const* ppfRead,		\
+			  const LADSPA_Data* pfGain,			\
+			  const LADSPA_Data* pfGainIncrement,		\
+			  unsigned long lTapCount,			\
+			  LADSPA_Data* pfAccumulator,			\
+			  unsigned long lSampleCount) {			\
+									\
+    const LADSPA_Data* apfRead[SDL_TAP_GROUP_SIZE];			\
+    LADSPA_Data afCount[SDL_WIDTH_##Isa];				\
+    LADSPA_Data afGain[SDL_TAP_GROUP_SIZE];				\
+    SdlVector##Isa avGain[SDL_TAP_GROUP_SIZE];				\
+    SdlVector##Isa avGainIncrement[SDL_TAP_GROUP_SIZE];			\
+    SdlVector##Isa vCount;						\
+    SdlVector##Isa vSum;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+    unsigned long lTap;							\
+									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      afCount[lSampleIndex] = (LADSPA_Data)(lSampleIndex + 1);		\
+    vCount = sdlLoad##Isa(afCount);					\
+    vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+    for (lTap = 0; lTap < lTapCount; lTap++) {				\
+      avGain[lTap] = sdlSet1##Isa(pfGain[lTap]);			\
+      avGainIncrement[lTap] = sdlSet1##Isa(pfGainIncrement[lTap]);	\
+    }									\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vSum = sdlLoad##Isa(pfAccumulator + lSampleIndex);		\
+      for (lTap = 0; lTap < lTapCount; lTap++)				\
+	vSum = sdlMulAdd##Isa(sdlMulAdd##Isa(avGainIncrement[lTap],	\
+					     vCount,			\
+					     avGain[lTap]),		\
+			      sdlLoad##Isa(ppfRead[lTap] + lSampleIndex), \
+			      vSum);					\
+      sdlStore##Isa(pfAccumulator + lSampleIndex, vSum);		\
+      vCount = sdlAdd##Isa(vCount, vWidth);				\
+    }									\
+									\
+    for (lTap = 0; lTap < lTapCount; lTap++) {				\
+      apfRead[lTap] = ppfRead[lTap] + lSampleIndex;			\
+      afGain[lTap] = pfGain[lTap] + pfGainIncrement[lTap] * lSampleIndex; \
+    }									\
+    accumulateTapsSpanGeneric(apfRead,					\
+			      afGain,					\
+			      pfGainIncrement,				\
+			      lTapCount,				\
+			      pfAccumulator + lSampleIndex,		\
+			      lSampleCount - lSampleIndex);		\
+  }
+
+// SIMD version of multiplyAddSpectraSpanGeneric().
+#define DEFINE_MULTIPLY_ADD_SPECTRA_SPAN(Isa)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  multiplyAddSpectraSpan##Isa(const LADSPA_Data* pfInput,		\
+			      const LADSPA_Data* pfFilter,		\
+			      LADSPA_Data* pfSum,			\
+			      unsigned long lBinCount) {		\
+									\
+    SdlVector##Isa vInputReal;						\
+    SdlVector##Isa vInputImag;						\
+    SdlVector##Isa vFilterReal;						\
+    SdlVector##Isa vFilterImag;						\
+    unsigned long lBin;							\
+									\
+    for (lBin = 0;							\
+	 lBin + SDL_WIDTH_##Isa <= lBinCount;				\
+	 lBin += SDL_WIDTH_##Isa) {					\
+      vInputReal = sdlLoad##Isa(pfInput + lBin);			\
+      vInputImag = sdlLoad##Isa(pfInput + lBinCount + lBin);		\
+      vFilterReal = sdlLoad##Isa(pfFilter + lBin);			\
+      vFilterImag = sdlLoad##Isa(pfFilter + lBinCount + lBin);		\
+      sdlStore##Isa(pfSum + lBin,					\
+		    sdlSub##Isa(sdlMulAdd##Isa(vInputReal,		\
+					       vFilterReal,		\
+					       sdlLoad##Isa(pfSum + lBin)), \
+				sdlMul##Isa(vInputImag, vFilterImag)));	\
+      sdlStore##Isa(pfSum + lBinCount + lBin,				\
+		    sdlMulAdd##Isa(vInputReal,				\
+				   vFilterImag,				\
+				   sdlMulAdd##Isa(vInputImag,		\
+						  vFilterReal,		\
+						  sdlLoad##Isa(pfSum	\
+							       + lBinCount \
+							       + lBin)))); \
+    }									\
+									\
+    for (; lBin < lBinCount; lBin++) {					\
+      pfSum[lBin] += (pfInput[lBin] * pfFilter[lBin]			\
+		      - pfInput[lBinCount + lBin]			\
+		      * pfFilter[lBinCount + lBin]);			\
+      pfSum[lBinCount + lBin]						\
+	+= (pfInput[lBin] * pfFilter[lBinCount + lBin]			\
+	    + pfInput[lBinCount + lBin] * pfFilter[lBin]);		\
+    }									\
+  }
+
+// SIMD version of reverseSpanGeneric(). Whole vectors are loaded below
+// the read positions and their lanes reversed. Like in the ramps, the
+// window of every vector is computed from the start of the span.
+#define DEFINE_REVERSE_SPAN(Isa)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  reverseSpan##Isa(const LADSPA_Data* pfReadFirst,			\
+		   const LADSPA_Data* pfReadSecond,			\
+		   LADSPA_Data* pfWet,					\
+		   LADSPA_Data fWindow,					\
+		   LADSPA_Data fWindowIncrement,			\
+		   unsigned long lSampleCount) {			\
+									\
+    LADSPA_Data afCount[SDL_WIDTH_##Isa];				\
+    SdlVector##Isa vCount;						\
+    SdlVector##Isa vFirst;						\
+    SdlVector##Isa vSecond;						\
+    SdlVector##Isa vWidth;						\
+    SdlVector##Isa vWindow;						\
+    SdlVector##Isa vWindowIncrement;					\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      afCount[lSampleIndex] = (LADSPA_Data)lSampleIndex;		\
+    vCount = sdlLoad##Isa(afCount);					\
+    vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+    vWindow = sdlSet1##Isa(fWindow);					\
+    vWindowIncrement = sdlSet1##Isa(fWindowIncrement);			\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vFirst = sdlLoadReversed##Isa(pfReadFirst - lSampleIndex);	\
+      vSecond = sdlLoadReversed##Isa(pfReadSecond - lSampleIndex);	\
+      sdlStore##Isa(pfWet + lSampleIndex,				\
+		    sdlMulAdd##Isa(sdlMulAdd##Isa(vWindowIncrement,	\
+						  vCount,		\
+						  vWindow),		\
+				   sdlSub##Isa(vFirst, vSecond),	\
+				   vSecond));				\
+      vCount = sdlAdd##Isa(vCount, vWidth);				\
+    }									\
+									\
+    reverseSpanGeneric(pfReadFirst - lSampleIndex,			\
+		       pfReadSecond - lSampleIndex,			\
+		       pfWet + lSampleIndex,				\
+		       fWindow + fWindowIncrement * lSampleIndex,	\
+		       fWindowIncrement,				\
+		       lSampleCount - lSampleIndex);			\
+  }
+
+// SIMD version of pitchShiftSpanGeneric(). The lanes hold consecutive
+// samples, whose phases are computed from the start of the span for
+// every head. Both samples around each read and the window entries
+// are gathered.
+#define DEFINE_PITCH_SHIFT_SPAN(Isa)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  pitchShiftSpan##Isa(const LADSPA_Data* pfBuffer,			\
+		      unsigned long lBufferSize,			\
+		      unsigned long lReadOffset,			\
+		      LADSPA_Data* pfWet,				\
+		      LADSPA_Data fPhase,				\
+		      LADSPA_Data fPhaseIncrement,			\
+		      LADSPA_Data fSweep,				\
+		      unsigned long lHeads,				\
+		      unsigned long lSampleCount) {			\
+									\
+    LADSPA_Data afCount[SDL_WIDTH_##Isa];				\
+    SdlVector##Isa vCount;						\
+    SdlVector##Isa vHeadPhase;						\
+    SdlVector##Isa vIndex;						\
+    SdlVector##Isa vPhaseIncrement;					\
+    SdlVector##Isa vPosition;						\
+    SdlVector##Isa vRead;						\
+    SdlVector##Isa vSweep;						\
+    SdlVector##Isa vTableSize;						\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lBufferSizeMinusOne;					\
+    unsigned long lHead;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      afCount[lSampleIndex] = (LADSPA_Data)lSampleIndex;		\
+    vCount = sdlLoad##Isa(afCount);					\
+    vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+    vPhaseIncrement = sdlSet1##Isa(fPhaseIncrement);			\
+    vSweep = sdlSet1##Isa(fSweep);					\
+    vTableSize = sdlSet1##Isa(SDL_PITCH_WINDOW_SIZE);			\
+    lBufferSizeMinusOne = lBufferSize - 1;				\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vWet = sdlSet1##Isa(0);						\
+      for (lHead = 0; lHead < lHeads; lHead++) {			\
+	vHeadPhase							\
+	  = sdlMulAdd##Isa(vPhaseIncrement, vCount,			\
+			   sdlSet1##Isa(fPhase				\
+					+ (LADSPA_Data)lHead / lHeads)); \
+	vHeadPhase = sdlSub##Isa(vHeadPhase, sdlFloor##Isa(vHeadPhase)); \
+	vPosition = sdlSub##Isa(vCount, sdlMul##Isa(vSweep, vHeadPhase)); \
+	vIndex = sdlFloor##Isa(vPosition);				\
+	vRead = sdlGather##Isa(pfBuffer, lBufferSizeMinusOne,		\
+			       lReadOffset, vIndex);			\
+	vRead = sdlMulAdd##Isa(sdlSub##Isa(vPosition, vIndex),		\
+			       sdlSub##Isa(sdlGather##Isa(pfBuffer,	\
+							  lBufferSizeMinusOne, \
+							  lReadOffset + 1, \
+							  vIndex),	\
+					   vRead),			\
+			       vRead);					\
+	vWet = sdlMulAdd##Isa(sdlGather##Isa(g_afPitchWindow,		\
+					     SDL_PITCH_WINDOW_SIZE - 1, 0, \
+					     sdlMul##Isa(vHeadPhase,	\
+							 vTableSize)),	\
+			      vRead,					\
+			      vWet);					\
+      }									\
+      sdlStore##Isa(pfWet + lSampleIndex,				\
+		    sdlMul##Isa(vWet, sdlSet1##Isa(2.0f / lHeads)));	\
+      vCount = sdlAdd##Isa(vCount, vWidth);				\
+    }									\
+									\
+    pitchShiftSpanGeneric(pfBuffer,					\
+			  lBufferSize,					\
+			  lReadOffset + lSampleIndex,			\
+			  pfWet + lSampleIndex,				\
+			  fPhase + fPhaseIncrement * lSampleIndex,	\
+			  fPhaseIncrement,				\
+			  fSweep,					\
+			  lHeads,					\
+			  lSampleCount - lSampleIndex);			\
+  }
+
+// SIMD version of mixRampSpanGeneric(). The wet gain of every vector
+// is computed from the start of the ramp so that no error adds up.
+#define DEFINE_MIX_RAMP_SPAN(Isa, Mode)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  mixRampSpan##Isa##Mode(const LADSPA_Data* pfInput,			\
+			 const LADSPA_Data* pfWet,			\
+			 LADSPA_Data* pfOutput,				\
+			 LADSPA_Data fWet,				\
+			 LADSPA_Data fWetIncrement,			\
+			 LADSPA_Data fGain,				\
+			 unsigned long lSampleCount) {			\
+									\
+    LADSPA_Data afCount[SDL_WIDTH_##Isa];				\
+    SdlVector##Isa vCount;						\
+    SdlVector##Isa vGain;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWetIncrement;					\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      afCount[lSampleIndex] = (LADSPA_Data)(lSampleIndex + 1);		\
+    vCount = sdlLoad##Isa(afCount);					\
+    vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+    vGain = sdlSet1##Isa(fGain);					\
+    vWet = sdlSet1##Isa(fWet);						\
+    vWetIncrement = sdlSet1##Isa(fWetIncrement);			\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vInput = sdlLoad##Isa(pfInput + lSampleIndex);			\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vInput,	\
+		       sdlMul##Isa(vGain,				\
+				   sdlMulAdd##Isa(sdlMulAdd##Isa(vWetIncrement, \
+								 vCount, \
+								 vWet), \
+						  sdlSub##Isa(sdlLoad##Isa(pfWet \
+									   + lSampleIndex), \
+							      vInput),	\
+						  vInput)));		\
+      vCount = sdlAdd##Isa(vCount, vWidth);				\
+    }									\
+									\
+    mixRampSpanGeneric##Mode(pfInput + lSampleIndex,			\
+			     pfWet + lSampleIndex,			\
+			     pfOutput + lSampleIndex,			\
+			     fWet + fWetIncrement * lSampleIndex,	\
+			     fWetIncrement,				\
+			     fGain,					\
+			     lSampleCount - lSampleIndex);		\
+  }
+
+// -------------------------------------------------------------------
+
+// SIMD version of the FIR interpolators. Every tap is a separate
+// unaligned load of the same, already cached region.
+#define DEFINE_INTERPOLATE_SPAN(Isa, Name, Taps, Mode)			\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  interpolate##Name##Span##Isa##Mode(const LADSPA_Data* pfRead,		\
+				     const LADSPA_Data* pfInput,	\
+				     LADSPA_Data* pfOutput,		\
+				     Interpolator* psInterpolator,	\
+				     LADSPA_Data fDry,			\
+				     unsigned long lSampleCount) {	\
+									\
+    SdlVector##Isa avCoefficients[Taps];				\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vOutput;						\
+    unsigned long lSampleIndex;						\
+    unsigned long lTap;							\
+									\
+    vDry = sdlSet1##Isa(fDry);						\
+    for (lTap = 0; lTap < Taps; lTap++)					\
+      avCoefficients[lTap]						\
+	= sdlSet1##Isa(psInterpolator->m_afCoefficients[lTap]);		\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vOutput = sdlMul##Isa(vDry, sdlLoad##Isa(pfInput + lSampleIndex)); \
+      for (lTap = 0; lTap < Taps; lTap++)				\
+	vOutput = sdlMulAdd##Isa(avCoefficients[lTap],			\
+				 sdlLoad##Isa(pfRead - lTap		\
+					      + lSampleIndex),		\
+				 vOutput);				\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vOutput,	\
+		       vOutput);					\
+    }									\
+									\
+    interpolate##Name##SpanGeneric##Mode(pfRead + lSampleIndex,		\
+					 pfInput + lSampleIndex,	\
+					 pfOutput + lSampleIndex,	\
+					 psInterpolator,		\
+					 fDry,				\
+					 lSampleCount - lSampleIndex);	\
+  }
+
+// SIMD version of interpolateAllpassSpanGeneric(). Within a vector
+// the recursion is unrolled: each output is the sum of the allpass
+// inputs up to it and the last output of the previous vector, weighted
+// by powers of the negated coefficient. The columns of that weight
+// matrix are unaligned loads from a single table of powers. Only the
+// last output remains on the dependency chain from vector to vector.
+#define DEFINE_INTERPOLATE_ALLPASS_SPAN(Isa, Mode)			\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  interpolateAllpassSpan##Isa##Mode(const LADSPA_Data* pfRead,		\
+				    const LADSPA_Data* pfInput,		\
+				    LADSPA_Data* pfOutput,		\
+				    Interpolator* psInterpolator,	\
+				    LADSPA_Data fDry,			\
+				    unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data afPowers[2 * SDL_WIDTH_##Isa];				\
+    LADSPA_Data afAllpassInput[SDL_WIDTH_##Isa];			\
+    LADSPA_Data afAllpassOutput[SDL_WIDTH_##Isa];			\
+    LADSPA_Data fState;							\
+    SdlVector##Isa vCarry;						\
+    SdlVector##Isa vCoefficient;					\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vEven;						\
+    SdlVector##Isa vOdd;						\
+    SdlVector##Isa vAllpassOutput;					\
+    SdlVector##Isa vWet;						\
+    unsigned long lSampleIndex;						\
+    unsigned long lIndex;						\
+									\
+    for (lIndex = 0; lIndex < SDL_WIDTH_##Isa - 1; lIndex++)		\
+      afPowers[lIndex] = 0;						\
+    afPowers[SDL_WIDTH_##Isa - 1] = 1;					\
+    for (lIndex = SDL_WIDTH_##Isa; lIndex < 2 * SDL_WIDTH_##Isa; lIndex++) \
+      afPowers[lIndex] = (-psInterpolator->m_afCoefficients[0]		\
+			  * afPowers[lIndex - 1]);			\
+									\
+    vCarry = sdlLoad##Isa(afPowers + SDL_WIDTH_##Isa);			\
+    vCoefficient = sdlSet1##Isa(psInterpolator->m_afCoefficients[0]);	\
+    vDry = sdlSet1##Isa(fDry);						\
+    vWet = sdlSet1##Isa(psInterpolator->m_afCoefficients[1]);		\
+    fState = psInterpolator->m_fState;					\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      sdlStore##Isa(afAllpassInput,					\
+		    sdlMulAdd##Isa(vCoefficient,			\
+				   sdlLoad##Isa(pfRead + lSampleIndex),	\
+				   sdlLoad##Isa(pfRead - 1		\
+						+ lSampleIndex)));	\
+      vEven = sdlMul##Isa(sdlSet1##Isa(afAllpassInput[0]),		\
+			  sdlLoad##Isa(afPowers + SDL_WIDTH_##Isa - 1)); \
+      vOdd = sdlMul##Isa(sdlSet1##Isa(afAllpassInput[1]),		\
+			 sdlLoad##Isa(afPowers + SDL_WIDTH_##Isa - 2));	\
+      for (lIndex = 2; lIndex < SDL_WIDTH_##Isa; lIndex += 2) {		\
+	vEven = sdlMulAdd##Isa(sdlSet1##Isa(afAllpassInput[lIndex]),	\
+			       sdlLoad##Isa(afPowers			\
+					    + SDL_WIDTH_##Isa - 1	\
+					    - lIndex),			\
+			       vEven);					\
+	vOdd = sdlMulAdd##Isa(sdlSet1##Isa(afAllpassInput[lIndex + 1]),	\
+			      sdlLoad##Isa(afPowers			\
+					   + SDL_WIDTH_##Isa - 2	\
+					   - lIndex),			\
+			      vOdd);					\
+      }									\
+      vAllpassOutput = sdlMulAdd##Isa(sdlSet1##Isa(fState), vCarry,	\
+				      sdlAdd##Isa(vEven, vOdd));	\
+      sdlStore##Isa(afAllpassOutput, vAllpassOutput);			\
+      fState = afAllpassOutput[SDL_WIDTH_##Isa - 1];			\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex,		\
+		       vAllpassOutput,					\
+		       sdlMulAdd##Isa(vWet, vAllpassOutput,		\
+				      sdlMul##Isa(vDry,			\
+						  sdlLoad##Isa(pfInput	\
+							       + lSampleIndex)))); \
+    }									\
+									\
+    psInterpolator->m_fState = fState;					\
+    interpolateAllpassSpanGeneric##Mode(pfRead + lSampleIndex,		\
+					pfInput + lSampleIndex,		\
+					pfOutput + lSampleIndex,	\
+					psInterpolator,			\
+					fDry,				\
+					lSampleCount - lSampleIndex);	\
+  }
+
+// -------------------------------------------------------------------
+
+// SIMD version of the FIR crossfade kernels. Both heads are read in
+// the same pass. The lanes of the gain vectors start out at the
+// angles of consecutive samples and are rotated a whole vector ahead
+// at a time.
+#define DEFINE_CROSSFADE_SPAN(Isa, Name, Taps, Mode)			\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  crossfade##Name##Span##Isa##Mode(const LADSPA_Data* pfRead,		\
+				   const LADSPA_Data* pfNextRead,	\
+				   const LADSPA_Data* pfInput,		\
+				   LADSPA_Data* pfOutput,		\
+				   Interpolator* psInterpolator,	\
+				   Interpolator* psNextInterpolator,	\
+				   LADSPA_Data fAngle,			\
+				   LADSPA_Data fAngleIncrement,		\
+				   LADSPA_Data fDry,			\
+				   unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data afCos[SDL_WIDTH_##Isa];					\
+    LADSPA_Data afSin[SDL_WIDTH_##Isa];					\
+    SdlVector##Isa avCoefficients[Taps];				\
+    SdlVector##Isa avNextCoefficients[Taps];				\
+    SdlVector##Isa vCos;						\
+    SdlVector##Isa vCosIncrement;					\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vHead;						\
+    SdlVector##Isa vNegativeSinIncrement;				\
+    SdlVector##Isa vNextHead;						\
+    SdlVector##Isa vRotatedCos;						\
+    SdlVector##Isa vSin;						\
+    SdlVector##Isa vSinIncrement;					\
+    unsigned long lSampleIndex;						\
+    unsigned long lTap;							\
+									\
+    if (lSampleCount < SDL_WIDTH_##Isa) {				\
+      crossfade##Name##SpanGeneric##Mode(pfRead, pfNextRead, pfInput,	\
+					 pfOutput, psInterpolator,	\
+					 psNextInterpolator, fAngle,	\
+					 fAngleIncrement, fDry,		\
+					 lSampleCount);			\
+      return;								\
+    }									\
+									\
+    vDry = sdlSet1##Isa(fDry);						\
+    for (lTap = 0; lTap < Taps; lTap++) {				\
+      avCoefficients[lTap]						\
+	= sdlSet1##Isa(psInterpolator->m_afCoefficients[lTap]);		\
+      avNextCoefficients[lTap]						\
+	= sdlSet1##Isa(psNextInterpolator->m_afCoefficients[lTap]);	\
+    }									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) { \
+      afCos[lSampleIndex] = cosf(fAngle + lSampleIndex * fAngleIncrement); \
+      afSin[lSampleIndex] = sinf(fAngle + lSampleIndex * fAngleIncrement); \
+    }									\
+    vCos = sdlLoad##Isa(afCos);						\
+    vSin = sdlLoad##Isa(afSin);						\
+    vCosIncrement = sdlSet1##Isa(cosf(SDL_WIDTH_##Isa * fAngleIncrement)); \
+    vSinIncrement = sdlSet1##Isa(sinf(SDL_WIDTH_##Isa * fAngleIncrement)); \
+    vNegativeSinIncrement						\
+      = sdlSet1##Isa(-sinf(SDL_WIDTH_##Isa * fAngleIncrement));		\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vHead = sdlMul##Isa(avCoefficients[0],				\
+			  sdlLoad##Isa(pfRead + lSampleIndex));		\
+      vNextHead = sdlMul##Isa(avNextCoefficients[0],			\
+			      sdlLoad##Isa(pfNextRead + lSampleIndex));	\
+      for (lTap = 1; lTap < Taps; lTap++) {				\
+	vHead = sdlMulAdd##Isa(avCoefficients[lTap],			\
+			       sdlLoad##Isa(pfRead - lTap		\
+					    + lSampleIndex),		\
+			       vHead);					\
+	vNextHead = sdlMulAdd##Isa(avNextCoefficients[lTap],		\
+				   sdlLoad##Isa(pfNextRead - lTap	\
+						+ lSampleIndex),	\
+				   vNextHead);				\
+      }									\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vHead,	\
+		       sdlMulAdd##Isa(vCos, vHead,			\
+				      sdlMulAdd##Isa(vSin, vNextHead,	\
+						     sdlMul##Isa(vDry,	\
+								 sdlLoad##Isa(pfInput \
+									      + lSampleIndex))))); \
+      vRotatedCos = sdlMulAdd##Isa(vCos, vCosIncrement,			\
+				   sdlMul##Isa(vSin,			\
+					       vNegativeSinIncrement));	\
+      vSin = sdlMulAdd##Isa(vSin, vCosIncrement,			\
+			    sdlMul##Isa(vCos, vSinIncrement));		\
+      vCos = vRotatedCos;						\
+    }									\
+									\
+    crossfade##Name##SpanGeneric##Mode(pfRead + lSampleIndex,		\
+				       pfNextRead + lSampleIndex,	\
+				       pfInput + lSampleIndex,		\
+				       pfOutput + lSampleIndex,		\
+				       psInterpolator,			\
+				       psNextInterpolator,		\
+				       fAngle + (lSampleIndex		\
+						 * fAngleIncrement),	\
+				       fAngleIncrement,			\
+				       fDry,				\
+				       lSampleCount - lSampleIndex);	\
+  }
+
+#define crossfadeAllpassSpanSse2         crossfadeAllpassSpanGeneric
+#define crossfadeAllpassSpanSse2Adding   crossfadeAllpassSpanGenericAdding
+#define crossfadeAllpassSpanAvx2         crossfadeAllpassSpanGeneric
+#define crossfadeAllpassSpanAvx2Adding   crossfadeAllpassSpanGenericAdding
+#define crossfadeAllpassSpanAvx512       crossfadeAllpassSpanGeneric
+#define crossfadeAllpassSpanAvx512Adding crossfadeAllpassSpanGenericAdding
+
+// -------------------------------------------------------------------
+
+// SIMD versions of getGlideOffset(), readLinearSample() and
+// readCubicSample() for the samples at vSample of a span, whose
+// delays relative to the whole sample part are vOffset. The taps are
+// gathered, so the read position of every lane may wrap around the
+// end of the ring buffer.
+#define DEFINE_GLIDE_VECTORS(Isa)					\
+  SDL_SIMD_INLINE(Isa) SdlVector##Isa					\
+  glideOffsetVector##Isa(SdlVector##Isa vSample,			\
+			 SdlVector##Isa vFraction,			\
+			 SdlVector##Isa vDistance,			\
+			 SdlVector##Isa vRate,				\
+			 SdlVector##Isa vMinimum) {			\
+									\
+    SdlVector##Isa vLimit;						\
+									\
+    vLimit = sdlMul##Isa(vRate, sdlAdd##Isa(vSample, sdlSet1##Isa(1)));	\
+    return sdlMax##Isa(sdlAdd##Isa(vFraction,				\
+				   sdlMin##Isa(sdlMax##Isa(vDistance,	\
+							   sdlSub##Isa(sdlSet1##Isa(0), \
+								       vLimit)), \
+					       vLimit)),		\
+		       vMinimum);					\
+  }									\
+									\
+  SDL_SIMD_INLINE(Isa) SdlVector##Isa					\
+  readLinearVector##Isa(const LADSPA_Data* pfBuffer,			\
+			unsigned long lBufferSize,			\
+			unsigned long lReadOffset,			\
+			SdlVector##Isa vSample,				\
+			SdlVector##Isa vOffset,				\
+			SdlVector##Isa vMinimum) {			\
+									\
+    SdlVector##Isa vIndex;						\
+    SdlVector##Isa vNewest;						\
+    SdlVector##Isa vWhole;						\
+									\
+    (void)vMinimum;							\
+    vWhole = sdlFloor##Isa(vOffset);					\
+    vIndex = sdlSub##Isa(vSample, vWhole);				\
+    vNewest = sdlGather##Isa(pfBuffer, lBufferSize - 1, lReadOffset,	\
+			     vIndex);					\
+    return sdlMulAdd##Isa(sdlSub##Isa(vOffset, vWhole),			\
+			  sdlSub##Isa(sdlGather##Isa(pfBuffer,		\
+						     lBufferSize - 1,	\
+						     lReadOffset - 1,	\
+						     vIndex),		\
+				      vNewest),				\
+			  vNewest);					\
+  }									\
+									\
+  SDL_SIMD_INLINE(Isa) SdlVector##Isa					\
+  readCubicVector##Isa(const LADSPA_Data* pfBuffer,			\
+		       unsigned long lBufferSize,			\
+		       unsigned long lReadOffset,			\
+		       SdlVector##Isa vSample,				\
+		       SdlVector##Isa vOffset,				\
+		       SdlVector##Isa vMinimum) {			\
+									\
+    SdlVector##Isa vFraction;						\
+    SdlVector##Isa vFractionMinus1;					\
+    SdlVector##Isa vFractionMinus2;					\
+    SdlVector##Isa vFractionMinus3;					\
+    SdlVector##Isa vIndex;						\
+    SdlVector##Isa vOne;						\
+    SdlVector##Isa vWhole;						\
+									\
+    vOne = sdlSet1##Isa(1);						\
+    vWhole = sdlMax##Isa(sdlSub##Isa(sdlFloor##Isa(vOffset), vOne),	\
+			 vMinimum);					\
+    vIndex = sdlSub##Isa(vSample, vWhole);				\
+    vFraction = sdlSub##Isa(vOffset, vWhole);				\
+    vFractionMinus1 = sdlSub##Isa(vFraction, vOne);			\
+    vFractionMinus2 = sdlSub##Isa(vFractionMinus1, vOne);		\
+    vFractionMinus3 = sdlSub##Isa(vFractionMinus2, vOne);		\
+    return								\
+      sdlMulAdd##Isa(sdlMul##Isa(sdlMul##Isa(vFractionMinus1,		\
+					     vFractionMinus2),		\
+				 sdlMul##Isa(vFractionMinus3,		\
+					     sdlSet1##Isa(-1.0f / 6))),	\
+		     sdlGather##Isa(pfBuffer, lBufferSize - 1,		\
+				    lReadOffset, vIndex),		\
+      sdlMulAdd##Isa(sdlMul##Isa(sdlMul##Isa(vFraction,			\
+					     vFractionMinus2),		\
+				 sdlMul##Isa(vFractionMinus3,		\
+					     sdlSet1##Isa(0.5f))),	\
+		     sdlGather##Isa(pfBuffer, lBufferSize - 1,		\
+				    lReadOffset - 1, vIndex),		\
+      sdlMulAdd##Isa(sdlMul##Isa(sdlMul##Isa(vFraction,			\
+					     vFractionMinus1),		\
+				 sdlMul##Isa(vFractionMinus3,		\
+					     sdlSet1##Isa(-0.5f))),	\
+		     sdlGather##Isa(pfBuffer, lBufferSize - 1,		\
+				    lReadOffset - 2, vIndex),		\
+		     sdlMul##Isa(sdlMul##Isa(sdlMul##Isa(vFraction,	\
+							 vFractionMinus1), \
+					     sdlMul##Isa(vFractionMinus2, \
+							 sdlSet1##Isa(1.0f / 6))), \
+				 sdlGather##Isa(pfBuffer, lBufferSize - 1, \
+						lReadOffset - 3,	\
+						vIndex)))));		\
+  }
+
+// SIMD version of the glide kernels. The lanes hold consecutive
+// samples; the limit of the distance travelled grows by the rate
+// times the vector width from one vector to the next.
+#define DEFINE_GLIDE_SPAN(Isa, Name, Mode)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  glide##Name##Span##Isa##Mode(const LADSPA_Data* pfBuffer,		\
+			       unsigned long lBufferSize,		\
+			       unsigned long lReadOffset,		\
+			       const LADSPA_Data* pfInput,		\
+			       LADSPA_Data* pfOutput,			\
+			       const Glide* psGlide,			\
+			       LADSPA_Data fDry,			\
+			       unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data afSample[SDL_WIDTH_##Isa];				\
+    LADSPA_Data fOutputSample;						\
+    SdlVector##Isa vDistance;						\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vFraction;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vMinimum;						\
+    SdlVector##Isa vOffset;						\
+    SdlVector##Isa vRate;						\
+    SdlVector##Isa vSample;						\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      afSample[lSampleIndex] = (LADSPA_Data)lSampleIndex;		\
+    vSample = sdlLoad##Isa(afSample);					\
+    vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+    vDistance = sdlSet1##Isa(psGlide->m_fDistance);			\
+    vDry = sdlSet1##Isa(fDry);						\
+    vFraction = sdlSet1##Isa(psGlide->m_fFraction);			\
+    vMinimum = sdlSet1##Isa(psGlide->m_fMinimum);			\
+    vRate = sdlSet1##Isa(psGlide->m_fRate);				\
+    vWet = sdlSet1##Isa(psGlide->m_fWet);				\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vOffset = glideOffsetVector##Isa(vSample, vFraction, vDistance,	\
+				       vRate, vMinimum);		\
+      vInput = sdlLoad##Isa(pfInput + lSampleIndex);			\
+      SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vInput,	\
+		       sdlMulAdd##Isa(vWet,				\
+				      read##Name##Vector##Isa(pfBuffer,	\
+							      lBufferSize, \
+							      lReadOffset, \
+							      vSample,	\
+							      vOffset,	\
+							      vMinimum), \
+				      sdlMul##Isa(vDry, vInput)));	\
+      vSample = sdlAdd##Isa(vSample, vWidth);				\
+    }									\
+									\
+    SDL_READ_SAMPLES(Name, Mode, lSampleIndex,				\
+		     getGlideOffset(psGlide, lSampleIndex))		\
+  }
+
+// Limit the delays vOffset of the lanes of a modulated span, read the
+// delay line at them and mix the result with the input. Shared by the
+// SIMD versions of the modulation kernels.
+#define SDL_READ_MODULATED_VECTOR(Isa, Name, Mode, vOffset)		\
+  vOffset = sdlMax##Isa(sdlMin##Isa(vOffset, vMaximum), vMinimum);	\
+  vInput = sdlLoad##Isa(pfInput + lSampleIndex);			\
+  SDL_STORE_OUTPUT(Isa, Mode, pfOutput + lSampleIndex, vInput,		\
+		   sdlMulAdd##Isa(vWet,					\
+				  read##Name##Vector##Isa(pfBuffer,	\
+							  lBufferSize,	\
+							  lReadOffset,	\
+							  vSample,	\
+							  vOffset,	\
+							  vMinimum),	\
+				  sdlMul##Isa(vDry, vInput)))
+
+// Set up the vectors used by all SIMD versions of the modulation
+// kernels.
+#define SDL_START_MODULATED_VECTORS(Isa)				\
+  for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+    afSample[lSampleIndex] = (LADSPA_Data)lSampleIndex;			\
+  vSample = sdlLoad##Isa(afSample);					\
+  vWidth = sdlSet1##Isa(SDL_WIDTH_##Isa);				\
+  vDistance = sdlSet1##Isa(psGlide->m_fDistance);			\
+  vDry = sdlSet1##Isa(fDry);						\
+  vFraction = sdlSet1##Isa(psGlide->m_fFraction);			\
+  vMaximum = sdlSet1##Isa(psModulation->m_fMaximum);			\
+  vMinimum = sdlSet1##Isa(psGlide->m_fMinimum);				\
+  vRate = sdlSet1##Isa(psGlide->m_fRate);				\
+  vScale = sdlSet1##Isa(psModulation->m_fScale);			\
+  vWet = sdlSet1##Isa(psGlide->m_fWet)
+
+// SIMD version of the modulation kernels. Same as the glide kernels
+// with the modulation added to the delay of each lane.
+#define DEFINE_MODULATE_SPAN(Isa, Name, Mode)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  modulate##Name##Span##Isa##Mode(const LADSPA_Data* pfBuffer,		\
+				  unsigned long lBufferSize,		\
+				  unsigned long lReadOffset,		\
+				  const LADSPA_Data* pfInput,		\
+				  LADSPA_Data* pfOutput,		\
+				  const Glide* psGlide,			\
+				  const Modulation* psModulation,	\
+				  LADSPA_Data fDry,			\
+				  unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data afSample[SDL_WIDTH_##Isa];				\
+    LADSPA_Data fOutputSample;						\
+    const LADSPA_Data* pfModulation;					\
+    SdlVector##Isa vDistance;						\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vFraction;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vMaximum;						\
+    SdlVector##Isa vMinimum;						\
+    SdlVector##Isa vOffset;						\
+    SdlVector##Isa vRate;						\
+    SdlVector##Isa vSample;						\
+    SdlVector##Isa vScale;						\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_START_MODULATED_VECTORS(Isa);					\
+    pfModulation = psModulation->m_pfModulation;			\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vOffset = sdlMulAdd##Isa(vScale,					\
+			       sdlLoad##Isa(pfModulation + lSampleIndex), \
+			       glideOffsetVector##Isa(vSample, vFraction, \
+						      vDistance, vRate,	\
+						      vMinimum));	\
+      SDL_READ_MODULATED_VECTOR(Isa, Name, Mode, vOffset);		\
+      vSample = sdlAdd##Isa(vSample, vWidth);				\
+    }									\
+									\
+    SDL_READ_SAMPLES(Name, Mode, lSampleIndex,				\
+		     getModulatedOffset(psGlide, psModulation,		\
+					lSampleIndex))			\
+  }
+
+// SIMD versions of the sine LFO kernels. The lanes of the phasor
+// start out at the angles of consecutive samples and are rotated a
+// whole vector ahead at a time, by the rotation of a single sample
+// applied once for every lane. The remaining samples carry on from
+// the first lane.
+#define DEFINE_LFO_SINE_SPAN(Isa, Name, Mode)				\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  lfoSine##Name##Span##Isa##Mode(const LADSPA_Data* pfBuffer,		\
+				 unsigned long lBufferSize,		\
+				 unsigned long lReadOffset,		\
+				 const LADSPA_Data* pfInput,		\
+				 LADSPA_Data* pfOutput,			\
+				 const Glide* psGlide,			\
+				 const Modulation* psModulation,	\
+				 LADSPA_Data fDry,			\
+				 unsigned long lSampleCount) {		\
+									\
+    LADSPA_Data afCos[SDL_WIDTH_##Isa];					\
+    LADSPA_Data afSample[SDL_WIDTH_##Isa];				\
+    LADSPA_Data afSin[SDL_WIDTH_##Isa];					\
+    LADSPA_Data fOutputSample;						\
+    Oscillator sOscillator;						\
+    Oscillator sStep;							\
+    SdlVector##Isa vCos;						\
+    SdlVector##Isa vCosIncrement;					\
+    SdlVector##Isa vDistance;						\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vFraction;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vMaximum;						\
+    SdlVector##Isa vMinimum;						\
+    SdlVector##Isa vNegativeSinIncrement;				\
+    SdlVector##Isa vOffset;						\
+    SdlVector##Isa vRate;						\
+    SdlVector##Isa vRotatedCos;						\
+    SdlVector##Isa vSample;						\
+    SdlVector##Isa vScale;						\
+    SdlVector##Isa vSin;						\
+    SdlVector##Isa vSinIncrement;					\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_START_MODULATED_VECTORS(Isa);					\
+    startOscillator(&sOscillator, psModulation, 0);			\
+    for (lSampleIndex = 0; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) { \
+      afCos[lSampleIndex] = sOscillator.m_fCos;				\
+      afSin[lSampleIndex] = sOscillator.m_fSin;				\
+      advanceOscillator(&sOscillator);					\
+    }									\
+    vCos = sdlLoad##Isa(afCos);						\
+    vSin = sdlLoad##Isa(afSin);						\
+    sStep = sOscillator;						\
+    sStep.m_fCos = sStep.m_fCosIncrement;				\
+    sStep.m_fSin = sStep.m_fSinIncrement;				\
+    for (lSampleIndex = 1; lSampleIndex < SDL_WIDTH_##Isa; lSampleIndex++) \
+      advanceOscillator(&sStep);					\
+    vCosIncrement = sdlSet1##Isa(sStep.m_fCos);				\
+    vSinIncrement = sdlSet1##Isa(sStep.m_fSin);				\
+    vNegativeSinIncrement = sdlSet1##Isa(-sStep.m_fSin);		\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vOffset = sdlMulAdd##Isa(vScale,					\
+			       sdlSub##Isa(sdlSet1##Isa(1), vCos),	\
+			       glideOffsetVector##Isa(vSample, vFraction, \
+						      vDistance, vRate,	\
+						      vMinimum));	\
+      SDL_READ_MODULATED_VECTOR(Isa, Name, Mode, vOffset);		\
+      vSample = sdlAdd##Isa(vSample, vWidth);				\
+      vRotatedCos = sdlMulAdd##Isa(vCos, vCosIncrement,			\
+				   sdlMul##Isa(vSin,			\
+					       vNegativeSinIncrement));	\
+      vSin = sdlMulAdd##Isa(vSin, vCosIncrement,			\
+			    sdlMul##Isa(vCos, vSinIncrement));		\
+      vCos = vRotatedCos;						\
+    }									\
+									\
+    sdlStore##Isa(afCos, vCos);						\
+    sdlStore##Isa(afSin, vSin);						\
+    sOscillator.m_fCos = afCos[0];					\
+    sOscillator.m_fSin = afSin[0];					\
+    SDL_READ_SAMPLES(Name, Mode, lSampleIndex,				\
+		     getSineOffset(psGlide, psModulation, &sOscillator,	\
+				   lSampleIndex))			\
+  }
+
+// SIMD versions of the triangle LFO kernels, computed straight from
+// the phase of each lane.
+#define DEFINE_LFO_TRIANGLE_SPAN(Isa, Name, Mode)			\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  lfoTriangle##Name##Span##Isa##Mode(const LADSPA_Data* pfBuffer,	\
+				     unsigned long lBufferSize,		\
+				     unsigned long lReadOffset,		\
+				     const LADSPA_Data* pfInput,	\
+				     LADSPA_Data* pfOutput,		\
+				     const Glide* psGlide,		\
+				     const Modulation* psModulation,	\
+				     LADSPA_Data fDry,			\
+				     unsigned long lSampleCount) {	\
+									\
+    LADSPA_Data afSample[SDL_WIDTH_##Isa];				\
+    LADSPA_Data fOutputSample;						\
+    SdlVector##Isa vDistance;						\
+    SdlVector##Isa vDry;						\
+    SdlVector##Isa vFraction;						\
+    SdlVector##Isa vInput;						\
+    SdlVector##Isa vMaximum;						\
+    SdlVector##Isa vMinimum;						\
+    SdlVector##Isa vOffset;						\
+    SdlVector##Isa vPhase;						\
+    SdlVector##Isa vPhaseIncrement;					\
+    SdlVector##Isa vRate;						\
+    SdlVector##Isa vSample;						\
+    SdlVector##Isa vScale;						\
+    SdlVector##Isa vStartPhase;						\
+    SdlVector##Isa vWet;						\
+    SdlVector##Isa vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    SDL_START_MODULATED_VECTORS(Isa);					\
+    vScale = sdlMul##Isa(vScale, sdlSet1##Isa(4));			\
+    vStartPhase = sdlSet1##Isa(psModulation->m_fPhase);			\
+    vPhaseIncrement = sdlSet1##Isa(psModulation->m_fPhaseIncrement);	\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_##Isa <= lSampleCount;		\
+	 lSampleIndex += SDL_WIDTH_##Isa) {				\
+      vPhase = sdlMulAdd##Isa(vPhaseIncrement, vSample, vStartPhase);	\
+      vPhase = sdlSub##Isa(vPhase,					\
+			   sdlFloor##Isa(sdlAdd##Isa(vPhase,		\
+						     sdlSet1##Isa(0.5f)))); \
+      vPhase = sdlMax##Isa(vPhase, sdlSub##Isa(sdlSet1##Isa(0), vPhase)); \
+      vOffset = sdlMulAdd##Isa(vScale, vPhase,				\
+			       glideOffsetVector##Isa(vSample, vFraction, \
+						      vDistance, vRate,	\
+						      vMinimum));	\
+      SDL_READ_MODULATED_VECTOR(Isa, Name, Mode, vOffset);		\
+      vSample = sdlAdd##Isa(vSample, vWidth);				\
+    }									\
+									\
+    SDL_READ_SAMPLES(Name, Mode, lSampleIndex,				\
+		     getTriangleOffset(psGlide, psModulation,		\
+				       lSampleIndex))			\
+  }
+
+#define DEFINE_INTERPOLATE_SPANS(Isa, Mode)				\
+  DEFINE_INTERPOLATE_SPAN(Isa, Linear, 2, Mode)				\
+  DEFINE_INTERPOLATE_SPAN(Isa, Cubic, 4, Mode)				\
+  DEFINE_INTERPOLATE_ALLPASS_SPAN(Isa, Mode)				\
+  DEFINE_CROSSFADE_SPAN(Isa, Linear, 2, Mode)				\
+  DEFINE_CROSSFADE_SPAN(Isa, Cubic, 4, Mode)				\
+  DEFINE_GLIDE_SPAN(Isa, Linear, Mode)					\
+  DEFINE_GLIDE_SPAN(Isa, Cubic, Mode)					\
+  DEFINE_MODULATE_SPAN(Isa, Linear, Mode)				\
+  DEFINE_MODULATE_SPAN(Isa, Cubic, Mode)				\
+  DEFINE_LFO_SINE_SPAN(Isa, Linear, Mode)				\
+  DEFINE_LFO_SINE_SPAN(Isa, Cubic, Mode)				\
+  DEFINE_LFO_TRIANGLE_SPAN(Isa, Linear, Mode)				\
+  DEFINE_LFO_TRIANGLE_SPAN(Isa, Cubic, Mode)
+
+#define copySpanSse2   copySpanGeneric
+#define copySpanAvx2   copySpanGeneric
+#define copySpanAvx512 copySpanGeneric
+
+// -------------------------------------------------------------------
+
+// Instantiate all kernels for one instruction set.
+#define DEFINE_MIX_AND_COPY_KERNELS(Isa, Mode)				\
+  DEFINE_MIX_AND_COPY_SPAN(Isa, Mode)					\
+  DEFINE_MIX_AND_COPY_FIXED_SPAN(Isa, Mode)				\
+  DEFINE_MIX_AND_COPY_BLOCK(Isa,					\
+			    __attribute__((target(SDL_TARGET_##Isa))),	\
+			    Mode)
+
+#define DEFINE_SIMD_KERNELS(Isa)					\
+  DEFINE_MIX_AND_COPY_KERNELS(Isa, )					\
+  DEFINE_MIX_AND_COPY_KERNELS(Isa, Adding)				\
+  DEFINE_MIX_AND_COPY_KERNELS(Isa, InPlace)				\
+  DEFINE_MIX_AND_COPY_KERNELS(Isa, AddingInPlace)			\
+  DEFINE_MIX_SPAN_BACKWARDS(Isa, )					\
+  DEFINE_MIX_SPAN_BACKWARDS(Isa, Adding)				\
+  DEFINE_COPY_SPAN_ADDING(Isa)						\
+  DEFINE_FLUSH_SPAN(Isa)						\
+  DEFINE_COUNT_TRAILING_SILENCE(Isa)					\
+  DEFINE_MIX_RAMP_SPAN(Isa, )						\
+  DEFINE_MIX_RAMP_SPAN(Isa, Adding)					\
+  DEFINE_ACCUMULATE_TAPS_SPAN(Isa)					\
+  DEFINE_MULTIPLY_ADD_SPECTRA_SPAN(Isa)					\
+  DEFINE_REVERSE_SPAN(Isa)						\
+  DEFINE_PITCH_SHIFT_SPAN(Isa)						\
+  DEFINE_GLIDE_VECTORS(Isa)						\
+  DEFINE_INTERPOLATE_SPANS(Isa, )					\
+  DEFINE_INTERPOLATE_SPANS(Isa, Adding)
+
+DEFINE_SIMD_KERNELS(Sse2)
+DEFINE_SIMD_KERNELS(Avx2)
+DEFINE_SIMD_KERNELS(Avx512)
+
+// -------------------------------------------------------------------
+
+// SIMD version of the fdn##Lines##SpanGeneric() kernels. The recursion
+// runs along the samples, so the lines take the lanes instead: the
+// frame of a sample fills Lines / SDL_WIDTH_##Isa vectors. Each vector
+// of reads is gathered from the frames the delays of its lines point
+// to, and the Householder matrix costs a sum over the lanes and a
+// multiply-add per vector.
+#define DEFINE_FDN_SPAN(Isa, Lines)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  fdn##Lines##Span##Isa(const LADSPA_Data* pfInputLeft,			\
+			const LADSPA_Data* pfInputRight,		\
+			LADSPA_Data* pfOutputLeft,			\
+			LADSPA_Data* pfOutputRight,			\
+			FeedbackDelayNetwork* psNetwork,		\
+			unsigned long lSampleCount) {			\
+									\
+    SdlVector##Isa avReadIndex[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avFilterGain[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avFilterPole[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avState[Lines / SDL_WIDTH_##Isa];			\
+    SdlVector##Isa avInputLeft[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avInputRight[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avOutputLeft[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avOutputRight[Lines / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa vRead;						\
+    SdlVector##Isa vLeft;						\
+    SdlVector##Isa vRight;						\
+    SdlVector##Isa vSum;						\
+    SdlVector##Isa vInputLeft;						\
+    SdlVector##Isa vInputRight;						\
+    LADSPA_Data* pfFrames = psNetwork->m_pfFrames;			\
+    unsigned long lMask = psNetwork->m_lFrameCount * Lines - 1;		\
+    unsigned long lWritePointer = psNetwork->m_lWritePointer;		\
+    unsigned long lSampleIndex;						\
+    unsigned long lVector;						\
+    unsigned long lLane;						\
+									\
+    for (lVector = 0; lVector < Lines / SDL_WIDTH_##Isa; lVector++) {	\
+      lLane = lVector * SDL_WIDTH_##Isa;				\
+      avReadIndex[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afReadIndices + lLane);		\
+      avFilterGain[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afFilterGains + lLane);		\
+      avFilterPole[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afFilterPoles + lLane);		\
+      avState[lVector] = sdlLoad##Isa(psNetwork->m_afFilterStates + lLane); \
+      avInputLeft[lVector] = sdlLoad##Isa(psNetwork->m_afInputLeft + lLane); \
+      avInputRight[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afInputRight + lLane);		\
+      avOutputLeft[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afOutputLeft + lLane);		\
+      avOutputRight[lVector]						\
+	= sdlLoad##Isa(psNetwork->m_afOutputRight + lLane);		\
+    }									\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      vLeft = sdlSet1##Isa(0);						\
+      vRight = sdlSet1##Isa(0);						\
+      vSum = sdlSet1##Isa(0);						\
+      for (lVector = 0; lVector < Lines / SDL_WIDTH_##Isa; lVector++) {	\
+	vRead = sdlGather##Isa(pfFrames, lMask, lWritePointer * Lines,	\
+			       avReadIndex[lVector]);			\
+	vLeft = sdlMulAdd##Isa(avOutputLeft[lVector], vRead, vLeft);	\
+	vRight = sdlMulAdd##Isa(avOutputRight[lVector], vRead, vRight);	\
+	avState[lVector]						\
+	  = sdlFlushDenormals##Isa(sdlMulAdd##Isa(avFilterPole[lVector], \
+						  avState[lVector],	\
+						  sdlMul##Isa(avFilterGain[lVector], \
+							      vRead)));	\
+	vSum = sdlAdd##Isa(vSum, avState[lVector]);			\
+      }									\
+      pfOutputLeft[lSampleIndex] = sdlSum##Isa(vLeft);			\
+      pfOutputRight[lSampleIndex] = sdlSum##Isa(vRight);		\
+									\
+      vSum = sdlSet1##Isa(sdlSum##Isa(vSum) * (-2.0f / Lines));		\
+      vInputLeft = sdlSet1##Isa(pfInputLeft[lSampleIndex]);		\
+      vInputRight = sdlSet1##Isa(pfInputRight[lSampleIndex]);		\
+      for (lVector = 0; lVector < Lines / SDL_WIDTH_##Isa; lVector++)	\
+	sdlStore##Isa(pfFrames + (lWritePointer * Lines			\
+				  + lVector * SDL_WIDTH_##Isa),		\
+		      sdlMulAdd##Isa(avInputLeft[lVector],		\
+				     vInputLeft,			\
+				     sdlMulAdd##Isa(avInputRight[lVector], \
+						    vInputRight,	\
+						    sdlAdd##Isa(avState[lVector], \
+								vSum)))); \
+      lWritePointer = (lWritePointer + 1) & (psNetwork->m_lFrameCount - 1); \
+    }									\
+									\
+    for (lVector = 0; lVector < Lines / SDL_WIDTH_##Isa; lVector++)	\
+      sdlStore##Isa(psNetwork->m_afFilterStates + lVector * SDL_WIDTH_##Isa, \
+		    avState[lVector]);					\
+    psNetwork->m_lWritePointer = lWritePointer;				\
+  }
+
+DEFINE_FDN_SPAN(Sse2, 8)
+DEFINE_FDN_SPAN(Sse2, 16)
+DEFINE_FDN_SPAN(Avx2, 8)
+DEFINE_FDN_SPAN(Avx2, 16)
+DEFINE_FDN_SPAN(Avx512, 16)
+
+// Eight lines fill a single AVX2 vector, AVX-512 has nothing to add.
+#define fdn8SpanAvx512 fdn8SpanAvx2
+
+// -------------------------------------------------------------------
+
+// Run the Combs combs of a comb filter bank with each comb in a lane.
+// The two samples read by each comb are gathered from the frames
+// around its delay, and the new frame is stored with whole vectors.
+#define DEFINE_COMB_SPAN(Isa, Combs)					\
+  static __attribute__((target(SDL_TARGET_##Isa))) void			\
+  comb##Combs##Span##Isa(const LADSPA_Data* pfInputLeft,		\
+			 const LADSPA_Data* pfInputRight,		\
+			 LADSPA_Data* pfOutputLeft,			\
+			 LADSPA_Data* pfOutputRight,			\
+			 CombFilterBank* psBank,			\
+			 unsigned long lSampleCount) {			\
+									\
+    SdlVector##Isa avReadIndex[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avOlderIndex[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avFraction[Combs / SDL_WIDTH_##Isa];			\
+    SdlVector##Isa avFilterGain[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avFilterPole[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avState[Combs / SDL_WIDTH_##Isa];			\
+    SdlVector##Isa avOutputLeft[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa avOutputRight[Combs / SDL_WIDTH_##Isa];		\
+    SdlVector##Isa vRead;						\
+    SdlVector##Isa vOlder;						\
+    SdlVector##Isa vLeft;						\
+    SdlVector##Isa vRight;						\
+    SdlVector##Isa vInput;						\
+    LADSPA_Data* pfFrames = psBank->m_pfFrames;				\
+    unsigned long lMask = psBank->m_lFrameCount * Combs - 1;		\
+    unsigned long lWritePointer = psBank->m_lWritePointer;		\
+    unsigned long lSampleIndex;						\
+    unsigned long lVector;						\
+    unsigned long lLane;						\
+									\
+    for (lVector = 0; lVector < Combs / SDL_WIDTH_##Isa; lVector++) {	\
+      lLane = lVector * SDL_WIDTH_##Isa;				\
+      avReadIndex[lVector] = sdlLoad##Isa(psBank->m_afReadIndices + lLane); \
+      avOlderIndex[lVector]						\
+	= sdlSub##Isa(avReadIndex[lVector], sdlSet1##Isa(Combs));	\
+      avFraction[lVector] = sdlLoad##Isa(psBank->m_afFractions + lLane); \
+      avFilterGain[lVector] = sdlLoad##Isa(psBank->m_afFilterGains + lLane); \
+      avFilterPole[lVector] = sdlLoad##Isa(psBank->m_afFilterPoles + lLane); \
+      avState[lVector] = sdlLoad##Isa(psBank->m_afFilterStates + lLane); \
+      avOutputLeft[lVector] = sdlLoad##Isa(psBank->m_afOutputLeft + lLane); \
+      avOutputRight[lVector]						\
+	= sdlLoad##Isa(psBank->m_afOutputRight + lLane);		\
+    }									\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      vInput = sdlSet1##Isa(0.5f * (pfInputLeft[lSampleIndex]		\
+				    + pfInputRight[lSampleIndex]));	\
+      vLeft = sdlSet1##Isa(0);						\
+      vRight = sdlSet1##Isa(0);						\
+      for (lVector = 0; lVector < Combs / SDL_WIDTH_##Isa; lVector++) {	\
+	vRead = sdlGather##Isa(pfFrames, lMask, lWritePointer * Combs,	\
+			       avReadIndex[lVector]);			\
+	vOlder = sdlGather##Isa(pfFrames, lMask, lWritePointer * Combs,	\
+				avOlderIndex[lVector]);			\
+	vRead = sdlMulAdd##Isa(avFraction[lVector],			\
+			       sdlSub##Isa(vOlder, vRead),		\
+			       vRead);					\
+	vLeft = sdlMulAdd##Isa(avOutputLeft[lVector], vRead, vLeft);	\
+	vRight = sdlMulAdd##Isa(avOutputRight[lVector], vRead, vRight);	\
+	avState[lVector]						\
+	  = sdlFlushDenormals##Isa(sdlMulAdd##Isa(avFilterPole[lVector], \
+						  avState[lVector],	\
+						  sdlMul##Isa(avFilterGain[lVector], \
+							      vRead)));	\
+	sdlStore##Isa(pfFrames + (lWritePointer * Combs			\
+				  + lVector * SDL_WIDTH_##Isa),		\
+		      sdlAdd##Isa(avState[lVector], vInput));		\
+      }									\
+      pfOutputLeft[lSampleIndex] = sdlSum##Isa(vLeft);			\
+      pfOutputRight[lSampleIndex] = sdlSum##Isa(vRight);		\
+      lWritePointer = (lWritePointer + 1) & (psBank->m_lFrameCount - 1); \
+    }									\
+									\
+    for (lVector = 0; lVector < Combs / SDL_WIDTH_##Isa; lVector++)	\
+      sdlStore##Isa(psBank->m_afFilterStates + lVector * SDL_WIDTH_##Isa, \
+		    avState[lVector]);					\
+    psBank->m_lWritePointer = lWritePointer;				\
+  }
+
+DEFINE_COMB_SPAN(Sse2, 8)
+DEFINE_COMB_SPAN(Sse2, 16)
+DEFINE_COMB_SPAN(Sse2, 32)
+DEFINE_COMB_SPAN(Avx2, 8)
+DEFINE_COMB_SPAN(Avx2, 16)
+DEFINE_COMB_SPAN(Avx2, 32)
+DEFINE_COMB_SPAN(Avx512, 16)
+DEFINE_COMB_SPAN(Avx512, 32)
+
+// Eight combs fill a single AVX2 vector as well.
+#define comb8SpanAvx512 comb8SpanAvx2
+
+// -------------------------------------------------------------------
+
+// SSE2 version of feedbackSpanGeneric(). The recursions of the filters
+// cannot be vectorised along the samples, so the two channels occupy
+// the two lower lanes of a vector instead and every step of the
+// filters is computed for both at once. The cross terms of the
+// feedback matrix are a swap of the lanes away. Wider vectors have
+// nothing to add.
+#define DEFINE_FEEDBACK_SPAN_SSE2(Name, Saturate)			\
+  static __attribute__((target(SDL_TARGET_Sse2))) void			\
+  feedback##Name##SpanSse2(const LADSPA_Data* pfReadLeft,		\
+			   const LADSPA_Data* pfReadRight,		\
+			   LADSPA_Data* pfWriteLeft,			\
+			   LADSPA_Data* pfWriteRight,			\
+			   Feedback* psFeedback,			\
+			   unsigned long lSampleCount) {		\
+									\
+    SdlVectorSse2 vLowPassState;					\
+    SdlVectorSse2 vHighPassState;					\
+    SdlVectorSse2 vLowPass;						\
+    SdlVectorSse2 vHighPass;						\
+    SdlVectorSse2 vGain;						\
+    SdlVectorSse2 vCrossGain;						\
+    SdlVectorSse2 vFiltered;						\
+    SdlVectorSse2 vSample;						\
+    SdlVectorSse2 vWrite;						\
+    unsigned long lSampleIndex;						\
+									\
+    vLowPassState = _mm_setr_ps(psFeedback->m_afLowPassState[0],	\
+				psFeedback->m_afLowPassState[1], 0, 0);	\
+    vHighPassState = _mm_setr_ps(psFeedback->m_afHighPassState[0],	\
+				 psFeedback->m_afHighPassState[1], 0, 0); \
+    vLowPass = sdlSet1Sse2(psFeedback->m_fLowPass);			\
+    vHighPass = sdlSet1Sse2(psFeedback->m_fHighPass);			\
+    vGain = sdlSet1Sse2(psFeedback->m_fGain);				\
+    vCrossGain = sdlSet1Sse2(psFeedback->m_fCrossGain);			\
+									\
+    for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) { \
+      vSample = _mm_unpacklo_ps(_mm_load_ss(pfReadLeft + lSampleIndex),	\
+				_mm_load_ss(pfReadRight + lSampleIndex)); \
+      vLowPassState = sdlMulAddSse2(vLowPass,				\
+				    sdlSubSse2(vSample, vLowPassState),	\
+				    vLowPassState);			\
+      vHighPassState = sdlMulAddSse2(vHighPass,				\
+				     sdlSubSse2(vLowPassState,		\
+						vHighPassState),	\
+				     vHighPassState);			\
+      vFiltered = sdlSubSse2(vLowPassState, vHighPassState);		\
+      vSample = sdlMulAddSse2(vCrossGain,				\
+			      _mm_shuffle_ps(vFiltered, vFiltered,	\
+					     _MM_SHUFFLE(3, 2, 0, 1)),	\
+			      sdlMulSse2(vGain, vFiltered));		\
+      if (Saturate) {							\
+	vSample = sdlMinSse2(sdlMaxSse2(vSample, sdlSet1Sse2(-1.5f)),	\
+			     sdlSet1Sse2(1.5f));			\
+	vSample = sdlSubSse2(vSample,					\
+			     sdlMulSse2(sdlSet1Sse2((LADSPA_Data)(4.0 / 27)), \
+					sdlMulSse2(vSample,		\
+						   sdlMulSse2(vSample,	\
+							      vSample)))); \
+      }									\
+      vWrite = _mm_unpacklo_ps(_mm_load_ss(pfWriteLeft + lSampleIndex),	\
+			       _mm_load_ss(pfWriteRight + lSampleIndex)); \
+      vSample = sdlFlushDenormalsSse2(sdlAddSse2(vWrite, vSample));	\
+      _mm_store_ss(pfWriteLeft + lSampleIndex, vSample);		\
+      _mm_store_ss(pfWriteRight + lSampleIndex,				\
+		   _mm_shuffle_ps(vSample, vSample, 1));		\
+    }									\
+									\
+    _mm_store_ss(psFeedback->m_afLowPassState, vLowPassState);		\
+    _mm_store_ss(psFeedback->m_afLowPassState + 1,			\
+		 _mm_shuffle_ps(vLowPassState, vLowPassState, 1));	\
+    _mm_store_ss(psFeedback->m_afHighPassState, vHighPassState);	\
+    _mm_store_ss(psFeedback->m_afHighPassState + 1,			\
+		 _mm_shuffle_ps(vHighPassState, vHighPassState, 1));	\
+  }
+
+DEFINE_FEEDBACK_SPAN_SSE2(, 0)
+DEFINE_FEEDBACK_SPAN_SSE2(Saturating, 1)
+
+#define feedbackSpanAvx2             feedbackSpanSse2
+#define feedbackSaturatingSpanAvx2   feedbackSaturatingSpanSse2
+#define feedbackSpanAvx512           feedbackSpanSse2
+#define feedbackSaturatingSpanAvx512 feedbackSaturatingSpanSse2
+
+// -------------------------------------------------------------------
+
+// SSE2 version of mixInterleavedSpanGeneric(). Four frames are
+// unpacked from the two input vectors and written at once, then the
+// left and the right samples of four frames are gathered by a shuffle
+// of two consecutive loads each. Wider vectors would have to shuffle
+// across their lanes and gain little on a loop bound by memory.
+#define DEFINE_MIX_INTERLEAVED_SPAN_SSE2(Mode)				\
+  static __attribute__((target(SDL_TARGET_Sse2))) void			\
+  mixInterleavedSpanSse2##Mode(const LADSPA_Data* pfInputLeft,		\
+			       const LADSPA_Data* pfInputRight,		\
+			       LADSPA_Data* pfOutputLeft,		\
+			       LADSPA_Data* pfOutputRight,		\
+			       LADSPA_Data* pfWrite,			\
+			       const LADSPA_Data* pfReadLeft,		\
+			       const LADSPA_Data* pfReadRight,		\
+			       LADSPA_Data fWetLeft,			\
+			       LADSPA_Data fWetIncrementLeft,		\
+			       LADSPA_Data fWetRight,			\
+			       LADSPA_Data fWetIncrementRight,		\
+			       LADSPA_Data fGain,			\
+			       unsigned long lSampleCount) {		\
+									\
+    SdlVectorSse2 vCount;						\
+    SdlVectorSse2 vGain;						\
+    SdlVectorSse2 vInputLeft;						\
+    SdlVectorSse2 vInputRight;						\
+    SdlVectorSse2 vReadLeft;						\
+    SdlVectorSse2 vReadRight;						\
+    SdlVectorSse2 vWetLeft;						\
+    SdlVectorSse2 vWetIncrementLeft;					\
+    SdlVectorSse2 vWetRight;						\
+    SdlVectorSse2 vWetIncrementRight;					\
+    SdlVectorSse2 vWidth;						\
+    unsigned long lSampleIndex;						\
+									\
+    vCount = _mm_setr_ps(1, 2, 3, 4);					\
+    vWidth = sdlSet1Sse2(SDL_WIDTH_Sse2);				\
+    vGain = sdlSet1Sse2(fGain);						\
+    vWetLeft = sdlSet1Sse2(fWetLeft);					\
+    vWetIncrementLeft = sdlSet1Sse2(fWetIncrementLeft);			\
+    vWetRight = sdlSet1Sse2(fWetRight);					\
+    vWetIncrementRight = sdlSet1Sse2(fWetIncrementRight);		\
+									\
+    for (lSampleIndex = 0;						\
+	 lSampleIndex + SDL_WIDTH_Sse2 <= lSampleCount;			\
+	 lSampleIndex += SDL_WIDTH_Sse2) {				\
+      vInputLeft = sdlLoadSse2(pfInputLeft + lSampleIndex);		\
+      vInputRight = sdlLoadSse2(pfInputRight + lSampleIndex);		\
+      sdlStoreSse2(pfWrite + 2 * lSampleIndex,				\
+		   sdlFlushDenormalsSse2(_mm_unpacklo_ps(vInputLeft,	\
+							 vInputRight))); \
+      sdlStoreSse2(pfWrite + 2 * lSampleIndex + SDL_WIDTH_Sse2,	\
+		   sdlFlushDenormalsSse2(_mm_unpackhi_ps(vInputLeft,	\
+							 vInputRight))); \
+      vReadLeft								\
+	= _mm_shuffle_ps(sdlLoadSse2(pfReadLeft + 2 * lSampleIndex),	\
+			 sdlLoadSse2(pfReadLeft + 2 * lSampleIndex	\
+				     + SDL_WIDTH_Sse2),			\
+			 _MM_SHUFFLE(2, 0, 2, 0));			\
+      vReadRight							\
+	= _mm_shuffle_ps(sdlLoadSse2(pfReadRight + 2 * lSampleIndex),	\
+			 sdlLoadSse2(pfReadRight + 2 * lSampleIndex	\
+				     + SDL_WIDTH_Sse2),			\
+			 _MM_SHUFFLE(3, 1, 3, 1));			\
+      SDL_STORE_OUTPUT(Sse2, Mode, pfOutputLeft + lSampleIndex,		\
+		       vInputLeft,					\
+		       sdlMulSse2(vGain,				\
+				  sdlMulAddSse2(sdlMulAddSse2(vWetIncrementLeft, \
+							      vCount,	\
+							      vWetLeft), \
+						sdlSubSse2(vReadLeft,	\
+							   vInputLeft),	\
+						vInputLeft)));		\
+      SDL_STORE_OUTPUT(Sse2, Mode, pfOutputRight + lSampleIndex,	\
+		       vInputRight,					\
+		       sdlMulSse2(vGain,				\
+				  sdlMulAddSse2(sdlMulAddSse2(vWetIncrementRight, \
+							      vCount,	\
+							      vWetRight), \
+						sdlSubSse2(vReadRight,	\
+							   vInputRight), \
+						vInputRight)));		\
+      vCount = sdlAddSse2(vCount, vWidth);				\
+    }									\
+									\
+    mixInterleavedSpanGeneric##Mode(pfInputLeft + lSampleIndex,		\
+				    pfInputRight + lSampleIndex,	\
+				    pfOutputLeft + lSampleIndex,	\
+				    pfOutputRight + lSampleIndex,	\
+				    pfWrite + 2 * lSampleIndex,		\
+				    pfReadLeft + 2 * lSampleIndex,	\
+				    pfReadRight + 2 * lSampleIndex,	\
+				    fWetLeft				\
+				    + fWetIncrementLeft * lSampleIndex,	\
+				    fWetIncrementLeft,			\
+				    fWetRight				\
+				    + fWetIncrementRight * lSampleIndex, \
+				    fWetIncrementRight,			\
+				    fGain,				\
+				    lSampleCount - lSampleIndex);	\
+  }
+
+DEFINE_MIX_INTERLEAVED_SPAN_SSE2()
+DEFINE_MIX_INTERLEAVED_SPAN_SSE2(Adding)
+
+#define mixInterleavedSpanAvx2         mixInterleavedSpanSse2
+#define mixInterleavedSpanAvx2Adding   mixInterleavedSpanSse2Adding
+#define mixInterleavedSpanAvx512       mixInterleavedSpanSse2
+#define mixInterleavedSpanAvx512Adding mixInterleavedSpanSse2Adding
+
+#endif
+
+// -------------------------------------------------------------------
+
+// Signatures shared by all versions of the span kernels.
+typedef void (*MixAndCopySpanFunction)(const LADSPA_Data* pfInput,
+				       const LADSPA_Data* pfRead,
+				       LADSPA_Data* pfWrite,
+				       LADSPA_Data* pfOutput,
+				       LADSPA_Data fDry,
+				       LADSPA_Data fWet,
+				       unsigned long lSampleCount);
+typedef void (*MixSpanBackwardsFunction)(const LADSPA_Data* pfInput,
+					 const LADSPA_Data* pfDelayed,
+					 LADSPA_Data* pfOutput,
+					 LADSPA_Data fDry,
+					 LADSPA_Data fWet,
+					 unsigned long lSampleCount);
+typedef void (*CopySpanFunction)(const LADSPA_Data* pfSource,
+				 LADSPA_Data* pfOutput,
+				 LADSPA_Data fGain,
+				 unsigned long lSampleCount);
+typedef void (*SilenceSpanFunction)(const LADSPA_Data* pfInput,
+				    LADSPA_Data* pfOutput,
+				    unsigned long lSampleCount);
+typedef unsigned long
+(*CountTrailingSilenceFunction)(const LADSPA_Data* pfInput,
+				unsigned long lSampleCount);
+typedef void (*FlushSpanFunction)(const LADSPA_Data* pfSource,
+				  LADSPA_Data* pfDestination,
+				  unsigned long lSampleCount);
+typedef void (*MixRampSpanFunction)(const LADSPA_Data* pfInput,
+				    const LADSPA_Data* pfWet,
+				    LADSPA_Data* pfOutput,
+				    LADSPA_Data fWet,
+				    LADSPA_Data fWetIncrement,
+				    LADSPA_Data fGain,
+				    unsigned long lSampleCount);
+typedef void (*MixInterleavedSpanFunction)(const LADSPA_Data* pfInputLeft,
+					   const LADSPA_Data* pfInputRight,
+					   LADSPA_Data* pfOutputLeft,
+					   LADSPA_Data* pfOutputRight,
+					   LADSPA_Data* pfWrite,
+					   const LADSPA_Data* pfReadLeft,
+					   const LADSPA_Data* pfReadRight,
+					   LADSPA_Data fWetLeft,
+					   LADSPA_Data fWetIncrementLeft,
+					   LADSPA_Data fWetRight,
+					   LADSPA_Data fWetIncrementRight,
+					   LADSPA_Data fGain,
+					   unsigned long lSampleCount);
+typedef void (*AccumulateTapsSpanFunction)(const LADSPA_Data* const* ppfRead,
+					   const LADSPA_Data* pfGain,
+					   const LADSPA_Data* pfGainIncrement,
+					   unsigned long lTapCount,
+					   LADSPA_Data* pfAccumulator,
+					   unsigned long lSampleCount);
+typedef void (*MultiplyAddSpectraSpanFunction)(const LADSPA_Data* pfInput,
+					       const LADSPA_Data* pfFilter,
+					       LADSPA_Data* pfSum,
+					       unsigned long lBinCount);
+typedef void (*FdnSpanFunction)(const LADSPA_Data* pfInputLeft,
+				const LADSPA_Data* pfInputRight,
+				LADSPA_Data* pfOutputLeft,
+				LADSPA_Data* pfOutputRight,
+				FeedbackDelayNetwork* psNetwork,
+				unsigned long lSampleCount);
+typedef void (*ReverseSpanFunction)(const LADSPA_Data* pfReadFirst,
+				    const LADSPA_Data* pfReadSecond,
+				    LADSPA_Data* pfWet,
+				    LADSPA_Data fWindow,
+				    LADSPA_Data fWindowIncrement,
+				    unsigned long lSampleCount);
+typedef void (*PitchShiftSpanFunction)(const LADSPA_Data* pfBuffer,
+				       unsigned long lBufferSize,
+				       unsigned long lReadOffset,
+				       LADSPA_Data* pfWet,
+				       LADSPA_Data fPhase,
+				       LADSPA_Data fPhaseIncrement,
+				       LADSPA_Data fSweep,
+				       unsigned long lHeads,
+				       unsigned long lSampleCount);
+typedef void (*CombSpanFunction)(const LADSPA_Data* pfInputLeft,
+				 const LADSPA_Data* pfInputRight,
+				 LADSPA_Data* pfOutputLeft,
+				 LADSPA_Data* pfOutputRight,
+				 CombFilterBank* psBank,
+				 unsigned long lSampleCount);
+typedef void (*InterpolateSpanFunction)(const LADSPA_Data* pfRead,
+					const LADSPA_Data* pfInput,
+					LADSPA_Data* pfOutput,
+					Interpolator* psInterpolator,
+					LADSPA_Data fDry,
+					unsigned long lSampleCount);
+typedef void (*CrossfadeSpanFunction)(const LADSPA_Data* pfRead,
+				      const LADSPA_Data* pfNextRead,
+				      const LADSPA_Data* pfInput,
+				      LADSPA_Data* pfOutput,
+				      Interpolator* psInterpolator,
+				      Interpolator* psNextInterpolator,
+				      LADSPA_Data fAngle,
+				      LADSPA_Data fAngleIncrement,
+				      LADSPA_Data fDry,
+				      unsigned long lSampleCount);
+typedef void (*GlideSpanFunction)(const LADSPA_Data* pfBuffer,
+				  unsigned long lBufferSize,
+				  unsigned long lReadOffset,
+				  const LADSPA_Data* pfInput,
+				  LADSPA_Data* pfOutput,
+				  const Glide* psGlide,
+				  LADSPA_Data fDry,
+				  unsigned long lSampleCount);
+typedef void (*FeedbackSpanFunction)(const LADSPA_Data* pfReadLeft,
+				     const LADSPA_Data* pfReadRight,
+				     LADSPA_Data* pfWriteLeft,
+				     LADSPA_Data* pfWriteRight,
+				     Feedback* psFeedback,
+				     unsigned long lSampleCount);
+typedef void (*ModulateSpanFunction)(const LADSPA_Data* pfBuffer,
+				     unsigned long lBufferSize,
+				     unsigned long lReadOffset,
+				     const LADSPA_Data* pfInput,
+				     LADSPA_Data* pfOutput,
+				     const Glide* psGlide,
+				     const Modulation* psModulation,
+				     LADSPA_Data fDry,
+				     unsigned long lSampleCount);
+
+// The set of kernels one flavour of the run function is built from.
+typedef struct SimpleDelayKernelsStruct {
+  MixAndCopySpanFunction m_fnMixAndCopySpan;
+  MixSpanBackwardsFunction m_fnMixSpanBackwards;
+  MixAndCopySpanFunction m_fnMixAndCopyBlock;
+  MixAndCopySpanFunction m_fnMixAndCopySpanInPlace;
+  MixAndCopySpanFunction m_fnMixAndCopyBlockInPlace;
+  CopySpanFunction m_fnCopySpan;
+  SilenceSpanFunction m_fnSilenceSpan;
+  CountTrailingSilenceFunction m_fnCountTrailingSilence;
+  FlushSpanFunction m_fnFlushSpan;
+  // Indexed by the interpolation mode. Whole sample delays are read
+  // by the linear interpolator where necessary.
+  InterpolateSpanFunction m_afnInterpolateSpan[4];
+  CrossfadeSpanFunction m_afnCrossfadeSpan[4];
+  // The allpass cannot follow a moving delay, glides and modulated
+  // delays use linear interpolation instead. The modulation kernels
+  // are indexed by the source of the modulation first.
+  GlideSpanFunction m_afnGlideSpan[4];
+  ModulateSpanFunction m_aafnModulateSpan[SDL_MODULATION_SOURCES][4];
+  MixRampSpanFunction m_fnMixRampSpan;
+  // Both channels of the plain flavour in a ring buffer of frames.
+  MixInterleavedSpanFunction m_fnMixInterleavedSpan;
+  // Indexed by the saturation switch. The feedback works on both
+  // channels at once and does not depend on the mode.
+  FeedbackSpanFunction m_afnFeedbackSpan[2];
+  // The taps of the multi-tap delay line are summed up in a scratch
+  // buffer, so this one does not depend on the mode either.
+  AccumulateTapsSpanFunction m_fnAccumulateTapsSpan;
+  // The same goes for the spectra of the convolution.
+  MultiplyAddSpectraSpanFunction m_fnMultiplyAddSpectraSpan;
+  // And for the reverse and the pitch shifting flavours.
+  ReverseSpanFunction m_fnReverseSpan;
+  PitchShiftSpanFunction m_fnPitchShiftSpan;
+  // And for the reverbs, indexed by the line count: 8 or 16.
+  FdnSpanFunction m_afnFdnSpan[2];
+  // And for the comb filter banks, indexed by the comb count: 8, 16 or
+  // 32.
+  CombSpanFunction m_afnCombSpan[3];
+  // The kernels of the same instruction set which overwrite their
+  // output, for intermediate results.
+  const struct SimpleDelayKernelsStruct* m_psReplacingKernels;
+} SimpleDelayKernels;
+
+#define SIMPLE_DELAY_KERNELS(Isa, Mode)		\
+  {						\
+    mixAndCopySpan##Isa##Mode,			\
+    mixSpanBackwards##Isa##Mode,		\
+    mixAndCopyBlock##Isa##Mode,			\
+    mixAndCopySpan##Isa##Mode##InPlace,		\
+    mixAndCopyBlock##Isa##Mode##InPlace,	\
+    copySpan##Isa##Mode,			\
+    silenceSpanGeneric##Mode,			\
+    countTrailingSilence##Isa,			\
+    flushSpan##Isa,				\
+    {						\
+      interpolateLinearSpan##Isa##Mode,		\
+      interpolateLinearSpan##Isa##Mode,		\
+      interpolateCubicSpan##Isa##Mode,		\
+      interpolateAllpassSpan##Isa##Mode		\
+    },						\
+    {						\
+      crossfadeLinearSpan##Isa##Mode,		\
+      crossfadeLinearSpan##Isa##Mode,		\
+      crossfadeCubicSpan##Isa##Mode,		\
+      crossfadeAllpassSpan##Isa##Mode		\
+    },						\
+    {						\
+      glideLinearSpan##Isa##Mode,		\
+      glideLinearSpan##Isa##Mode,		\
+      glideCubicSpan##Isa##Mode,		\
+      glideLinearSpan##Isa##Mode		\
+    },						\
+    {						\
+      {						\
+	modulateLinearSpan##Isa##Mode,		\
+	modulateLinearSpan##Isa##Mode,		\
+	modulateCubicSpan##Isa##Mode,		\
+	modulateLinearSpan##Isa##Mode		\
+      },					\
+      {						\
+	lfoSineLinearSpan##Isa##Mode,		\
+	lfoSineLinearSpan##Isa##Mode,		\
+	lfoSineCubicSpan##Isa##Mode,		\
+	lfoSineLinearSpan##Isa##Mode		\
+      },					\
+      {						\
+	lfoTriangleLinearSpan##Isa##Mode,	\
+	lfoTriangleLinearSpan##Isa##Mode,	\
+	lfoTriangleCubicSpan##Isa##Mode,	\
+	lfoTriangleLinearSpan##Isa##Mode	\
+      }						\
+    },						\
+    mixRampSpan##Isa##Mode,			\
+    mixInterleavedSpan##Isa##Mode,		\
+    {						\
+      feedbackSpan##Isa,			\
+      feedbackSaturatingSpan##Isa		\
+    },						\
+    accumulateTapsSpan##Isa,			\
+    multiplyAddSpectraSpan##Isa,		\
+    reverseSpan##Isa,				\
+    pitchShiftSpan##Isa,			\
+    {						\
+      fdn8Span##Isa,				\
+      fdn16Span##Isa				\
+    },						\
+    {						\
+      comb8Span##Isa,				\
+      comb16Span##Isa,				\
+      comb32Span##Isa				\
+    },						\
+    &g_s##Isa##Kernels				\
+  }
+
+static const SimpleDelayKernels g_sGenericKernels
+  = SIMPLE_DELAY_KERNELS(Generic, );
+static const SimpleDelayKernels g_sGenericAddingKernels
+  = SIMPLE_DELAY_KERNELS(Generic, Adding);
+#ifdef SDL_X86_SIMD
+static const SimpleDelayKernels g_sSse2Kernels
+  = SIMPLE_DELAY_KERNELS(Sse2, );
+static const SimpleDelayKernels g_sSse2AddingKernels
+  = SIMPLE_DELAY_KERNELS(Sse2, Adding);
+static const SimpleDelayKernels g_sAvx2Kernels
+  = SIMPLE_DELAY_KERNELS(Avx2, );
+static const SimpleDelayKernels g_sAvx2AddingKernels
+  = SIMPLE_DELAY_KERNELS(Avx2, Adding);
+static const SimpleDelayKernels g_sAvx512Kernels
+  = SIMPLE_DELAY_KERNELS(Avx512, );
+static const SimpleDelayKernels g_sAvx512AddingKernels
+  = SIMPLE_DELAY_KERNELS(Avx512, Adding);
+#endif
+
+// -------------------------------------------------------------------
+
+// Copy SampleCount samples into the ring buffer starting at
+// lWriteOffset using the flushing copy kernel fnFlushSpan. The copy is
+// split at the end of the buffer.
+static void copyToRingBuffer(const LADSPA_Data* pfInput,
+			     LADSPA_Data* pfBuffer,
+			     unsigned long lBufferSize,
+			     unsigned long lWriteOffset,
+			     unsigned long SampleCount,
+			     FlushSpanFunction fnFlushSpan) {
+
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lWriteOffset)
+      lSpan = lBufferSize - lWriteOffset;
+    fnFlushSpan(pfInput + lSampleIndex,
+		pfBuffer + lWriteOffset,
+		lSpan);
+    lWriteOffset = (lWriteOffset + lSpan) & (lBufferSize - 1);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Zero SampleCount samples of the ring buffer starting at lOffset.
+// The region is split at the end of the buffer.
+static void zeroRingBuffer(LADSPA_Data* pfBuffer,
+			   unsigned long lBufferSize,
+			   unsigned long lOffset,
+			   unsigned long SampleCount) {
+
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lOffset)
+      lSpan = lBufferSize - lOffset;
+    memset(pfBuffer + lOffset, 0, sizeof(LADSPA_Data) * lSpan);
+    lOffset = (lOffset + lSpan) & (lBufferSize - 1);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Copy SampleCount samples out of the ring buffer starting at
+// lReadOffset using the copy kernel fnCopySpan. The copy is split at
+// the end of the buffer.
+static void copyFromRingBuffer(const LADSPA_Data* pfBuffer,
+			       LADSPA_Data* pfOutput,
+			       unsigned long lBufferSize,
+			       unsigned long lReadOffset,
+			       unsigned long SampleCount,
+			       CopySpanFunction fnCopySpan,
+			       LADSPA_Data fGain) {
+
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lReadOffset)
+      lSpan = lBufferSize - lReadOffset;
+    fnCopySpan(pfBuffer + lReadOffset,
+	       pfOutput + lSampleIndex,
+	       fGain,
+	       lSpan);
+    lReadOffset = (lReadOffset + lSpan) & (lBufferSize - 1);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Find the lTaps taps of the sample read at lReadOffset, which is
+// the position of its newest tap, in the ring buffer. *ppfRead is
+// pointed at the newest tap. The return value is the number of
+// samples (up to SampleCount) whose taps can be read from there
+// without wrapping around the end of the buffer. Taps straddling the
+// end are copied to afWindow, leaving a single sample to read.
+static unsigned long locateTaps(const LADSPA_Data* pfBuffer,
+				unsigned long lBufferSize,
+				unsigned long lReadOffset,
+				unsigned long lTaps,
+				unsigned long SampleCount,
+				LADSPA_Data* afWindow,
+				const LADSPA_Data** ppfRead) {
+
+  unsigned long lOldestTap;
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  lOldestTap = (lReadOffset + lBufferSize - (lTaps - 1)) & (lBufferSize - 1);
+  if (lOldestTap + lTaps > lBufferSize) {
+    for (lTap = 0; lTap < lTaps; lTap++)
+      afWindow[lTap] = pfBuffer[(lOldestTap + lTap) & (lBufferSize - 1)];
+    *ppfRead = afWindow + lTaps - 1;
+    return 1;
+  }
+
+  // -----------------------------------------------------------------
+
+  *ppfRead = pfBuffer + lOldestTap + lTaps - 1;
+  if (SampleCount > lBufferSize - (lOldestTap + lTaps - 1))
+    return lBufferSize - (lOldestTap + lTaps - 1);
+  return SampleCount;
+}
+
+// -------------------------------------------------------------------
+
+// Mix SampleCount samples of the input with the output of an
+// interpolator reading the ring buffer using the interpolation kernel
+// fnInterpolateSpan. The newest tap of the first sample is found at
+// lReadOffset. The block is split wherever the taps wrap around the
+// end of the buffer.
+static void interpolateFromRingBuffer(const LADSPA_Data* pfBuffer,
+				      const LADSPA_Data* pfInput,
+				      LADSPA_Data* pfOutput,
+				      unsigned long lBufferSize,
+				      unsigned long lReadOffset,
+				      unsigned long SampleCount,
+				      InterpolateSpanFunction fnInterpolateSpan,
+				      Interpolator* psInterpolator,
+				      LADSPA_Data fDry) {
+
+  LADSPA_Data afWindow[SDL_INTERPOLATION_TAPS];
+  const LADSPA_Data* pfRead;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = locateTaps(pfBuffer, lBufferSize,
+		       (lReadOffset + lSampleIndex) & (lBufferSize - 1),
+		       psInterpolator->m_lTaps, SampleCount - lSampleIndex,
+		       afWindow, &pfRead);
+    fnInterpolateSpan(pfRead,
+		      pfInput + lSampleIndex,
+		      pfOutput + lSampleIndex,
+		      psInterpolator,
+		      fDry,
+		      lSpan);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Same as above with two read heads crossfaded by fnCrossfadeSpan.
+// The crossfade is at fAngle at the first sample and advances by
+// fAngleIncrement per sample.
+static void crossfadeFromRingBuffer(const LADSPA_Data* pfBuffer,
+				    const LADSPA_Data* pfInput,
+				    LADSPA_Data* pfOutput,
+				    unsigned long lBufferSize,
+				    unsigned long lReadOffset,
+				    unsigned long lNextReadOffset,
+				    unsigned long SampleCount,
+				    CrossfadeSpanFunction fnCrossfadeSpan,
+				    Interpolator* psInterpolator,
+				    Interpolator* psNextInterpolator,
+				    LADSPA_Data fAngle,
+				    LADSPA_Data fAngleIncrement,
+				    LADSPA_Data fDry) {
+
+  LADSPA_Data afWindow[SDL_INTERPOLATION_TAPS];
+  LADSPA_Data afNextWindow[SDL_INTERPOLATION_TAPS];
+  const LADSPA_Data* pfNextRead;
+  const LADSPA_Data* pfRead;
+  unsigned long lNextSpan;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = locateTaps(pfBuffer, lBufferSize,
+		       (lReadOffset + lSampleIndex) & (lBufferSize - 1),
+		       psInterpolator->m_lTaps, SampleCount - lSampleIndex,
+		       afWindow, &pfRead);
+    lNextSpan = locateTaps(pfBuffer, lBufferSize,
+			   ((lNextReadOffset + lSampleIndex)
+			    & (lBufferSize - 1)),
+			   psNextInterpolator->m_lTaps,
+			   SampleCount - lSampleIndex,
+			   afNextWindow, &pfNextRead);
+    if (lSpan > lNextSpan)
+      lSpan = lNextSpan;
+    fnCrossfadeSpan(pfRead,
+		    pfNextRead,
+		    pfInput + lSampleIndex,
+		    pfOutput + lSampleIndex,
+		    psInterpolator,
+		    psNextInterpolator,
+		    fAngle + lSampleIndex * fAngleIncrement,
+		    fAngleIncrement,
+		    fDry,
+		    lSpan);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Update the number of consecutive silent input samples of a channel,
+// up to lMaxDelay, after a block of SampleCount samples ending in
+// lTrailingSilence silent ones.
+static void countSilentSamples(unsigned long* plSilentSamples,
+			       unsigned long lTrailingSilence,
+			       unsigned long lMaxDelay,
+			       unsigned long SampleCount) {
+  if (lTrailingSilence == SampleCount)
+    *plSilentSamples += SampleCount;
+  else
+    *plSilentSamples = lTrailingSilence;
+  if (*plSilentSamples > lMaxDelay)
+    *plSilentSamples = lMaxDelay;
+}
+
+// -------------------------------------------------------------------
+
+// Keep track of the digital silence at the input of a channel. Once
+// the input has been silent for at least lMaxDelay samples, every
+// read from the ring buffer yields zero. As long as the input stays
+// silent, the output is silenced without reading the ring buffer and
+// the ring buffer is not written either. The skipped part of the ring
+// buffer is zeroed lazily as soon as the channel wakes up again.
+//
+// Returns 1 if the block has been handled entirely and 0 if it still
+// has to be processed.
+static int runIdleSimpleDelayChannel(const LADSPA_Data* pfInput,
+				     LADSPA_Data* pfOutput,
+				     LADSPA_Data* pfBuffer,
+				     unsigned long lBufferSize,
+				     unsigned long lWriteOffset,
+				     unsigned long lMaxDelay,
+				     unsigned long* plSilentSamples,
+				     unsigned long* plUnwrittenSamples,
+				     unsigned long SampleCount,
+				     const SimpleDelayKernels* psKernels) {
+
+  unsigned long lTrailingSilence;
+
+  // -----------------------------------------------------------------
+
+  lTrailingSilence
+    = psKernels->m_fnCountTrailingSilence(pfInput, SampleCount);
+
+  // -----------------------------------------------------------------
+
+  if (lTrailingSilence == SampleCount && *plSilentSamples >= lMaxDelay) {
+    psKernels->m_fnSilenceSpan(pfInput, pfOutput, SampleCount);
+    *plUnwrittenSamples += SampleCount;
+    if (*plUnwrittenSamples > lMaxDelay)
+      *plUnwrittenSamples = lMaxDelay;
+    return 1;
+  }
+
+  // -----------------------------------------------------------------
+
+  // Only the last lMaxDelay samples can ever be read again.
+  if (*plUnwrittenSamples > 0) {
+    zeroRingBuffer(pfBuffer, lBufferSize,
+		   (lWriteOffset + lBufferSize - *plUnwrittenSamples)
+		   & (lBufferSize - 1),
+		   *plUnwrittenSamples);
+    *plUnwrittenSamples = 0;
+  }
+
+  // -----------------------------------------------------------------
+
+  countSilentSamples(plSilentSamples, lTrailingSilence, lMaxDelay,
+		     SampleCount);
+  return 0;
+}
+
+// -------------------------------------------------------------------
+
+// Run one channel of the delay line for a block of SampleCount
+// samples. The block is split up front at the points where the read
+// or the write region wraps around the end of the ring buffer. This
+// results in at most three contiguous spans (for blocks shorter than
+// the buffer), each of which is handled without any index masking.
+//
+// Degenerate settings are detected once per block and handled by
+// plain copies instead: With a delay of zero or an entirely dry mix
+// the output is just the input and with an entirely wet mix it is
+// just the content of the ring buffer.
+//
+// Delays shorter than the block read all but their first lDelay
+// samples straight from the input instead of taking the round trip
+// through the ring buffer.
+//
+// The whole mix is scaled by fGain, which is always one unless the
+// kernels accumulate onto the output.
+static void runSimpleDelayChannel(const LADSPA_Data* pfInput,
+				  LADSPA_Data* pfOutput,
+				  LADSPA_Data* pfBuffer,
+				  unsigned long lBufferSize,
+				  unsigned long lWriteOffset,
+				  unsigned long lDelay,
+				  LADSPA_Data fWet,
+				  LADSPA_Data fGain,
+				  unsigned long SampleCount,
+				  const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data fDry;
+  MixAndCopySpanFunction fnMixAndCopyBlock;
+  MixAndCopySpanFunction fnMixAndCopySpan;
+
+  unsigned long lBufferSizeMinusOne;
+  unsigned long lReadOffset;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+
+  // -----------------------------------------------------------------
+
+  lBufferSizeMinusOne = lBufferSize - 1;
+  lReadOffset = (lWriteOffset + lBufferSize - lDelay) & lBufferSizeMinusOne;
+
+  // -----------------------------------------------------------------
+
+  if (lDelay == 0 || fWet == 0) {
+    // The ring buffer has to be written first since input and output
+    // might share the same memory.
+    copyToRingBuffer(pfInput, pfBuffer, lBufferSize, lWriteOffset,
+		     SampleCount, psKernels->m_fnFlushSpan);
+    psKernels->m_fnCopySpan(pfInput, pfOutput, fGain, SampleCount);
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  // As long as the write region does not reach the part of the read
+  // region preceding it, writing the whole block before reading it
+  // back yields the same result as the per-sample loop. This holds
+  // for delays shorter than the block too.
+  if (fWet == 1 && SampleCount <= lBufferSize - lDelay) {
+    copyToRingBuffer(pfInput, pfBuffer, lBufferSize, lWriteOffset,
+		     SampleCount, psKernels->m_fnFlushSpan);
+    copyFromRingBuffer(pfBuffer, pfOutput, lBufferSize, lReadOffset,
+		       SampleCount, psKernels->m_fnCopySpan, fGain);
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  fDry = (1 - fWet) * fGain;
+  fWet = fWet * fGain;
+
+  // -----------------------------------------------------------------
+
+  if (lDelay < SampleCount && SampleCount <= lBufferSize - lDelay) {
+    // The block is stored with one sequential write first. It does
+    // not reach the lDelay samples preceding it, which are the only
+    // ones read from the ring buffer.
+    copyToRingBuffer(pfInput, pfBuffer, lBufferSize, lWriteOffset,
+		     SampleCount, psKernels->m_fnFlushSpan);
+
+    // ---------------------------------------------------------------
+
+    // The tail has to be mixed before the head since it reads the
+    // head of the input which might get overwritten by the output.
+    psKernels->m_fnMixSpanBackwards(pfInput + lDelay,
+				    pfInput,
+				    pfOutput + lDelay,
+				    fDry,
+				    fWet,
+				    SampleCount - lDelay);
+
+    // ---------------------------------------------------------------
+
+    for (lSampleIndex = 0; lSampleIndex < lDelay; lSampleIndex += lSpan) {
+      lSpan = lDelay - lSampleIndex;
+      if (lSpan > lBufferSize - lReadOffset)
+	lSpan = lBufferSize - lReadOffset;
+      psKernels->m_fnMixSpanBackwards(pfInput + lSampleIndex,
+				      pfBuffer + lReadOffset,
+				      pfOutput + lSampleIndex,
+				      fDry,
+				      fWet,
+				      lSpan);
+      lReadOffset = (lReadOffset + lSpan) & lBufferSizeMinusOne;
+    }
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  // Hosts may connect input and output of a channel to the very same
+  // buffer (but never let them overlap partially).
+  if (pfOutput == pfInput) {
+    fnMixAndCopySpan = psKernels->m_fnMixAndCopySpanInPlace;
+    fnMixAndCopyBlock = psKernels->m_fnMixAndCopyBlockInPlace;
+  } else {
+    fnMixAndCopySpan = psKernels->m_fnMixAndCopySpan;
+    fnMixAndCopyBlock = psKernels->m_fnMixAndCopyBlock;
+  }
+
+  // -----------------------------------------------------------------
+
+  if (lDelay >= SampleCount
+      && SampleCount <= lBufferSize - lReadOffset
+      && SampleCount <= lBufferSize - lWriteOffset) {
+    fnMixAndCopyBlock(pfInput,
+		      pfBuffer + lReadOffset,
+		      pfBuffer + lWriteOffset,
+		      pfOutput,
+		      fDry,
+		      fWet,
+		      SampleCount);
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lReadOffset)
+      lSpan = lBufferSize - lReadOffset;
+    if (lSpan > lBufferSize - lWriteOffset)
+      lSpan = lBufferSize - lWriteOffset;
+
+    // ---------------------------------------------------------------
+
+    fnMixAndCopySpan(pfInput + lSampleIndex,
+		     pfBuffer + lReadOffset,
+		     pfBuffer + lWriteOffset,
+		     pfOutput + lSampleIndex,
+		     fDry,
+		     fWet,
+		     lSpan);
+
+    // ---------------------------------------------------------------
+
+    lReadOffset = (lReadOffset + lSpan) & lBufferSizeMinusOne;
+    lWriteOffset = (lWriteOffset + lSpan) & lBufferSizeMinusOne;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Set up psInterpolator to read a delay of fDelay samples using the
+// interpolator picked by iInterpolation, scaled by fWet. Returns the
+// delay of the newest tap. The interpolators are:
+//
+// Linear interpolation between the two samples around the delay.
+// Whole sample delays use it as well, with a fraction of zero.
+//
+// Third order Lagrange interpolation through four samples, chosen so
+// that the delay falls between the middle two of them.
+//
+// A first order allpass whose phase delay at low frequencies matches
+// the fractional part, kept between 0.5 and 1.5 samples where it
+// works best. It has a flat magnitude response but, being recursive,
+// has to carry fAllpassState over from block to block.
+static unsigned long setupInterpolator(LADSPA_Data fDelay,
+				       int iInterpolation,
+				       LADSPA_Data fWet,
+				       LADSPA_Data fAllpassState,
+				       Interpolator* psInterpolator) {
+
+  LADSPA_Data fFraction;
+  unsigned long lDelay;
+  unsigned long lNewestTap;
+
+  // -----------------------------------------------------------------
+
+  lDelay = (unsigned long)fDelay;
+  fFraction = fDelay - (LADSPA_Data)lDelay;
+  psInterpolator->m_fState = fAllpassState;
+
+  // -----------------------------------------------------------------
+
+  switch (iInterpolation) {
+  case SDL_INTERPOLATION_NONE:
+  case SDL_INTERPOLATION_LINEAR:
+    if (iInterpolation == SDL_INTERPOLATION_NONE)
+      fFraction = 0;
+    lNewestTap = lDelay;
+    psInterpolator->m_lTaps = 2;
+    psInterpolator->m_afCoefficients[0] = (1 - fFraction) * fWet;
+    psInterpolator->m_afCoefficients[1] = fFraction * fWet;
+    break;
+  case SDL_INTERPOLATION_CUBIC:
+    lNewestTap = lDelay > 0 ? lDelay - 1 : 0;
+    fFraction = fDelay - (LADSPA_Data)lNewestTap;
+    psInterpolator->m_lTaps = 4;
+    psInterpolator->m_afCoefficients[0]
+      = -(fFraction - 1) * (fFraction - 2) * (fFraction - 3) / 6 * fWet;
+    psInterpolator->m_afCoefficients[1]
+      = fFraction * (fFraction - 2) * (fFraction - 3) / 2 * fWet;
+    psInterpolator->m_afCoefficients[2]
+      = -fFraction * (fFraction - 1) * (fFraction - 3) / 2 * fWet;
+    psInterpolator->m_afCoefficients[3]
+      = fFraction * (fFraction - 1) * (fFraction - 2) / 6 * fWet;
+    break;
+  default:
+    if (fFraction < 0.5 && lDelay > 0)
+      lNewestTap = lDelay - 1;
+    else
+      lNewestTap = lDelay;
+    fFraction = fDelay - (LADSPA_Data)lNewestTap;
+    psInterpolator->m_lTaps = 2;
+    psInterpolator->m_afCoefficients[0] = (1 - fFraction) / (1 + fFraction);
+    psInterpolator->m_afCoefficients[1] = fWet;
+    break;
+  }
+  return lNewestTap;
+}
+
+// -------------------------------------------------------------------
+
+// Delay reached lPosition samples into a glide from fDelay towards
+// fTarget at fRate samples per sample. Computed in double precision
+// so that long delays keep their fractional part.
+static double getGlideDelay(LADSPA_Data fDelay,
+			    LADSPA_Data fTarget,
+			    LADSPA_Data fRate,
+			    unsigned long lPosition) {
+
+  double dLimit;
+
+  // -----------------------------------------------------------------
+
+  dLimit = (double)fRate * lPosition;
+  if ((double)fTarget - fDelay > dLimit)
+    return fDelay + dLimit;
+  if ((double)fTarget - fDelay < -dLimit)
+    return fDelay - dLimit;
+  return fTarget;
+}
+
+// Set up psGlide for the span starting lPosition samples into a glide
+// from fDelay towards fTarget at fRate samples per sample. Returns the
+// whole sample part of the delay at the start of the span.
+static unsigned long setupGlide(LADSPA_Data fDelay,
+				LADSPA_Data fTarget,
+				LADSPA_Data fRate,
+				unsigned long lPosition,
+				LADSPA_Data fWet,
+				Glide* psGlide) {
+
+  double dDelay;
+  unsigned long lDelay;
+
+  // -----------------------------------------------------------------
+
+  dDelay = getGlideDelay(fDelay, fTarget, fRate, lPosition);
+  lDelay = (unsigned long)dDelay;
+  psGlide->m_fFraction = (LADSPA_Data)(dDelay - lDelay);
+  psGlide->m_fDistance = (LADSPA_Data)(fTarget - dDelay);
+  psGlide->m_fRate = fRate;
+  psGlide->m_fMinimum = -(LADSPA_Data)lDelay;
+  psGlide->m_fWet = fWet;
+  return lDelay;
+}
+
+// -------------------------------------------------------------------
+
+// Follow a change of the delay of a channel to fDelay samples at the
+// start of a block, either by starting a crossfade of lCrossfadeLength
+// samples, a glide at fGlideRate samples per sample or by moving the
+// read head right away. Returns the number of samples until the glide
+// arrives, which may be well beyond the end of the block, or zero if
+// there is none.
+static unsigned long followDelayChange(ReadHeads* psReadHeads,
+				       LADSPA_Data fDelay,
+				       unsigned long lCrossfadeLength,
+				       LADSPA_Data fGlideRate) {
+  if (psReadHeads->m_lFadeLength > 0)
+    return 0;
+  if (lCrossfadeLength > 0
+      && psReadHeads->m_sHead.m_fDelay >= 0
+      && psReadHeads->m_sHead.m_fDelay != fDelay) {
+    psReadHeads->m_sNextHead.m_fDelay = fDelay;
+    psReadHeads->m_sNextHead.m_fAllpassState = 0;
+    psReadHeads->m_lFadePosition = 0;
+    psReadHeads->m_lFadeLength = lCrossfadeLength;
+    return 0;
+  }
+  if (fGlideRate > 0
+      && psReadHeads->m_sHead.m_fDelay >= 0
+      && psReadHeads->m_sHead.m_fDelay != fDelay)
+    return (unsigned long)ceil(fabs((double)fDelay
+				    - psReadHeads->m_sHead.m_fDelay)
+			       / fGlideRate);
+  psReadHeads->m_sHead.m_fDelay = fDelay;
+  return 0;
+}
+
+// -------------------------------------------------------------------
+
+// Run one channel of the fractional delay line for a block of
+// SampleCount samples with a delay of fDelay samples, which need not
+// be a whole number.
+//
+// If lCrossfadeLength is not zero, a change of the delay starts an
+// equal-power crossfade of that many samples from the current read
+// head to a new one. Changes during a crossfade are picked up once it
+// is complete. Otherwise, if fGlideRate is not zero, the read head
+// glides towards the new delay, changing it by at most fGlideRate
+// samples per sample like the tape speed of a tape delay.
+//
+// The block is processed in chunks of up to SDL_CHUNK_SIZE samples,
+// each of which is stored in the ring buffer before it is read back.
+// This way delays shorter than a chunk need no special treatment.
+// Outside of crossfades, whole sample delays are left to
+// runSimpleDelayChannel() unless the allpass, whose state has to keep
+// running, is selected.
+static void runFractionalDelayChannel(const LADSPA_Data* pfInput,
+				      LADSPA_Data* pfOutput,
+				      LADSPA_Data* pfBuffer,
+				      unsigned long lBufferSize,
+				      unsigned long lWriteOffset,
+				      LADSPA_Data fDelay,
+				      int iInterpolation,
+				      unsigned long lCrossfadeLength,
+				      LADSPA_Data fGlideRate,
+				      LADSPA_Data fWet,
+				      LADSPA_Data fGain,
+				      ReadHeads* psReadHeads,
+				      unsigned long SampleCount,
+				      const SimpleDelayKernels* psKernels) {
+
+  Glide sGlide;
+  Interpolator sInterpolator;
+  Interpolator sNextInterpolator;
+  LADSPA_Data fAngleIncrement;
+  LADSPA_Data fDry;
+  LADSPA_Data fGlideStart;
+  unsigned long lChunk;
+  unsigned long lFade;
+  unsigned long lGlide;
+  unsigned long lGlideLength;
+  unsigned long lGlidePosition;
+  unsigned long lGlideDelay;
+  unsigned long lNewestTap;
+  unsigned long lNextNewestTap;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  fGlideStart = psReadHeads->m_sHead.m_fDelay;
+  lGlideLength = followDelayChange(psReadHeads, fDelay, lCrossfadeLength,
+				   fGlideRate);
+
+  // -----------------------------------------------------------------
+
+  if (psReadHeads->m_lFadeLength == 0
+      && lGlideLength == 0
+      && (iInterpolation == SDL_INTERPOLATION_NONE
+	  || fDelay == 0
+	  || fWet == 0
+	  || (fDelay == (LADSPA_Data)(unsigned long)fDelay
+	      && iInterpolation != SDL_INTERPOLATION_ALLPASS))) {
+    if (fDelay == 0 || fWet == 0)
+      psReadHeads->m_sHead.m_fAllpassState = 0;
+    runSimpleDelayChannel(pfInput, pfOutput, pfBuffer, lBufferSize,
+			  lWriteOffset, (unsigned long)fDelay, fWet, fGain,
+			  SampleCount, psKernels);
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  fDry = (1 - fWet) * fGain;
+  fWet = fWet * fGain;
+
+  // -----------------------------------------------------------------
+
+  // At a delay of zero the allpass coefficient is one and the filter
+  // only passes its input through unchanged if its state holds the
+  // previous input sample. This comes up when crossfading from or to
+  // a delay of zero.
+  if (psReadHeads->m_sHead.m_fDelay == 0)
+    psReadHeads->m_sHead.m_fAllpassState
+      = pfBuffer[(lWriteOffset + lBufferSize - 1) & (lBufferSize - 1)];
+  if (psReadHeads->m_sNextHead.m_fDelay == 0)
+    psReadHeads->m_sNextHead.m_fAllpassState
+      = pfBuffer[(lWriteOffset + lBufferSize - 1) & (lBufferSize - 1)];
+
+  // -----------------------------------------------------------------
+
+  // During a glide the interpolator is only used once the glide has
+  // arrived.
+  lNewestTap = setupInterpolator(lGlideLength > 0
+				 ? fDelay
+				 : psReadHeads->m_sHead.m_fDelay,
+				 iInterpolation,
+				 fWet,
+				 psReadHeads->m_sHead.m_fAllpassState,
+				 &sInterpolator);
+  lNextNewestTap = setupInterpolator(psReadHeads->m_sNextHead.m_fDelay,
+				     iInterpolation,
+				     fWet,
+				     psReadHeads->m_sNextHead.m_fAllpassState,
+				     &sNextInterpolator);
+  lGlidePosition = 0;
+  fAngleIncrement = 0;
+  if (psReadHeads->m_lFadeLength > 0)
+    fAngleIncrement = (LADSPA_Data)(M_PI / 2) / psReadHeads->m_lFadeLength;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+    lChunk = SampleCount - lSampleIndex;
+    if (lChunk > SDL_CHUNK_SIZE)
+      lChunk = SDL_CHUNK_SIZE;
+
+    // ---------------------------------------------------------------
+
+    copyToRingBuffer(pfInput + lSampleIndex, pfBuffer, lBufferSize,
+		     (lWriteOffset + lSampleIndex) & (lBufferSize - 1),
+		     lChunk, psKernels->m_fnFlushSpan);
+
+    // ---------------------------------------------------------------
+
+    lFade = 0;
+    if (psReadHeads->m_lFadeLength > 0) {
+      lFade = psReadHeads->m_lFadeLength - psReadHeads->m_lFadePosition;
+      if (lFade > lChunk)
+	lFade = lChunk;
+      crossfadeFromRingBuffer(pfBuffer,
+			      pfInput + lSampleIndex,
+			      pfOutput + lSampleIndex,
+			      lBufferSize,
+			      ((lWriteOffset + lSampleIndex
+				+ lBufferSize - lNewestTap)
+			       & (lBufferSize - 1)),
+			      ((lWriteOffset + lSampleIndex
+				+ lBufferSize - lNextNewestTap)
+			       & (lBufferSize - 1)),
+			      lFade,
+			      psKernels->m_afnCrossfadeSpan[iInterpolation],
+			      &sInterpolator,
+			      &sNextInterpolator,
+			      psReadHeads->m_lFadePosition * fAngleIncrement,
+			      fAngleIncrement,
+			      fDry);
+      psReadHeads->m_lFadePosition += lFade;
+
+      // -------------------------------------------------------------
+
+      // The next head takes over.
+      if (psReadHeads->m_lFadePosition == psReadHeads->m_lFadeLength) {
+	psReadHeads->m_sHead = psReadHeads->m_sNextHead;
+	psReadHeads->m_lFadeLength = 0;
+	sInterpolator = sNextInterpolator;
+	lNewestTap = lNextNewestTap;
+      }
+    }
+
+    // ---------------------------------------------------------------
+
+    // A glide never overlaps with a crossfade.
+    lGlide = 0;
+    if (lGlidePosition < lGlideLength) {
+      lGlide = lGlideLength - lGlidePosition;
+      if (lGlide > lChunk)
+	lGlide = lChunk;
+      lGlideDelay = setupGlide(fGlideStart, fDelay, fGlideRate,
+			       lGlidePosition, fWet, &sGlide);
+      psKernels->m_afnGlideSpan[iInterpolation](pfBuffer,
+						lBufferSize,
+						((lWriteOffset + lSampleIndex
+						  + lBufferSize - lGlideDelay)
+						 & (lBufferSize - 1)),
+						pfInput + lSampleIndex,
+						pfOutput + lSampleIndex,
+						&sGlide,
+						fDry,
+						lGlide);
+      lGlidePosition += lGlide;
+
+      // -------------------------------------------------------------
+
+      // Once the glide arrives, the allpass carries on from its last
+      // output sample.
+      if (lGlidePosition == lGlideLength
+	  && iInterpolation == SDL_INTERPOLATION_ALLPASS)
+	sInterpolator.m_fState
+	  = readLinearSample(pfBuffer,
+			     lBufferSize,
+			     ((lWriteOffset + lSampleIndex
+			       + lBufferSize - lGlideDelay)
+			      & (lBufferSize - 1)),
+			     getGlideOffset(&sGlide, lGlide - 1),
+			     sGlide.m_fMinimum,
+			     lGlide - 1);
+    }
+
+    // ---------------------------------------------------------------
+
+    interpolateFromRingBuffer(pfBuffer,
+			      pfInput + lSampleIndex + lFade + lGlide,
+			      pfOutput + lSampleIndex + lFade + lGlide,
+			      lBufferSize,
+			      ((lWriteOffset + lSampleIndex + lFade + lGlide
+				+ lBufferSize - lNewestTap)
+			       & (lBufferSize - 1)),
+			      lChunk - lFade - lGlide,
+			      psKernels->m_afnInterpolateSpan[iInterpolation],
+			      &sInterpolator,
+			      fDry);
+  }
+
+  // -----------------------------------------------------------------
+
+  psReadHeads->m_sHead.m_fAllpassState = sInterpolator.m_fState;
+  psReadHeads->m_sNextHead.m_fAllpassState = sNextInterpolator.m_fState;
+  if (lGlideLength > SampleCount)
+    psReadHeads->m_sHead.m_fDelay
+      = (LADSPA_Data)getGlideDelay(fGlideStart, fDelay, fGlideRate,
+				   SampleCount);
+  else if (lGlideLength > 0)
+    psReadHeads->m_sHead.m_fDelay = fDelay;
+}
+
+// -------------------------------------------------------------------
+
+// Set psModulation to the modulation psStart reaches lSampleCount
+// samples on. The phase of the LFO is kept between 0 and 1.
+static void offsetModulation(const Modulation* psStart,
+			     unsigned long lSampleCount,
+			     Modulation* psModulation) {
+
+  double dPhase;
+
+  // -----------------------------------------------------------------
+
+  *psModulation = *psStart;
+  if (psStart->m_pfModulation != NULL)
+    psModulation->m_pfModulation = psStart->m_pfModulation + lSampleCount;
+  dPhase = (psStart->m_fPhase
+	    + (double)psStart->m_fPhaseIncrement * (double)lSampleCount);
+  psModulation->m_fPhase = (LADSPA_Data)(dPhase - floor(dPhase));
+}
+
+// Set up psGlide and psModulation for the modulated span starting
+// lPosition samples into a glide from fDelay towards fTarget at fRate
+// samples per sample and lSampleIndex samples into the modulation
+// psStart. The delay may reach up to fMaxDelay samples. Returns the
+// whole sample part of the delay at the start of the span.
+static unsigned long setupModulation(LADSPA_Data fDelay,
+				     LADSPA_Data fTarget,
+				     LADSPA_Data fRate,
+				     unsigned long lPosition,
+				     LADSPA_Data fWet,
+				     const Modulation* psStart,
+				     unsigned long lSampleIndex,
+				     LADSPA_Data fMaxDelay,
+				     Glide* psGlide,
+				     Modulation* psModulation) {
+
+  unsigned long lDelay;
+
+  // -----------------------------------------------------------------
+
+  lDelay = setupGlide(fDelay, fTarget, fRate, lPosition, fWet, psGlide);
+  offsetModulation(psStart, lSampleIndex, psModulation);
+  psModulation->m_fMaximum = fMaxDelay - (LADSPA_Data)lDelay;
+  return lDelay;
+}
+
+// -------------------------------------------------------------------
+
+// Same as runFractionalDelayChannel() with the delay of every sample
+// offset by psModulation, limited to between 0 and lMaxDelay samples
+// minus the taps of the interpolators. The taps are gathered one sample at a
+// time, so there is no need to split the block where they wrap around
+// the end of the ring buffer. The allpass cannot follow the delay and
+// is replaced by linear interpolation.
+//
+// During a crossfade both read heads are read fully wet into scratch
+// buffers, from which the linear crossfade kernel reads them like two
+// whole sample delays.
+static void runModulatedDelayChannel(const LADSPA_Data* pfInput,
+				     const Modulation* psStart,
+				     LADSPA_Data* pfOutput,
+				     LADSPA_Data* pfBuffer,
+				     unsigned long lBufferSize,
+				     unsigned long lWriteOffset,
+				     unsigned long lMaxDelay,
+				     LADSPA_Data fDelay,
+				     int iInterpolation,
+				     unsigned long lCrossfadeLength,
+				     LADSPA_Data fGlideRate,
+				     LADSPA_Data fWet,
+				     LADSPA_Data fGain,
+				     ReadHeads* psReadHeads,
+				     unsigned long SampleCount,
+				     const SimpleDelayKernels* psKernels) {
+
+  // The first sample of each scratch buffer stands in for the second
+  // tap of the linear crossfade kernel, whose coefficient is zero.
+  LADSPA_Data afHead[SDL_CHUNK_SIZE + 1];
+  LADSPA_Data afNextHead[SDL_CHUNK_SIZE + 1];
+  Glide sGlide;
+  Interpolator sInterpolator;
+  Interpolator sNextInterpolator;
+  Modulation sModulation;
+  LADSPA_Data fAngleIncrement;
+  LADSPA_Data fDry;
+  LADSPA_Data fGlideStart;
+  LADSPA_Data fMaxDelay;
+  unsigned long lChunk;
+  unsigned long lDelay;
+  unsigned long lFade;
+  unsigned long lGlideLength;
+  unsigned long lGlidePosition;
+  unsigned long lRest;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  fGlideStart = psReadHeads->m_sHead.m_fDelay;
+  lGlideLength = followDelayChange(psReadHeads, fDelay, lCrossfadeLength,
+				   fGlideRate);
+  if (lGlideLength == 0) {
+    fDelay = psReadHeads->m_sHead.m_fDelay;
+    fGlideStart = fDelay;
+  }
+
+  // -----------------------------------------------------------------
+
+  fDry = (1 - fWet) * fGain;
+  fWet = fWet * fGain;
+  fMaxDelay = (LADSPA_Data)(lMaxDelay - SDL_INTERPOLATION_TAPS);
+
+  // -----------------------------------------------------------------
+
+  sInterpolator.m_lTaps = 2;
+  sInterpolator.m_afCoefficients[0] = fWet;
+  sInterpolator.m_afCoefficients[1] = 0;
+  sInterpolator.m_fState = 0;
+  sNextInterpolator = sInterpolator;
+  afHead[0] = 0;
+  afNextHead[0] = 0;
+  lGlidePosition = 0;
+  fAngleIncrement = 0;
+  if (psReadHeads->m_lFadeLength > 0)
+    fAngleIncrement = (LADSPA_Data)(M_PI / 2) / psReadHeads->m_lFadeLength;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+    lChunk = SampleCount - lSampleIndex;
+    if (lChunk > SDL_CHUNK_SIZE)
+      lChunk = SDL_CHUNK_SIZE;
+
+    // ---------------------------------------------------------------
+
+    copyToRingBuffer(pfInput + lSampleIndex, pfBuffer, lBufferSize,
+		     (lWriteOffset + lSampleIndex) & (lBufferSize - 1),
+		     lChunk, psKernels->m_fnFlushSpan);
+
+    // ---------------------------------------------------------------
+
+    lFade = 0;
+    if (psReadHeads->m_lFadeLength > 0) {
+      lFade = psReadHeads->m_lFadeLength - psReadHeads->m_lFadePosition;
+      if (lFade > lChunk)
+	lFade = lChunk;
+      lDelay = setupModulation(psReadHeads->m_sHead.m_fDelay,
+			       psReadHeads->m_sHead.m_fDelay,
+			       0, 0, 1,
+			       psStart, lSampleIndex, fMaxDelay,
+			       &sGlide, &sModulation);
+      psKernels->m_psReplacingKernels
+	->m_aafnModulateSpan[psStart->m_iSource][iInterpolation]
+	(pfBuffer,
+	 lBufferSize,
+	 ((lWriteOffset + lSampleIndex + lBufferSize - lDelay)
+	  & (lBufferSize - 1)),
+	 pfInput + lSampleIndex,
+	 afHead + 1,
+	 &sGlide,
+	 &sModulation,
+	 0,
+	 lFade);
+      lDelay = setupModulation(psReadHeads->m_sNextHead.m_fDelay,
+			       psReadHeads->m_sNextHead.m_fDelay,
+			       0, 0, 1,
+			       psStart, lSampleIndex, fMaxDelay,
+			       &sGlide, &sModulation);
+      psKernels->m_psReplacingKernels
+	->m_aafnModulateSpan[psStart->m_iSource][iInterpolation]
+	(pfBuffer,
+	 lBufferSize,
+	 ((lWriteOffset + lSampleIndex + lBufferSize - lDelay)
+	  & (lBufferSize - 1)),
+	 pfInput + lSampleIndex,
+	 afNextHead + 1,
+	 &sGlide,
+	 &sModulation,
+	 0,
+	 lFade);
+      psKernels->m_afnCrossfadeSpan[SDL_INTERPOLATION_LINEAR]
+	(afHead + 1,
+	 afNextHead + 1,
+	 pfInput + lSampleIndex,
+	 pfOutput + lSampleIndex,
+	 &sInterpolator,
+	 &sNextInterpolator,
+	 psReadHeads->m_lFadePosition * fAngleIncrement,
+	 fAngleIncrement,
+	 fDry,
+	 lFade);
+      psReadHeads->m_lFadePosition += lFade;
+
+      // -------------------------------------------------------------
+
+      // The next head takes over.
+      if (psReadHeads->m_lFadePosition == psReadHeads->m_lFadeLength) {
+	psReadHeads->m_sHead = psReadHeads->m_sNextHead;
+	psReadHeads->m_lFadeLength = 0;
+	fDelay = psReadHeads->m_sHead.m_fDelay;
+	fGlideStart = fDelay;
+      }
+    }
+
+    // ---------------------------------------------------------------
+
+    // Without a glide, the glide span keeps the delay of the read head.
+    lRest = lChunk - lFade;
+    if (lRest > 0) {
+      lDelay = setupModulation(fGlideStart, fDelay, fGlideRate,
+			       lGlidePosition, fWet,
+			       psStart, lSampleIndex + lFade, fMaxDelay,
+			       &sGlide, &sModulation);
+      psKernels->m_aafnModulateSpan[psStart->m_iSource][iInterpolation]
+	(pfBuffer,
+	 lBufferSize,
+	 ((lWriteOffset + lSampleIndex + lFade + lBufferSize - lDelay)
+	  & (lBufferSize - 1)),
+	 pfInput + lSampleIndex + lFade,
+	 pfOutput + lSampleIndex + lFade,
+	 &sGlide,
+	 &sModulation,
+	 fDry,
+	 lRest);
+      lGlidePosition += lRest;
+
+      // -------------------------------------------------------------
+
+      // Should the modulation stop, the allpass carries on from the
+      // last sample read.
+      if (lSampleIndex + lChunk == SampleCount
+	  && iInterpolation == SDL_INTERPOLATION_ALLPASS)
+	psReadHeads->m_sHead.m_fAllpassState
+	  = readLinearSample(pfBuffer,
+			     lBufferSize,
+			     ((lWriteOffset + lSampleIndex + lFade
+			       + lBufferSize - lDelay)
+			      & (lBufferSize - 1)),
+			     getAnyModulatedOffset(&sGlide, &sModulation,
+						   lRest - 1),
+			     sGlide.m_fMinimum,
+			     lRest - 1);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  if (lGlideLength > SampleCount)
+    psReadHeads->m_sHead.m_fDelay
+      = (LADSPA_Data)getGlideDelay(fGlideStart, fDelay, fGlideRate,
+				   SampleCount);
+  else if (lGlideLength > 0)
+    psReadHeads->m_sHead.m_fDelay = fDelay;
+}
+
+// -------------------------------------------------------------------
+
+// Check whether psModulation changes the delay during the next
+// SampleCount samples. A silent or missing modulation input does not,
+// neither does an LFO without depth.
+static int isModulated(const Modulation* psModulation,
+		       unsigned long SampleCount,
+		       const SimpleDelayKernels* psKernels) {
+  if (psModulation->m_iSource != SDL_MODULATION_INPUT)
+    return psModulation->m_fScale > 0;
+  return (psModulation->m_pfModulation != NULL
+	  && (psKernels->m_fnCountTrailingSilence(psModulation
+						  ->m_pfModulation,
+						  SampleCount)
+	      < SampleCount));
+}
+
+// -------------------------------------------------------------------
+
+// Run one channel of the delay line for SampleCount samples with a
+// constant wet gain, letting it sleep while it is idle. Blocks
+// without any modulation take the cheaper path of constant delays.
+static void runDelayChannel(const LADSPA_Data* pfInput,
+			    const Modulation* psModulation,
+			    LADSPA_Data* pfOutput,
+			    LADSPA_Data* pfBuffer,
+			    unsigned long lBufferSize,
+			    unsigned long lWriteOffset,
+			    unsigned long lMaxDelay,
+			    unsigned long* plSilentSamples,
+			    unsigned long* plUnwrittenSamples,
+			    ReadHeads* psReadHeads,
+			    LADSPA_Data fDelay,
+			    int iInterpolation,
+			    unsigned long lCrossfadeLength,
+			    LADSPA_Data fGlideRate,
+			    LADSPA_Data fWet,
+			    LADSPA_Data fGain,
+			    unsigned long SampleCount,
+			    const SimpleDelayKernels* psKernels) {
+  if (runIdleSimpleDelayChannel(pfInput,
+				pfOutput,
+				pfBuffer,
+				lBufferSize,
+				lWriteOffset,
+				lMaxDelay,
+				plSilentSamples,
+				plUnwrittenSamples,
+				SampleCount,
+				psKernels)) {
+    // Everything read from the ring buffer is silent, so the read
+    // head can jump to the new delay right away. Whatever remains of
+    // the allpass output has decayed long ago.
+    resetReadHeads(psReadHeads, fDelay);
+  } else if (isModulated(psModulation, SampleCount, psKernels)) {
+    runModulatedDelayChannel(pfInput,
+			     psModulation,
+			     pfOutput,
+			     pfBuffer,
+			     lBufferSize,
+			     lWriteOffset,
+			     lMaxDelay,
+			     fDelay,
+			     iInterpolation,
+			     lCrossfadeLength,
+			     fGlideRate,
+			     fWet,
+			     fGain,
+			     psReadHeads,
+			     SampleCount,
+			     psKernels);
+  } else {
+    runFractionalDelayChannel(pfInput,
+			      pfOutput,
+			      pfBuffer,
+			      lBufferSize,
+			      lWriteOffset,
+			      fDelay,
+			      iInterpolation,
+			      lCrossfadeLength,
+			      fGlideRate,
+			      fWet,
+			      fGain,
+			      psReadHeads,
+			      SampleCount,
+			      psKernels);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Same as above with the wet gain smoothed by psWet. While it ramps,
+// the channel is run fully wet into a scratch buffer one chunk at a
+// time and the ramp kernel mixes the result with the input. The rest
+// of the block is left to the constant gain kernels, so smoothing
+// costs nothing while the control stands still.
+static void runSmoothedDelayChannel(const LADSPA_Data* pfInput,
+				    const Modulation* psModulation,
+				    LADSPA_Data* pfOutput,
+				    LADSPA_Data* pfBuffer,
+				    unsigned long lBufferSize,
+				    unsigned long lWriteOffset,
+				    unsigned long lMaxDelay,
+				    unsigned long* plSilentSamples,
+				    unsigned long* plUnwrittenSamples,
+				    ReadHeads* psReadHeads,
+				    LADSPA_Data fDelay,
+				    int iInterpolation,
+				    unsigned long lCrossfadeLength,
+				    LADSPA_Data fGlideRate,
+				    SmoothedGain* psWet,
+				    LADSPA_Data fGain,
+				    unsigned long SampleCount,
+				    const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data afWet[SDL_CHUNK_SIZE];
+  Modulation sModulation;
+  unsigned long lChunk;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0;
+       lSampleIndex < SampleCount && psWet->m_lRemaining > 0;
+       lSampleIndex += lChunk) {
+    lChunk = SampleCount - lSampleIndex;
+    if (lChunk > psWet->m_lRemaining)
+      lChunk = psWet->m_lRemaining;
+    if (lChunk > SDL_CHUNK_SIZE)
+      lChunk = SDL_CHUNK_SIZE;
+    offsetModulation(psModulation, lSampleIndex, &sModulation);
+    runDelayChannel(pfInput + lSampleIndex,
+		    &sModulation,
+		    afWet,
+		    pfBuffer,
+		    lBufferSize,
+		    (lWriteOffset + lSampleIndex) & (lBufferSize - 1),
+		    lMaxDelay,
+		    plSilentSamples,
+		    plUnwrittenSamples,
+		    psReadHeads,
+		    fDelay,
+		    iInterpolation,
+		    lCrossfadeLength,
+		    fGlideRate,
+		    1,
+		    1,
+		    lChunk,
+		    psKernels->m_psReplacingKernels);
+    psKernels->m_fnMixRampSpan(pfInput + lSampleIndex,
+			       afWet,
+			       pfOutput + lSampleIndex,
+			       psWet->m_fValue,
+			       psWet->m_fIncrement,
+			       fGain,
+			       lChunk);
+    advanceSmoothedGain(psWet, lChunk);
+  }
+
+  // -----------------------------------------------------------------
+
+  if (lSampleIndex < SampleCount) {
+    offsetModulation(psModulation, lSampleIndex, &sModulation);
+    runDelayChannel(pfInput + lSampleIndex,
+		    &sModulation,
+		    pfOutput + lSampleIndex,
+		    pfBuffer,
+		    lBufferSize,
+		    (lWriteOffset + lSampleIndex) & (lBufferSize - 1),
+		    lMaxDelay,
+		    plSilentSamples,
+		    plUnwrittenSamples,
+		    psReadHeads,
+		    fDelay,
+		    iInterpolation,
+		    lCrossfadeLength,
+		    fGlideRate,
+		    psWet->m_fValue,
+		    fGain,
+		    SampleCount - lSampleIndex,
+		    psKernels);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run one channel of the reverse flavour for SampleCount samples with
+// the wet gain smoothed by psWet, letting it sleep while it is idle.
+// New segments are lLength samples long. The block is split into
+// chunks like in runSmoothedDelayChannel() and each chunk into spans
+// which end where a window changes direction or a read wraps around
+// the start of the ring buffer.
+static void runReverseDelayChannel(const LADSPA_Data* pfInput,
+				   LADSPA_Data* pfOutput,
+				   LADSPA_Data* pfBuffer,
+				   unsigned long lBufferSize,
+				   unsigned long lWriteOffset,
+				   unsigned long lMaxDelay,
+				   unsigned long* plSilentSamples,
+				   unsigned long* plUnwrittenSamples,
+				   ReverseHeads* psReverseHeads,
+				   unsigned long lLength,
+				   SmoothedGain* psWet,
+				   LADSPA_Data fGain,
+				   unsigned long SampleCount,
+				   const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data afWet[SDL_CHUNK_SIZE];
+  LADSPA_Data fWet;
+  LADSPA_Data fWetIncrement;
+  LADSPA_Data fWindow;
+  LADSPA_Data fWindowIncrement;
+  unsigned long lBufferSizeMinusOne;
+  unsigned long lChunk;
+  unsigned long lHalf;
+  unsigned long lPhase;
+  unsigned long lReadFirst;
+  unsigned long lReadSecond;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+  unsigned long lSpanIndex;
+  unsigned long lWrite;
+
+  // -----------------------------------------------------------------
+
+  lBufferSizeMinusOne = lBufferSize - 1;
+  if (runIdleSimpleDelayChannel(pfInput,
+				pfOutput,
+				pfBuffer,
+				lBufferSize,
+				lWriteOffset,
+				lMaxDelay,
+				plSilentSamples,
+				plUnwrittenSamples,
+				SampleCount,
+				psKernels)) {
+    // Nothing but silence is left to play, so the next segment may as
+    // well start from scratch.
+    resetReverseHeads(psReverseHeads);
+  } else {
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      if (psWet->m_lRemaining > lSampleIndex) {
+	if (lChunk > psWet->m_lRemaining - lSampleIndex)
+	  lChunk = psWet->m_lRemaining - lSampleIndex;
+	fWet = psWet->m_fValue + psWet->m_fIncrement * lSampleIndex;
+	fWetIncrement = psWet->m_fIncrement;
+      } else {
+	fWet = psWet->m_fTarget;
+	fWetIncrement = 0;
+      }
+      copyToRingBuffer(pfInput + lSampleIndex, pfBuffer, lBufferSize,
+		       (lWriteOffset + lSampleIndex) & lBufferSizeMinusOne,
+		       lChunk, psKernels->m_fnFlushSpan);
+
+      // -------------------------------------------------------------
+
+      for (lSpanIndex = 0; lSpanIndex < lChunk; lSpanIndex += lSpan) {
+	lPhase = psReverseHeads->m_lPhase;
+	if (lPhase == 0)
+	  psReverseHeads->m_lLength = lLength;
+	lHalf = psReverseHeads->m_lLength / 2;
+	lWrite = lWriteOffset + lSampleIndex + lSpanIndex + lBufferSize - 1;
+	lReadFirst = (lWrite - 2 * lPhase) & lBufferSizeMinusOne;
+	if (lPhase == lHalf)
+	  psReverseHeads->m_lSecondLength = psReverseHeads->m_lLength;
+	if (lPhase < lHalf) {
+	  lReadSecond
+	    = ((lWrite - 2 * (lPhase
+			      + psReverseHeads->m_lSecondLength
+			      - psReverseHeads->m_lSecondLength / 2))
+	       & lBufferSizeMinusOne);
+	  fWindowIncrement = 1 / (LADSPA_Data)lHalf;
+	  fWindow = lPhase * fWindowIncrement;
+	  lSpan = lHalf - lPhase;
+	} else {
+	  lReadSecond = (lWrite - 2 * (lPhase - lHalf)) & lBufferSizeMinusOne;
+	  fWindowIncrement
+	    = -1 / (LADSPA_Data)(psReverseHeads->m_lLength - lHalf);
+	  fWindow = (psReverseHeads->m_lLength - lPhase) * -fWindowIncrement;
+	  lSpan = psReverseHeads->m_lLength - lPhase;
+	}
+	if (lSpan > lChunk - lSpanIndex)
+	  lSpan = lChunk - lSpanIndex;
+	if (lSpan > lReadFirst + 1)
+	  lSpan = lReadFirst + 1;
+	if (lSpan > lReadSecond + 1)
+	  lSpan = lReadSecond + 1;
+	psKernels->m_fnReverseSpan(pfBuffer + lReadFirst,
+				   pfBuffer + lReadSecond,
+				   afWet + lSpanIndex,
+				   fWindow,
+				   fWindowIncrement,
+				   lSpan);
+	psReverseHeads->m_lPhase = lPhase + lSpan;
+	if (psReverseHeads->m_lPhase == psReverseHeads->m_lLength)
+	  psReverseHeads->m_lPhase = 0;
+      }
+
+      // -------------------------------------------------------------
+
+      psKernels->m_fnMixRampSpan(pfInput + lSampleIndex,
+				 afWet,
+				 pfOutput + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(psWet, SampleCount);
+}
+
+// -------------------------------------------------------------------
+
+// Run one channel of the pitch shifting flavour for SampleCount
+// samples with the wet gain smoothed by psWet, letting it sleep while
+// it is idle. lHeads read heads sweep through fSweep samples of delay
+// beyond lDelay, the phase at *pfPhase moving by fPhaseIncrement every
+// sample, so each of them plays the input back at a different speed
+// until it jumps back to the other end of its sweep. The block is
+// split into chunks like in runSmoothedDelayChannel(). The gathers of
+// the kernel wrap around the ring buffer by themselves.
+static void runPitchShiftChannel(const LADSPA_Data* pfInput,
+				 LADSPA_Data* pfOutput,
+				 LADSPA_Data* pfBuffer,
+				 unsigned long lBufferSize,
+				 unsigned long lWriteOffset,
+				 unsigned long lMaxDelay,
+				 unsigned long* plSilentSamples,
+				 unsigned long* plUnwrittenSamples,
+				 LADSPA_Data* pfPhase,
+				 unsigned long lDelay,
+				 LADSPA_Data fPhaseIncrement,
+				 LADSPA_Data fSweep,
+				 unsigned long lHeads,
+				 SmoothedGain* psWet,
+				 LADSPA_Data fGain,
+				 unsigned long SampleCount,
+				 const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data afWet[SDL_CHUNK_SIZE];
+  LADSPA_Data fWet;
+  LADSPA_Data fWetIncrement;
+  unsigned long lChunk;
+  unsigned long lSampleIndex;
+
+  // -----------------------------------------------------------------
+
+  if (!runIdleSimpleDelayChannel(pfInput,
+				 pfOutput,
+				 pfBuffer,
+				 lBufferSize,
+				 lWriteOffset,
+				 lMaxDelay,
+				 plSilentSamples,
+				 plUnwrittenSamples,
+				 SampleCount,
+				 psKernels)) {
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      if (psWet->m_lRemaining > lSampleIndex) {
+	if (lChunk > psWet->m_lRemaining - lSampleIndex)
+	  lChunk = psWet->m_lRemaining - lSampleIndex;
+	fWet = psWet->m_fValue + psWet->m_fIncrement * lSampleIndex;
+	fWetIncrement = psWet->m_fIncrement;
+      } else {
+	fWet = psWet->m_fTarget;
+	fWetIncrement = 0;
+      }
+      copyToRingBuffer(pfInput + lSampleIndex, pfBuffer, lBufferSize,
+		       (lWriteOffset + lSampleIndex) & (lBufferSize - 1),
+		       lChunk, psKernels->m_fnFlushSpan);
+      psKernels->m_fnPitchShiftSpan(pfBuffer,
+				    lBufferSize,
+				    ((lWriteOffset + lSampleIndex
+				      + lBufferSize - lDelay)
+				     & (lBufferSize - 1)),
+				    afWet,
+				    *pfPhase,
+				    fPhaseIncrement,
+				    fSweep,
+				    lHeads,
+				    lChunk);
+      *pfPhase += fPhaseIncrement * lChunk;
+      *pfPhase -= floorf(*pfPhase);
+      psKernels->m_fnMixRampSpan(pfInput + lSampleIndex,
+				 afWet,
+				 pfOutput + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(psWet, SampleCount);
+}
+
+// -------------------------------------------------------------------
+
+// Get the length in samples of a sweep of the pitch shifting heads.
+static LADSPA_Data
+getPitchSweep(const SimpleDelayLine* psSimpleDelayLine) {
+  return (LADSPA_Data)(PITCH_SWEEP_TIME * psSimpleDelayLine->m_fSampleRate);
+}
+
+// Get the distance a pitch shifting head moves through its sweep per
+// sample. A shift of s semitones plays the input back 2^(s/12) times
+// as fast, so the heads sweep through the delay line at that speed
+// minus one. Without a shift the increment is exactly 0.
+static LADSPA_Data
+getPitchPhaseIncrement(const SimpleDelayLine* psSimpleDelayLine) {
+  return (LADSPA_Data)((1 - pow(2, (LIMIT_BETWEEN_MIN_AND_MAX_PITCH_SHIFT
+				    (*(psSimpleDelayLine->m_pfPitchShift))
+				    / 12.0)))
+		       / getPitchSweep(psSimpleDelayLine));
+}
+
+// Shorten a delay of fDelay samples where necessary for a sweep of the
+// pitch shifting heads to stay within the longest delay. The
+// interpolation reads one sample beyond the end of a sweep.
+static LADSPA_Data
+limitPitchShiftDelay(const SimpleDelayLine* psSimpleDelayLine,
+		     LADSPA_Data fDelay) {
+
+  unsigned long lLongestDelay;
+
+  // -----------------------------------------------------------------
+
+  lLongestDelay = (psSimpleDelayLine->m_lMaxDelay
+		   - (unsigned long)getPitchSweep(psSimpleDelayLine) - 2);
+  if (fDelay > lLongestDelay)
+    fDelay = (LADSPA_Data)lLongestDelay;
+  return fDelay;
+}
+
+// Get the delay at which the pitch shifting flavour plays a delay of
+// fDelay samples without a shift. Standing still, the heads would sum
+// as a comb filter, so a single head is read from the middle of the
+// sweep instead. That is where the second of two heads starting at a
+// phase of 0 sits at full weight, so both head modes sound the same
+// and a shift picks up from there without a jump.
+static LADSPA_Data
+getUnshiftedPitchDelay(const SimpleDelayLine* psSimpleDelayLine,
+		       LADSPA_Data fDelay) {
+  return (limitPitchShiftDelay(psSimpleDelayLine, fDelay)
+	  + (LADSPA_Data)(unsigned long)(getPitchSweep(psSimpleDelayLine)
+					 / 2));
+}
+
+// Run both channels of the pitch shifting flavour for a block of
+// SampleCount samples with delays of fDelayLeft and fDelayRight
+// samples and a non-zero shift.
+static void runPitchShiftDelayLine(SimpleDelayLine* psSimpleDelayLine,
+				   LADSPA_Data fDelayLeft,
+				   LADSPA_Data fDelayRight,
+				   LADSPA_Data fGain,
+				   unsigned long SampleCount,
+				   const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data fPhaseIncrement;
+  LADSPA_Data fSweep;
+  unsigned long lHeads;
+
+  // -----------------------------------------------------------------
+
+  fSweep = getPitchSweep(psSimpleDelayLine);
+  fPhaseIncrement = getPitchPhaseIncrement(psSimpleDelayLine);
+  lHeads = 2;
+  if (psSimpleDelayLine->m_pfFourReadHeads != NULL
+      && *(psSimpleDelayLine->m_pfFourReadHeads) > 0)
+    lHeads = 4;
+  fDelayLeft = limitPitchShiftDelay(psSimpleDelayLine, fDelayLeft);
+  fDelayRight = limitPitchShiftDelay(psSimpleDelayLine, fDelayRight);
+
+  // -----------------------------------------------------------------
+
+  runPitchShiftChannel(psSimpleDelayLine->m_pfInputLeft,
+		       psSimpleDelayLine->m_pfOutputLeft,
+		       psSimpleDelayLine->m_pfBufferLeft,
+		       psSimpleDelayLine->m_lBufferSize,
+		       psSimpleDelayLine->m_lWritePointer,
+		       psSimpleDelayLine->m_lMaxDelay,
+		       &psSimpleDelayLine->m_lSilentSamplesLeft,
+		       &psSimpleDelayLine->m_lUnwrittenSamplesLeft,
+		       &psSimpleDelayLine->m_fPitchPhaseLeft,
+		       (unsigned long)fDelayLeft,
+		       fPhaseIncrement,
+		       fSweep,
+		       lHeads,
+		       &psSimpleDelayLine->m_sWetLeft,
+		       fGain,
+		       SampleCount,
+		       psKernels);
+  runPitchShiftChannel(psSimpleDelayLine->m_pfInputRight,
+		       psSimpleDelayLine->m_pfOutputRight,
+		       psSimpleDelayLine->m_pfBufferRight,
+		       psSimpleDelayLine->m_lBufferSize,
+		       psSimpleDelayLine->m_lWritePointer,
+		       psSimpleDelayLine->m_lMaxDelay,
+		       &psSimpleDelayLine->m_lSilentSamplesRight,
+		       &psSimpleDelayLine->m_lUnwrittenSamplesRight,
+		       &psSimpleDelayLine->m_fPitchPhaseRight,
+		       (unsigned long)fDelayRight,
+		       fPhaseIncrement,
+		       fSweep,
+		       lHeads,
+		       &psSimpleDelayLine->m_sWetRight,
+		       fGain,
+		       SampleCount,
+		       psKernels);
+}
+
+// -------------------------------------------------------------------
+
+// Run both channels of the plain flavour for a block of SampleCount
+// samples in the ring buffer of frames, with delays of lDelayLeft and
+// lDelayRight samples and the wet gains smoothed. The block is split
+// where the written or one of the read regions wraps around the end
+// of the ring buffer and where a ramp of the wet gains ends.
+//
+// Idle channels are tracked like in runIdleSimpleDelayChannel(), but
+// since both share their frames, writing is only skipped while both
+// of them are idle.
+static void runInterleavedDelayLine(SimpleDelayLine* psSimpleDelayLine,
+				    unsigned long lDelayLeft,
+				    unsigned long lDelayRight,
+				    LADSPA_Data fGain,
+				    unsigned long SampleCount,
+				    const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data* pfFrames;
+  SmoothedGain* psWetLeft;
+  SmoothedGain* psWetRight;
+  unsigned long lBufferSize;
+  unsigned long lMaxDelay;
+  unsigned long lReadLeft;
+  unsigned long lReadRight;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+  unsigned long lTrailingSilenceLeft;
+  unsigned long lTrailingSilenceRight;
+  unsigned long lWrite;
+
+  // -----------------------------------------------------------------
+
+  pfFrames = psSimpleDelayLine->m_pfFrames;
+  psWetLeft = &psSimpleDelayLine->m_sWetLeft;
+  psWetRight = &psSimpleDelayLine->m_sWetRight;
+  lBufferSize = psSimpleDelayLine->m_lBufferSize;
+  lMaxDelay = psSimpleDelayLine->m_lMaxDelay;
+  lWrite = psSimpleDelayLine->m_lWritePointer;
+
+  // -----------------------------------------------------------------
+
+  lTrailingSilenceLeft
+    = psKernels->m_fnCountTrailingSilence(psSimpleDelayLine->m_pfInputLeft,
+					  SampleCount);
+  lTrailingSilenceRight
+    = psKernels->m_fnCountTrailingSilence(psSimpleDelayLine->m_pfInputRight,
+					  SampleCount);
+  if (lTrailingSilenceLeft == SampleCount
+      && lTrailingSilenceRight == SampleCount
+      && psSimpleDelayLine->m_lSilentSamplesLeft >= lMaxDelay
+      && psSimpleDelayLine->m_lSilentSamplesRight >= lMaxDelay) {
+    psKernels->m_fnSilenceSpan(psSimpleDelayLine->m_pfInputLeft,
+			       psSimpleDelayLine->m_pfOutputLeft,
+			       SampleCount);
+    psKernels->m_fnSilenceSpan(psSimpleDelayLine->m_pfInputRight,
+			       psSimpleDelayLine->m_pfOutputRight,
+			       SampleCount);
+    psSimpleDelayLine->m_lUnwrittenSamplesLeft += SampleCount;
+    if (psSimpleDelayLine->m_lUnwrittenSamplesLeft > lMaxDelay)
+      psSimpleDelayLine->m_lUnwrittenSamplesLeft = lMaxDelay;
+    advanceSmoothedGain(psWetLeft, SampleCount);
+    advanceSmoothedGain(psWetRight, SampleCount);
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  // The skipped frames are counted by m_lUnwrittenSamplesLeft alone.
+  if (psSimpleDelayLine->m_lUnwrittenSamplesLeft > 0) {
+    zeroRingBuffer(pfFrames, 2 * lBufferSize,
+		   2 * ((lWrite + lBufferSize
+			 - psSimpleDelayLine->m_lUnwrittenSamplesLeft)
+			& (lBufferSize - 1)),
+		   2 * psSimpleDelayLine->m_lUnwrittenSamplesLeft);
+    psSimpleDelayLine->m_lUnwrittenSamplesLeft = 0;
+  }
+  countSilentSamples(&psSimpleDelayLine->m_lSilentSamplesLeft,
+		     lTrailingSilenceLeft, lMaxDelay, SampleCount);
+  countSilentSamples(&psSimpleDelayLine->m_lSilentSamplesRight,
+		     lTrailingSilenceRight, lMaxDelay, SampleCount);
+
+  // -----------------------------------------------------------------
+
+  lReadLeft = (lWrite + lBufferSize - lDelayLeft) & (lBufferSize - 1);
+  lReadRight = (lWrite + lBufferSize - lDelayRight) & (lBufferSize - 1);
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lWrite)
+      lSpan = lBufferSize - lWrite;
+    if (lSpan > lBufferSize - lReadLeft)
+      lSpan = lBufferSize - lReadLeft;
+    if (lSpan > lBufferSize - lReadRight)
+      lSpan = lBufferSize - lReadRight;
+    if (psWetLeft->m_lRemaining > 0 && lSpan > psWetLeft->m_lRemaining)
+      lSpan = psWetLeft->m_lRemaining;
+    if (psWetRight->m_lRemaining > 0 && lSpan > psWetRight->m_lRemaining)
+      lSpan = psWetRight->m_lRemaining;
+
+    // ---------------------------------------------------------------
+
+    psKernels->m_fnMixInterleavedSpan(psSimpleDelayLine->m_pfInputLeft
+				      + lSampleIndex,
+				      psSimpleDelayLine->m_pfInputRight
+				      + lSampleIndex,
+				      psSimpleDelayLine->m_pfOutputLeft
+				      + lSampleIndex,
+				      psSimpleDelayLine->m_pfOutputRight
+				      + lSampleIndex,
+				      pfFrames + 2 * lWrite,
+				      pfFrames + 2 * lReadLeft,
+				      pfFrames + 2 * lReadRight,
+				      psWetLeft->m_fValue,
+				      (psWetLeft->m_lRemaining > 0
+				       ? psWetLeft->m_fIncrement : 0),
+				      psWetRight->m_fValue,
+				      (psWetRight->m_lRemaining > 0
+				       ? psWetRight->m_fIncrement : 0),
+				      fGain,
+				      lSpan);
+
+    // ---------------------------------------------------------------
+
+    advanceSmoothedGain(psWetLeft, lSpan);
+    advanceSmoothedGain(psWetRight, lSpan);
+    lWrite = (lWrite + lSpan) & (lBufferSize - 1);
+    lReadLeft = (lReadLeft + lSpan) & (lBufferSize - 1);
+    lReadRight = (lReadRight + lSpan) & (lBufferSize - 1);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Add the feedback to SampleCount samples of both channels written to
+// the ring buffers starting at lWriteOffset, using fnFeedbackSpan. The
+// region is split at the end of the buffers. Afterwards the filter
+// states are flushed.
+static void feedbackToRingBuffers(const LADSPA_Data* pfReadLeft,
+				  const LADSPA_Data* pfReadRight,
+				  LADSPA_Data* pfBufferLeft,
+				  LADSPA_Data* pfBufferRight,
+				  unsigned long lBufferSize,
+				  unsigned long lWriteOffset,
+				  unsigned long SampleCount,
+				  Feedback* psFeedback,
+				  FeedbackSpanFunction fnFeedbackSpan) {
+
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+  int iChannel;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+    lSpan = SampleCount - lSampleIndex;
+    if (lSpan > lBufferSize - lWriteOffset)
+      lSpan = lBufferSize - lWriteOffset;
+    fnFeedbackSpan(pfReadLeft + lSampleIndex,
+		   pfReadRight + lSampleIndex,
+		   pfBufferLeft + lWriteOffset,
+		   pfBufferRight + lWriteOffset,
+		   psFeedback,
+		   lSpan);
+    lWriteOffset = (lWriteOffset + lSpan) & (lBufferSize - 1);
+  }
+
+  // -----------------------------------------------------------------
+
+  for (iChannel = 0; iChannel < 2; iChannel++) {
+    psFeedback->m_afLowPassState[iChannel]
+      = FLUSH_FEEDBACK_STATE(psFeedback->m_afLowPassState[iChannel]);
+    psFeedback->m_afHighPassState[iChannel]
+      = FLUSH_FEEDBACK_STATE(psFeedback->m_afHighPassState[iChannel]);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Count the digitally silent samples at the end of the SampleCount
+// samples of the ring buffer starting at lOffset.
+static unsigned long countTrailingRingSilence(const LADSPA_Data* pfBuffer,
+					      unsigned long lBufferSize,
+					      unsigned long lOffset,
+					      unsigned long SampleCount,
+					      const SimpleDelayKernels*
+					      psKernels) {
+
+  unsigned long lSpan;
+  unsigned long lSilence;
+
+  // -----------------------------------------------------------------
+
+  lSpan = SampleCount;
+  if (lSpan > lBufferSize - lOffset)
+    lSpan = lBufferSize - lOffset;
+  if (lSpan == SampleCount)
+    return psKernels->m_fnCountTrailingSilence(pfBuffer + lOffset,
+					       SampleCount);
+  lSilence = psKernels->m_fnCountTrailingSilence(pfBuffer,
+						 SampleCount - lSpan);
+  if (lSilence < SampleCount - lSpan)
+    return lSilence;
+  return (lSilence
+	  + psKernels->m_fnCountTrailingSilence(pfBuffer + lOffset, lSpan));
+}
+
+// -------------------------------------------------------------------
+
+// Find how many samples of a channel can be processed in one go
+// before its read heads catch up with samples written in the same
+// go, which would miss their feedback. Up to SampleCount samples are
+// looked at for the purpose, at least one is always returned.
+static unsigned long getFeedbackDistance(const ReadHeads* psReadHeads,
+					 LADSPA_Data fDelay,
+					 int iInterpolation,
+					 const Modulation* psModulation,
+					 unsigned long SampleCount) {
+
+  LADSPA_Data fMinimum;
+  unsigned long lSampleIndex;
+  unsigned long lDistance;
+
+  // -----------------------------------------------------------------
+
+  // Crossfades and glides never leave the range between the old and
+  // the new delay.
+  fMinimum = fDelay;
+  if (psReadHeads->m_sHead.m_fDelay >= 0
+      && psReadHeads->m_sHead.m_fDelay < fMinimum)
+    fMinimum = psReadHeads->m_sHead.m_fDelay;
+  if (psReadHeads->m_lFadeLength > 0
+      && psReadHeads->m_sNextHead.m_fDelay < fMinimum)
+    fMinimum = psReadHeads->m_sNextHead.m_fDelay;
+
+  // The LFO only ever lengthens the delay, the modulation input may
+  // shorten it.
+  if (psModulation->m_iSource == SDL_MODULATION_INPUT
+      && psModulation->m_pfModulation != NULL) {
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex++) {
+      if (fDelay + (psModulation->m_fScale
+		    * psModulation->m_pfModulation[lSampleIndex])
+	  < fMinimum)
+	fMinimum = (fDelay
+		    + (psModulation->m_fScale
+		       * psModulation->m_pfModulation[lSampleIndex]));
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  // The cubic and the allpass interpolators read one sample past the
+  // whole part of the delay.
+  if (fMinimum < 1)
+    return 1;
+  lDistance = (unsigned long)fMinimum;
+  if (iInterpolation == SDL_INTERPOLATION_CUBIC
+      || iInterpolation == SDL_INTERPOLATION_ALLPASS)
+    lDistance--;
+  if (lDistance < 1)
+    return 1;
+  return lDistance < SampleCount ? lDistance : SampleCount;
+}
+
+// -------------------------------------------------------------------
+
+// Run lChunk samples of one channel of a delay line with feedback.
+// The delay line is read fully wet into pfRead, where the feedback is
+// taken from, and mixed with the input by the ramp kernel according
+// to psWet. The caller keeps lChunk within the ramp of psWet.
+//
+// Returns 1 if the channel is idle. In that case pfRead is silent and
+// the ring buffer has not been written.
+static int runFeedbackChannel(const LADSPA_Data* pfInput,
+			      const Modulation* psModulation,
+			      LADSPA_Data* pfOutput,
+			      LADSPA_Data* pfRead,
+			      LADSPA_Data* pfBuffer,
+			      unsigned long lBufferSize,
+			      unsigned long lWriteOffset,
+			      unsigned long lMaxDelay,
+			      unsigned long* plSilentSamples,
+			      unsigned long* plUnwrittenSamples,
+			      ReadHeads* psReadHeads,
+			      LADSPA_Data fDelay,
+			      int iInterpolation,
+			      unsigned long lCrossfadeLength,
+			      LADSPA_Data fGlideRate,
+			      SmoothedGain* psWet,
+			      LADSPA_Data fGain,
+			      unsigned long lChunk,
+			      const SimpleDelayKernels* psKernels) {
+  runDelayChannel(pfInput,
+		  psModulation,
+		  pfRead,
+		  pfBuffer,
+		  lBufferSize,
+		  lWriteOffset,
+		  lMaxDelay,
+		  plSilentSamples,
+		  plUnwrittenSamples,
+		  psReadHeads,
+		  fDelay,
+		  iInterpolation,
+		  lCrossfadeLength,
+		  fGlideRate,
+		  1,
+		  1,
+		  lChunk,
+		  psKernels->m_psReplacingKernels);
+  psKernels->m_fnMixRampSpan(pfInput,
+			     pfRead,
+			     pfOutput,
+			     psWet->m_fValue,
+			     psWet->m_lRemaining > 0 ? psWet->m_fIncrement : 0,
+			     fGain,
+			     lChunk);
+  advanceSmoothedGain(psWet, lChunk);
+  return *plUnwrittenSamples > 0;
+}
+
+// Wake up an idle channel whose ring buffer is about to receive the
+// cross feedback of the other channel. The part of the ring buffer
+// skipped so far, up to the end of the chunk of lChunk samples
+// starting at lWriteOffset, is zeroed. What the channel read for the
+// chunk is silent already.
+static void wakeFeedbackChannel(LADSPA_Data* pfBuffer,
+				unsigned long lBufferSize,
+				unsigned long lWriteOffset,
+				unsigned long* plUnwrittenSamples,
+				unsigned long lChunk) {
+  zeroRingBuffer(pfBuffer,
+		 lBufferSize,
+		 ((lWriteOffset + lChunk + lBufferSize - *plUnwrittenSamples)
+		  & (lBufferSize - 1)),
+		 *plUnwrittenSamples);
+  *plUnwrittenSamples = 0;
+}
+
+// Keep track of the silence written to the ring buffer by a channel
+// with feedback, which lasts only as long as the feedback has died
+// away as well. lSilentSamples is the count before the chunk of
+// lChunk samples starting at lWriteOffset was written.
+static void trackFeedbackSilence(const LADSPA_Data* pfBuffer,
+				 unsigned long lBufferSize,
+				 unsigned long lWriteOffset,
+				 unsigned long lMaxDelay,
+				 unsigned long lSilentSamples,
+				 unsigned long* plSilentSamples,
+				 unsigned long lChunk,
+				 const SimpleDelayKernels* psKernels) {
+
+  unsigned long lTrailingSilence;
+
+  // -----------------------------------------------------------------
+
+  lTrailingSilence
+    = countTrailingRingSilence(pfBuffer, lBufferSize, lWriteOffset, lChunk,
+			       psKernels);
+  if (lTrailingSilence == lChunk)
+    lSilentSamples += lChunk;
+  else
+    lSilentSamples = lTrailingSilence;
+  *plSilentSamples
+    = lSilentSamples > lMaxDelay ? lMaxDelay : lSilentSamples;
+}
+
+// -------------------------------------------------------------------
+
+// Run both channels of an instance with feedback for a block of
+// SampleCount samples. The block is cut into chunks short enough that
+// nothing written during a chunk is read back during the same chunk.
+// Each chunk is first run like a delay line without feedback, which
+// leaves the input in the ring buffers. The feedback kernel then
+// updates that part of the ring buffers in place while it is still
+// in the cache, for both channels in the same pass. Working on the
+// ring buffers rather than the inputs keeps this correct for hosts
+// which process in place.
+static void runFeedbackDelayLine(SimpleDelayLine* psSimpleDelayLine,
+				 const Modulation* psModulationLeft,
+				 const Modulation* psModulationRight,
+				 LADSPA_Data fDelayLeft,
+				 LADSPA_Data fDelayRight,
+				 int iInterpolation,
+				 unsigned long lCrossfadeLength,
+				 LADSPA_Data fGlideRate,
+				 int iSaturation,
+				 LADSPA_Data fGain,
+				 unsigned long SampleCount,
+				 const SimpleDelayKernels* psKernels) {
+
+  LADSPA_Data afReadLeft[SDL_CHUNK_SIZE];
+  LADSPA_Data afReadRight[SDL_CHUNK_SIZE];
+  Modulation sModulationLeft;
+  Modulation sModulationRight;
+  unsigned long lSilentSamplesLeft;
+  unsigned long lSilentSamplesRight;
+  unsigned long lWriteOffset;
+  unsigned long lChunk;
+  unsigned long lSampleIndex;
+  int iIdleLeft;
+  int iIdleRight;
+
+  // -----------------------------------------------------------------
+
+  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+    lChunk = SampleCount - lSampleIndex;
+    if (lChunk > SDL_CHUNK_SIZE)
+      lChunk = SDL_CHUNK_SIZE;
+    if (psSimpleDelayLine->m_sWetLeft.m_lRemaining > 0
+	&& lChunk > psSimpleDelayLine->m_sWetLeft.m_lRemaining)
+      lChunk = psSimpleDelayLine->m_sWetLeft.m_lRemaining;
+    if (psSimpleDelayLine->m_sWetRight.m_lRemaining > 0
+	&& lChunk > psSimpleDelayLine->m_sWetRight.m_lRemaining)
+      lChunk = psSimpleDelayLine->m_sWetRight.m_lRemaining;
+    offsetModulation(psModulationLeft, lSampleIndex, &sModulationLeft);
+    offsetModulation(psModulationRight, lSampleIndex, &sModulationRight);
+    lChunk = getFeedbackDistance(&psSimpleDelayLine->m_sReadHeadsLeft,
+				 fDelayLeft,
+				 iInterpolation,
+				 &sModulationLeft,
+				 lChunk);
+    lChunk = getFeedbackDistance(&psSimpleDelayLine->m_sReadHeadsRight,
+				 fDelayRight,
+				 iInterpolation,
+				 &sModulationRight,
+				 lChunk);
+    lWriteOffset = ((psSimpleDelayLine->m_lWritePointer + lSampleIndex)
+		    & (psSimpleDelayLine->m_lBufferSize - 1));
+
+    // ---------------------------------------------------------------
+
+    lSilentSamplesLeft = psSimpleDelayLine->m_lSilentSamplesLeft;
+    lSilentSamplesRight = psSimpleDelayLine->m_lSilentSamplesRight;
+    iIdleLeft
+      = runFeedbackChannel(psSimpleDelayLine->m_pfInputLeft + lSampleIndex,
+			   &sModulationLeft,
+			   psSimpleDelayLine->m_pfOutputLeft + lSampleIndex,
+			   afReadLeft,
+			   psSimpleDelayLine->m_pfBufferLeft,
+			   psSimpleDelayLine->m_lBufferSize,
+			   lWriteOffset,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   &psSimpleDelayLine->m_lSilentSamplesLeft,
+			   &psSimpleDelayLine->m_lUnwrittenSamplesLeft,
+			   &psSimpleDelayLine->m_sReadHeadsLeft,
+			   fDelayLeft,
+			   iInterpolation,
+			   lCrossfadeLength,
+			   fGlideRate,
+			   &psSimpleDelayLine->m_sWetLeft,
+			   fGain,
+			   lChunk,
+			   psKernels);
+    iIdleRight
+      = runFeedbackChannel(psSimpleDelayLine->m_pfInputRight + lSampleIndex,
+			   &sModulationRight,
+			   psSimpleDelayLine->m_pfOutputRight + lSampleIndex,
+			   afReadRight,
+			   psSimpleDelayLine->m_pfBufferRight,
+			   psSimpleDelayLine->m_lBufferSize,
+			   lWriteOffset,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   &psSimpleDelayLine->m_lSilentSamplesRight,
+			   &psSimpleDelayLine->m_lUnwrittenSamplesRight,
+			   &psSimpleDelayLine->m_sReadHeadsRight,
+			   fDelayRight,
+			   iInterpolation,
+			   lCrossfadeLength,
+			   fGlideRate,
+			   &psSimpleDelayLine->m_sWetRight,
+			   fGain,
+			   lChunk,
+			   psKernels);
+
+    // ---------------------------------------------------------------
+
+    // Cross feedback keeps both channels awake as long as one of them
+    // is.
+    if (psSimpleDelayLine->m_sFeedback.m_fCrossGain != 0) {
+      if (iIdleLeft && !iIdleRight) {
+	wakeFeedbackChannel(psSimpleDelayLine->m_pfBufferLeft,
+			    psSimpleDelayLine->m_lBufferSize,
+			    lWriteOffset,
+			    &psSimpleDelayLine->m_lUnwrittenSamplesLeft,
+			    lChunk);
+	iIdleLeft = 0;
+      }
+      else if (iIdleRight && !iIdleLeft) {
+	wakeFeedbackChannel(psSimpleDelayLine->m_pfBufferRight,
+			    psSimpleDelayLine->m_lBufferSize,
+			    lWriteOffset,
+			    &psSimpleDelayLine->m_lUnwrittenSamplesRight,
+			    lChunk);
+	iIdleRight = 0;
+      }
+    }
+
+    // An idle channel reads nothing but silence and the feedback of
+    // it has died away. Its part of the ring buffer still gets written
+    // by the stereo kernel, but it is skipped and zeroed before the
+    // channel wakes up.
+    if (iIdleLeft)
+      resetFeedbackChannel(&psSimpleDelayLine->m_sFeedback, 0);
+    if (iIdleRight)
+      resetFeedbackChannel(&psSimpleDelayLine->m_sFeedback, 1);
+    if (iIdleLeft && iIdleRight)
+      continue;
+    feedbackToRingBuffers(afReadLeft,
+			  afReadRight,
+			  psSimpleDelayLine->m_pfBufferLeft,
+			  psSimpleDelayLine->m_pfBufferRight,
+			  psSimpleDelayLine->m_lBufferSize,
+			  lWriteOffset,
+			  lChunk,
+			  &psSimpleDelayLine->m_sFeedback,
+			  psKernels->m_afnFeedbackSpan[iSaturation]);
+    if (!iIdleLeft)
+      trackFeedbackSilence(psSimpleDelayLine->m_pfBufferLeft,
+			   psSimpleDelayLine->m_lBufferSize,
+			   lWriteOffset,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   lSilentSamplesLeft,
+			   &psSimpleDelayLine->m_lSilentSamplesLeft,
+			   lChunk,
+			   psKernels);
+    if (!iIdleRight)
+      trackFeedbackSilence(psSimpleDelayLine->m_pfBufferRight,
+			   psSimpleDelayLine->m_lBufferSize,
+			   lWriteOffset,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   lSilentSamplesRight,
+			   &psSimpleDelayLine->m_lSilentSamplesRight,
+			   lChunk,
+			   psKernels);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Read the interpolation mode of an instance. Instances of the plugin
+// flavour without the port always use whole sample delays.
+static int getInterpolation(const SimpleDelayLine* psSimpleDelayLine) {
+  if (psSimpleDelayLine->m_pfInterpolation == NULL)
+    return SDL_INTERPOLATION_NONE;
+  return (int)(LIMIT_BETWEEN_0_AND_ALLPASS(*(psSimpleDelayLine
+					      ->m_pfInterpolation))
+	       + 0.5f);
+}
+
+// -------------------------------------------------------------------
+
+// Read the way an instance follows changes of the delay. Instances of
+// the plugin flavours without the port always jump.
+static int getDelayChange(const SimpleDelayLine* psSimpleDelayLine) {
+  if (psSimpleDelayLine->m_pfDelayChange == NULL)
+    return SDL_DELAY_CHANGE_JUMP;
+  return (int)(LIMIT_BETWEEN_0_AND_GLIDE(*(psSimpleDelayLine
+					    ->m_pfDelayChange))
+	       + 0.5f);
+}
+
+// Read the length of the crossfade following a change of the delay
+// (in samples). Zero unless crossfades are selected.
+static unsigned long
+getCrossfadeLength(const SimpleDelayLine* psSimpleDelayLine) {
+  if (getDelayChange(psSimpleDelayLine) != SDL_DELAY_CHANGE_CROSSFADE)
+    return 0;
+  return (unsigned long)
+    (LIMIT_BETWEEN_0_AND_MAX_CROSSFADE_TIME(*(psSimpleDelayLine
+					      ->m_pfCrossfadeTime))
+     * psSimpleDelayLine->m_fSampleRate);
+}
+
+// Read the rate of a glide following a change of the delay (in
+// samples per sample). Zero unless glides are selected.
+static LADSPA_Data getGlideRate(const SimpleDelayLine* psSimpleDelayLine) {
+  if (getDelayChange(psSimpleDelayLine) != SDL_DELAY_CHANGE_GLIDE)
+    return 0;
+  return LIMIT_BETWEEN_MIN_AND_MAX_GLIDE_RATE(*(psSimpleDelayLine
+						->m_pfGlideRate));
+}
+
+// Check whether the reverse flavour is switched to play backwards.
+static int isReversed(const SimpleDelayLine* psSimpleDelayLine) {
+  return (psSimpleDelayLine->m_pfReverse != NULL
+	  && *(psSimpleDelayLine->m_pfReverse) > 0);
+}
+
+// Get the length of the segments played backwards for a delay of
+// fDelay samples. Both heads reach back up to twice the length.
+static unsigned long
+getReverseLength(const SimpleDelayLine* psSimpleDelayLine,
+		 LADSPA_Data fDelay) {
+
+  unsigned long lLength;
+
+  // -----------------------------------------------------------------
+
+  lLength = (unsigned long)fDelay;
+  if (lLength < 2)
+    lLength = 2;
+  if (lLength > psSimpleDelayLine->m_lMaxDelay / 2)
+    lLength = psSimpleDelayLine->m_lMaxDelay / 2;
+  return lLength;
+}
+
+// -------------------------------------------------------------------
+
+// Set up the modulation of both channels of an instance for the next
+// block. The chorus flavour of the plugin modulates the delays by its
+// LFO, the modulated flavour by its inputs and the others not at all.
+// The LFO sweeps the delay from the Delay control up to the depth on
+// top of it.
+static void setupModulations(const SimpleDelayLine* psSimpleDelayLine,
+			     Modulation* psModulationLeft,
+			     Modulation* psModulationRight) {
+
+  double dPhase;
+
+  // -----------------------------------------------------------------
+
+  psModulationLeft->m_iSource = SDL_MODULATION_INPUT;
+  psModulationLeft->m_pfModulation = psSimpleDelayLine->m_pfModulationLeft;
+  psModulationLeft->m_fScale = psSimpleDelayLine->m_fSampleRate;
+  psModulationLeft->m_fPhase = 0;
+  psModulationLeft->m_fPhaseIncrement = 0;
+  psModulationLeft->m_fMaximum = 0;
+  *psModulationRight = *psModulationLeft;
+  psModulationRight->m_pfModulation = psSimpleDelayLine->m_pfModulationRight;
+  if (psSimpleDelayLine->m_pfLfoRate == NULL)
+    return;
+
+  // -----------------------------------------------------------------
+
+  psModulationLeft->m_iSource
+    = SDL_MODULATION_SINE
+    + (int)(LIMIT_BETWEEN_0_AND_TRIANGLE(*(psSimpleDelayLine->m_pfLfoShape))
+	    + 0.5f);
+  psModulationLeft->m_pfModulation = NULL;
+  psModulationLeft->m_fScale
+    = (LIMIT_BETWEEN_0_AND_MAX_LFO_DEPTH(*(psSimpleDelayLine->m_pfLfoDepth))
+       * psSimpleDelayLine->m_fSampleRate / 2);
+  psModulationLeft->m_fPhase = (LADSPA_Data)psSimpleDelayLine->m_dLfoPhase;
+  psModulationLeft->m_fPhaseIncrement
+    = (LIMIT_BETWEEN_MIN_AND_MAX_LFO_RATE(*(psSimpleDelayLine->m_pfLfoRate))
+       / psSimpleDelayLine->m_fSampleRate);
+  *psModulationRight = *psModulationLeft;
+  dPhase = (psSimpleDelayLine->m_dLfoPhase
+	    + (LIMIT_BETWEEN_0_AND_MAX_LFO_STEREO_PHASE(*(psSimpleDelayLine
+							   ->m_pfLfoStereoPhase))
+	       / 360.0));
+  psModulationRight->m_fPhase = (LADSPA_Data)(dPhase - floor(dPhase));
+}
+
+// -------------------------------------------------------------------
+
+// Coefficient of a one-pole low-pass with a cutoff of fCutoff Hz.
+// Cutoffs at or above the Nyquist frequency let everything through.
+static LADSPA_Data getOnePoleCoefficient(LADSPA_Data fCutoff,
+					 LADSPA_Data fSampleRate) {
+  if (fCutoff >= fSampleRate / 2)
+    return 1;
+  return (LADSPA_Data)(1 - exp(-2 * M_PI * fCutoff / fSampleRate));
+}
+
+// Set up the feedback path of an instance for the next block. Returns
+// the saturation switch, or -1 if the flavour of the plugin has no
+// feedback path or it has nothing to do. The filter states are
+// dropped in that case, so they start afresh with the feedback.
+static int setupFeedback(SimpleDelayLine* psSimpleDelayLine) {
+
+  Feedback* psFeedback;
+  LADSPA_Data fFeedback;
+  LADSPA_Data fCrossFeedback;
+  int iSaturation;
+
+  // -----------------------------------------------------------------
+
+  if (psSimpleDelayLine->m_pfFeedback == NULL)
+    return -1;
+  psFeedback = &psSimpleDelayLine->m_sFeedback;
+  fFeedback = LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine->m_pfFeedback));
+  fCrossFeedback = 0;
+  if (psSimpleDelayLine->m_pfCrossFeedback != NULL)
+    fCrossFeedback
+      = LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine->m_pfCrossFeedback));
+
+  // Splitting the feedback between the channels keeps the sum of each
+  // row of the matrix, so it stays as stable as the feedback of a
+  // single channel.
+  psFeedback->m_fGain = fFeedback * (1 - fCrossFeedback);
+  psFeedback->m_fCrossGain = fFeedback * fCrossFeedback;
+  iSaturation = *(psSimpleDelayLine->m_pfSaturation) > 0;
+  if (fFeedback == 0) {
+    resetFeedbackChannel(psFeedback, 0);
+    resetFeedbackChannel(psFeedback, 1);
+    return -1;
+  }
+
+  // -----------------------------------------------------------------
+
+  psFeedback->m_fLowPass
+    = getOnePoleCoefficient(LIMIT_BETWEEN_MIN_AND_MAX_FEEDBACK_CUTOFF
+			    (*(psSimpleDelayLine->m_pfFeedbackLowPass)),
+			    psSimpleDelayLine->m_fSampleRate);
+  psFeedback->m_fHighPass
+    = getOnePoleCoefficient(LIMIT_BETWEEN_MIN_AND_MAX_FEEDBACK_CUTOFF
+			    (*(psSimpleDelayLine->m_pfFeedbackHighPass)),
+			    psSimpleDelayLine->m_fSampleRate);
+  return iSaturation;
+}
+
+// -------------------------------------------------------------------
+
+// Subnormal numbers can turn up in the mix as well, for example when
+// the host feeds us a decaying tail, and many CPUs handle them very
+// slowly. Where we can, we enable flush-to-zero and denormals-are-zero
+// for the duration of a run and restore the host's MXCSR afterwards.
+#if defined(SDL_X86_SIMD) && defined(__SSE__)
+#define SDL_MXCSR_FTZ_DAZ 0x8040
+#define SDL_BEGIN_DENORMAL_PROTECTION			\
+  unsigned int uiSavedMxcsr = _mm_getcsr();		\
+  _mm_setcsr(uiSavedMxcsr | SDL_MXCSR_FTZ_DAZ)
+#define SDL_END_DENORMAL_PROTECTION		\
+  _mm_setcsr(uiSavedMxcsr)
+#else
+#define SDL_BEGIN_DENORMAL_PROTECTION do {} while (0)
+#define SDL_END_DENORMAL_PROTECTION do {} while (0)
+#endif
+
+// -------------------------------------------------------------------
+
+// Run a delay line instance for a block of SampleCount samples using
+// the provided set of kernels. The output is scaled by fGain.
+static inline void
+runSimpleDelayLineWithKernels(LADSPA_Handle Instance,
+			      unsigned long SampleCount,
+			      const SimpleDelayKernels* psKernels,
+			      LADSPA_Data fGain) {
+  
+  LADSPA_Data fDelayLeft;
+  LADSPA_Data fDelayRight;
+  SimpleDelayLine* psSimpleDelayLine;
+  int iInterpolation;
+  unsigned long lCrossfadeLength;
+  unsigned long lSmoothingLength;
+  LADSPA_Data fGlideRate;
+  Modulation sModulationLeft;
+  Modulation sModulationRight;
+  int iSaturation;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+  
+  psSimpleDelayLine = (SimpleDelayLine*)Instance;
+
+  // -----------------------------------------------------------------
+  
+  fDelayLeft
+    = (LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psSimpleDelayLine->m_pfDelayLeft)) 
+       * psSimpleDelayLine->m_fSampleRate);
+  fDelayRight
+    = (LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psSimpleDelayLine->m_pfDelayRight))
+       * psSimpleDelayLine->m_fSampleRate);
+  iInterpolation = getInterpolation(psSimpleDelayLine);
+  if (iInterpolation == SDL_INTERPOLATION_NONE) {
+    fDelayLeft = (LADSPA_Data)(unsigned long)fDelayLeft;
+    fDelayRight = (LADSPA_Data)(unsigned long)fDelayRight;
+  }
+  lCrossfadeLength = getCrossfadeLength(psSimpleDelayLine);
+  fGlideRate = getGlideRate(psSimpleDelayLine);
+  setupModulations(psSimpleDelayLine, &sModulationLeft, &sModulationRight);
+  iSaturation = setupFeedback(psSimpleDelayLine);
+
+  // -----------------------------------------------------------------
+  
+  lSmoothingLength
+    = (unsigned long)(SMOOTHING_TIME * psSimpleDelayLine->m_fSampleRate);
+  setSmoothedGainTarget(&psSimpleDelayLine->m_sWetLeft,
+			LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine
+						->m_pfDryWetLeft)),
+			lSmoothingLength);
+  setSmoothedGainTarget(&psSimpleDelayLine->m_sWetRight,
+			LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine
+						->m_pfDryWetRight)),
+			lSmoothingLength);
+
+  // -----------------------------------------------------------------
+  
+  if (psSimpleDelayLine->m_pfFrames != NULL) {
+    runInterleavedDelayLine(psSimpleDelayLine,
+			    (unsigned long)fDelayLeft,
+			    (unsigned long)fDelayRight,
+			    fGain,
+			    SampleCount,
+			    psKernels);
+  } else if (iSaturation >= 0) {
+    runFeedbackDelayLine(psSimpleDelayLine,
+			 &sModulationLeft,
+			 &sModulationRight,
+			 fDelayLeft,
+			 fDelayRight,
+			 iInterpolation,
+			 lCrossfadeLength,
+			 fGlideRate,
+			 iSaturation,
+			 fGain,
+			 SampleCount,
+			 psKernels);
+  } else if (psSimpleDelayLine->m_pfPitchShift != NULL
+	     && getPitchPhaseIncrement(psSimpleDelayLine) != 0) {
+    runPitchShiftDelayLine(psSimpleDelayLine,
+			   fDelayLeft,
+			   fDelayRight,
+			   fGain,
+			   SampleCount,
+			   psKernels);
+  } else if (isReversed(psSimpleDelayLine)) {
+    runReverseDelayChannel(psSimpleDelayLine->m_pfInputLeft,
+			   psSimpleDelayLine->m_pfOutputLeft,
+			   psSimpleDelayLine->m_pfBufferLeft,
+			   psSimpleDelayLine->m_lBufferSize,
+			   psSimpleDelayLine->m_lWritePointer,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   &psSimpleDelayLine->m_lSilentSamplesLeft,
+			   &psSimpleDelayLine->m_lUnwrittenSamplesLeft,
+			   &psSimpleDelayLine->m_sReverseHeadsLeft,
+			   getReverseLength(psSimpleDelayLine, fDelayLeft),
+			   &psSimpleDelayLine->m_sWetLeft,
+			   fGain,
+			   SampleCount,
+			   psKernels);
+    runReverseDelayChannel(psSimpleDelayLine->m_pfInputRight,
+			   psSimpleDelayLine->m_pfOutputRight,
+			   psSimpleDelayLine->m_pfBufferRight,
+			   psSimpleDelayLine->m_lBufferSize,
+			   psSimpleDelayLine->m_lWritePointer,
+			   psSimpleDelayLine->m_lMaxDelay,
+			   &psSimpleDelayLine->m_lSilentSamplesRight,
+			   &psSimpleDelayLine->m_lUnwrittenSamplesRight,
+			   &psSimpleDelayLine->m_sReverseHeadsRight,
+			   getReverseLength(psSimpleDelayLine, fDelayRight),
+			   &psSimpleDelayLine->m_sWetRight,
+			   fGain,
+			   SampleCount,
+			   psKernels);
+  } else {
+    // Once the reverse flavour is switched back to backwards playback,
+    // it starts with a fresh segment.
+    resetReverseHeads(&psSimpleDelayLine->m_sReverseHeadsLeft);
+    resetReverseHeads(&psSimpleDelayLine->m_sReverseHeadsRight);
+    // Once the pitch shifting flavour is shifted again, its heads
+    // start from a phase of 0.
+    if (psSimpleDelayLine->m_pfPitchShift != NULL) {
+      psSimpleDelayLine->m_fPitchPhaseLeft = 0;
+      psSimpleDelayLine->m_fPitchPhaseRight = 0;
+      fDelayLeft = getUnshiftedPitchDelay(psSimpleDelayLine, fDelayLeft);
+      fDelayRight = getUnshiftedPitchDelay(psSimpleDelayLine, fDelayRight);
+    }
+    runSmoothedDelayChannel(psSimpleDelayLine->m_pfInputLeft,
+			    &sModulationLeft,
+			    psSimpleDelayLine->m_pfOutputLeft,
+			    psSimpleDelayLine->m_pfBufferLeft,
+			    psSimpleDelayLine->m_lBufferSize,
+			    psSimpleDelayLine->m_lWritePointer,
+			    psSimpleDelayLine->m_lMaxDelay,
+			    &psSimpleDelayLine->m_lSilentSamplesLeft,
+			    &psSimpleDelayLine->m_lUnwrittenSamplesLeft,
+			    &psSimpleDelayLine->m_sReadHeadsLeft,
+			    fDelayLeft,
+			    iInterpolation,
+			    lCrossfadeLength,
+			    fGlideRate,
+			    &psSimpleDelayLine->m_sWetLeft,
+			    fGain,
+			    SampleCount,
+			    psKernels);
+    runSmoothedDelayChannel(psSimpleDelayLine->m_pfInputRight,
+			    &sModulationRight,
+			    psSimpleDelayLine->m_pfOutputRight,
+			    psSimpleDelayLine->m_pfBufferRight,
+			    psSimpleDelayLine->m_lBufferSize,
+			    psSimpleDelayLine->m_lWritePointer,
+			    psSimpleDelayLine->m_lMaxDelay,
+			    &psSimpleDelayLine->m_lSilentSamplesRight,
+			    &psSimpleDelayLine->m_lUnwrittenSamplesRight,
+			    &psSimpleDelayLine->m_sReadHeadsRight,
+			    fDelayRight,
+			    iInterpolation,
+			    lCrossfadeLength,
+			    fGlideRate,
+			    &psSimpleDelayLine->m_sWetRight,
+			    fGain,
+			    SampleCount,
+			    psKernels);
+  }
+
+  // -----------------------------------------------------------------
+  
+  psSimpleDelayLine->m_lWritePointer
+    = ((psSimpleDelayLine->m_lWritePointer + SampleCount)
+       & (psSimpleDelayLine->m_lBufferSize - 1));
+  psSimpleDelayLine->m_dLfoPhase
+    += (double)sModulationLeft.m_fPhaseIncrement * (double)SampleCount;
+  psSimpleDelayLine->m_dLfoPhase -= floor(psSimpleDelayLine->m_dLfoPhase);
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding().
+static void setRunAddingGainSimpleDelayLine(LADSPA_Handle Instance,
+					    LADSPA_Data Gain) {
+  ((SimpleDelayLine*)Instance)->m_fRunAddingGain = Gain;
+}
+
+// -------------------------------------------------------------------
+
+// Run and run_adding functions of Plugin for each of the kernel sets.
+// One pair of them is picked when the library is loaded.
+#define DEFINE_RUN_FUNCTIONS(Plugin, Isa)				\
+  static void run##Plugin##Isa(LADSPA_Handle Instance,			\
+			       unsigned long SampleCount) {		\
+    run##Plugin##WithKernels(Instance, SampleCount,			\
+			     &g_s##Isa##Kernels, 1);			\
+  }									\
+  static void runAdding##Plugin##Isa(LADSPA_Handle Instance,		\
+				     unsigned long SampleCount) {	\
+    run##Plugin##WithKernels(Instance, SampleCount,			\
+			     &g_s##Isa##AddingKernels,			\
+			     ((Plugin*)Instance)->m_fRunAddingGain);	\
+  }
+
+#ifdef SDL_X86_SIMD
+#define DEFINE_ALL_RUN_FUNCTIONS(Plugin)	\
+  DEFINE_RUN_FUNCTIONS(Plugin, Generic)		\
+  DEFINE_RUN_FUNCTIONS(Plugin, Sse2)		\
+  DEFINE_RUN_FUNCTIONS(Plugin, Avx2)		\
+  DEFINE_RUN_FUNCTIONS(Plugin, Avx512)
+#else
+#define DEFINE_ALL_RUN_FUNCTIONS(Plugin)	\
+  DEFINE_RUN_FUNCTIONS(Plugin, Generic)
+#endif
+
+DEFINE_ALL_RUN_FUNCTIONS(SimpleDelayLine)
+
+// -------------------------------------------------------------------
+
+// Store the run and run_adding functions of Plugin best suited for
+// the CPU we are running on in the descriptor.
+#define SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Isa)			\
+  do {									\
+    (psDescriptor)->run = run##Plugin##Isa;				\
+    (psDescriptor)->run_adding = runAdding##Plugin##Isa;		\
+  } while (0)
+
+#ifdef SDL_X86_SIMD
+// The CPU model has to be initialised explicitly since this function
+// is called from within a constructor.
+#define DEFINE_SELECT_RUN_FUNCTIONS(Plugin)				\
+  static void select##Plugin##RunFunctions(LADSPA_Descriptor*		\
+					   psDescriptor) {		\
+    __builtin_cpu_init();						\
+    if (__builtin_cpu_supports("avx512f")) {				\
+      SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Avx512);		\
+      return;								\
+    }									\
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) { \
+      SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Avx2);			\
+      return;								\
+    }									\
+    if (__builtin_cpu_supports("sse2")) {				\
+      SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Sse2);			\
+      return;								\
+    }									\
+    SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Generic);		\
+  }
+#else
+#define DEFINE_SELECT_RUN_FUNCTIONS(Plugin)				\
+  static void select##Plugin##RunFunctions(LADSPA_Descriptor*		\
+					   psDescriptor) {		\
+    SELECT_RUN_FUNCTIONS(psDescriptor, Plugin, Generic);		\
+  }
+#endif
+
+DEFINE_SELECT_RUN_FUNCTIONS(SimpleDelayLine)
+
+// -------------------------------------------------------------------
+
+// Throw away a simple delay line.
+static void cleanupSimpleDelayLine(LADSPA_Handle Instance) {
+
+  SimpleDelayLine* psSimpleDelayLine;
+
+  // -----------------------------------------------------------------
+  
+  psSimpleDelayLine = (SimpleDelayLine*)Instance;
+
+  // -----------------------------------------------------------------
+  
+  free(psSimpleDelayLine->m_pfBufferLeft);
+  free(psSimpleDelayLine->m_pfBufferRight);
+  free(psSimpleDelayLine->m_pfFrames);
+  free(psSimpleDelayLine);
+}
+
+// -------------------------------------------------------------------
+
+// Construct a new instance of the N-channel delay line. The channel
+// count follows from the number of ports of the descriptor.
+static LADSPA_Handle 
+instantiateMultiDelayLine(const LADSPA_Descriptor* Descriptor,
+			  unsigned long SampleRate) {
+
+  MultiDelayLine* psDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psDelayLine = (MultiDelayLine*)malloc(sizeof(MultiDelayLine));
+  if (psDelayLine == NULL) 
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psDelayLine->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psDelayLine->m_lChannelCount
+    = Descriptor->PortCount / SDL_MULTI_PORT_GROUPS;
+  psDelayLine->m_lMaxDelay = getMaxDelay(SampleRate);
+  psDelayLine->m_lBufferSize = getBufferSize(psDelayLine->m_lMaxDelay);
+  psDelayLine->m_pfBuffers
+    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize
+			   * psDelayLine->m_lChannelCount,
+			   sizeof(LADSPA_Data));
+  if (psDelayLine->m_pfBuffers == NULL) {
+    free(psDelayLine);
+    return NULL;
+  }
+  psDelayLine->m_lWritePointer = 0;
+  psDelayLine->m_fRunAddingGain = 1;
+
+  // -----------------------------------------------------------------
+
+  return psDelayLine;
+}
+
+// -------------------------------------------------------------------
+
+// Initialise and activate an instance of the N-channel delay line.
+static void activateMultiDelayLine(LADSPA_Handle Instance) {
+
+  MultiDelayLine* psMultiDelayLine;
+  DelayChannel* psChannel;
+  unsigned long lChannel;
+
+  // -----------------------------------------------------------------
+
+  psMultiDelayLine = (MultiDelayLine*)Instance;
+  memset(psMultiDelayLine->m_pfBuffers,
+	 0,
+	 (sizeof(LADSPA_Data)
+	  * psMultiDelayLine->m_lBufferSize
+	  * psMultiDelayLine->m_lChannelCount));
+
+  // -----------------------------------------------------------------
+
+  for (lChannel = 0;
+       lChannel < psMultiDelayLine->m_lChannelCount;
+       lChannel++) {
+    psChannel = psMultiDelayLine->m_asChannels + lChannel;
+    psChannel->m_lSilentSamples = psMultiDelayLine->m_lMaxDelay;
+    psChannel->m_lUnwrittenSamples = 0;
+    resetReadHeads(&psChannel->m_sReadHeads, -1);
+    resetSmoothedGain(&psChannel->m_sWet);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Connect a port of the N-channel delay line to a data location.
+static void 
+connectPortToMultiDelayLine(LADSPA_Handle Instance,
+			    unsigned long Port,
+			    LADSPA_Data* DataLocation) {
+
+  MultiDelayLine* psMultiDelayLine;
+  DelayChannel* psChannel;
+
+  // -----------------------------------------------------------------
+
+  psMultiDelayLine = (MultiDelayLine*)Instance;
+  psChannel = (psMultiDelayLine->m_asChannels
+	       + Port % psMultiDelayLine->m_lChannelCount);
+
+  // -----------------------------------------------------------------
+
+  switch (Port / psMultiDelayLine->m_lChannelCount) {
+  case SDL_MULTI_DELAY_LENGTH:
+    psChannel->m_pfDelay = DataLocation;
+    break;
+  case SDL_MULTI_DRY_WET:
+    psChannel->m_pfDryWet = DataLocation;
+    break;
+  case SDL_MULTI_INPUT:
+    psChannel->m_pfInput = DataLocation;
+    break;
+  case SDL_MULTI_OUTPUT:
+    psChannel->m_pfOutput = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run an instance of the N-channel delay line for a block of
+// SampleCount samples using the provided set of kernels. The output is
+// scaled by fGain. The channels are taken one after the other, each
+// of them through the same code as a channel of the plain stereo
+// flavour, so the kernels work along the samples of a channel.
+static inline void
+runMultiDelayLineWithKernels(LADSPA_Handle Instance,
+			     unsigned long SampleCount,
+			     const SimpleDelayKernels* psKernels,
+			     LADSPA_Data fGain) {
+
+  MultiDelayLine* psMultiDelayLine;
+  DelayChannel* psChannel;
+  Modulation sModulation;
+  LADSPA_Data fDelay;
+  unsigned long lSmoothingLength;
+  unsigned long lChannel;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+
+  psMultiDelayLine = (MultiDelayLine*)Instance;
+
+  // The delays are not modulated.
+  sModulation.m_iSource = SDL_MODULATION_INPUT;
+  sModulation.m_pfModulation = NULL;
+  sModulation.m_fScale = 0;
+  sModulation.m_fPhase = 0;
+  sModulation.m_fPhaseIncrement = 0;
+  sModulation.m_fMaximum = 0;
+  lSmoothingLength
+    = (unsigned long)(SMOOTHING_TIME * psMultiDelayLine->m_fSampleRate);
+
+  // -----------------------------------------------------------------
+
+  for (lChannel = 0;
+       lChannel < psMultiDelayLine->m_lChannelCount;
+       lChannel++) {
+    psChannel = psMultiDelayLine->m_asChannels + lChannel;
+    fDelay
+      = (LADSPA_Data)(unsigned long)
+      (LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psChannel->m_pfDelay))
+       * psMultiDelayLine->m_fSampleRate);
+    setSmoothedGainTarget(&psChannel->m_sWet,
+			  LIMIT_BETWEEN_0_AND_1(*(psChannel->m_pfDryWet)),
+			  lSmoothingLength);
+    runSmoothedDelayChannel(psChannel->m_pfInput,
+			    &sModulation,
+			    psChannel->m_pfOutput,
+			    (psMultiDelayLine->m_pfBuffers
+			     + lChannel * psMultiDelayLine->m_lBufferSize),
+			    psMultiDelayLine->m_lBufferSize,
+			    psMultiDelayLine->m_lWritePointer,
+			    psMultiDelayLine->m_lMaxDelay,
+			    &psChannel->m_lSilentSamples,
+			    &psChannel->m_lUnwrittenSamples,
+			    &psChannel->m_sReadHeads,
+			    fDelay,
+			    SDL_INTERPOLATION_NONE,
+			    0,
+			    0,
+			    &psChannel->m_sWet,
+			    fGain,
+			    SampleCount,
+			    psKernels);
+  }
+
+  // -----------------------------------------------------------------
+
+  psMultiDelayLine->m_lWritePointer
+    = ((psMultiDelayLine->m_lWritePointer + SampleCount)
+       & (psMultiDelayLine->m_lBufferSize - 1));
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding() of the N-channel delay line.
+static void setRunAddingGainMultiDelayLine(LADSPA_Handle Instance,
+					   LADSPA_Data Gain) {
+  ((MultiDelayLine*)Instance)->m_fRunAddingGain = Gain;
+}
+
+DEFINE_ALL_RUN_FUNCTIONS(MultiDelayLine)
+DEFINE_SELECT_RUN_FUNCTIONS(MultiDelayLine)
+
+// -------------------------------------------------------------------
+
+// Throw away an N-channel delay line.
+static void cleanupMultiDelayLine(LADSPA_Handle Instance) {
+
+  MultiDelayLine* psMultiDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psMultiDelayLine = (MultiDelayLine*)Instance;
+  free(psMultiDelayLine->m_pfBuffers);
+  free(psMultiDelayLine);
+}
+
+// -------------------------------------------------------------------
+
+// Construct a new instance of the multi-tap delay line. The tap count
+// follows from the number of ports of the descriptor.
+static LADSPA_Handle 
+instantiateMultiTapDelayLine(const LADSPA_Descriptor* Descriptor,
+			     unsigned long SampleRate) {
+
+  MultiTapDelayLine* psDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psDelayLine = (MultiTapDelayLine*)malloc(sizeof(MultiTapDelayLine));
+  if (psDelayLine == NULL) 
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psDelayLine->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psDelayLine->m_lTapCount
+    = ((Descriptor->PortCount - SDL_MULTI_TAP_SHARED_PORTS)
+       / SDL_TAP_PORT_GROUPS);
+  psDelayLine->m_lMaxDelay = getMaxDelay(SampleRate);
+  psDelayLine->m_lBufferSize = getBufferSize(psDelayLine->m_lMaxDelay);
+  psDelayLine->m_pfBufferLeft
+    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
+  psDelayLine->m_pfBufferRight
+    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
+  if (psDelayLine->m_pfBufferLeft == NULL ||
+      psDelayLine->m_pfBufferRight == NULL) {
+    free(psDelayLine->m_pfBufferLeft);
+    free(psDelayLine->m_pfBufferRight);
+    free(psDelayLine);
+    return NULL;
+  }
+  psDelayLine->m_lWritePointer = 0;
+  psDelayLine->m_fRunAddingGain = 1;
+
+  // -----------------------------------------------------------------
+
+  return psDelayLine;
+}
+
+// -------------------------------------------------------------------
+
+// Initialise and activate an instance of the multi-tap delay line.
+static void activateMultiTapDelayLine(LADSPA_Handle Instance) {
+
+  MultiTapDelayLine* psMultiTapDelayLine;
+  DelayTap* psTap;
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  psMultiTapDelayLine = (MultiTapDelayLine*)Instance;
+  memset(psMultiTapDelayLine->m_pfBufferLeft,
+	 0,
+	 sizeof(LADSPA_Data) * psMultiTapDelayLine->m_lBufferSize);
+  memset(psMultiTapDelayLine->m_pfBufferRight,
+	 0,
+	 sizeof(LADSPA_Data) * psMultiTapDelayLine->m_lBufferSize);
+
+  // -----------------------------------------------------------------
+
+  psMultiTapDelayLine->m_lSilentSamplesLeft
+    = psMultiTapDelayLine->m_lMaxDelay;
+  psMultiTapDelayLine->m_lSilentSamplesRight
+    = psMultiTapDelayLine->m_lMaxDelay;
+  psMultiTapDelayLine->m_lUnwrittenSamples = 0;
+  resetSmoothedGain(&psMultiTapDelayLine->m_sDry);
+  for (lTap = 0; lTap < psMultiTapDelayLine->m_lTapCount; lTap++) {
+    psTap = psMultiTapDelayLine->m_asTaps + lTap;
+    resetSmoothedGain(&psTap->m_sGainLeft);
+    resetSmoothedGain(&psTap->m_sGainRight);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Connect a port of the multi-tap delay line to a data location.
+static void 
+connectPortToMultiTapDelayLine(LADSPA_Handle Instance,
+			       unsigned long Port,
+			       LADSPA_Data* DataLocation) {
+
+  MultiTapDelayLine* psMultiTapDelayLine;
+  DelayTap* psTap;
+
+  // -----------------------------------------------------------------
+
+  psMultiTapDelayLine = (MultiTapDelayLine*)Instance;
+
+  // -----------------------------------------------------------------
+
+  switch (Port) {
+  case SDL_MULTI_TAP_DRY:
+    psMultiTapDelayLine->m_pfDry = DataLocation;
+    return;
+  case SDL_MULTI_TAP_INPUT_LEFT:
+    psMultiTapDelayLine->m_pfInputLeft = DataLocation;
+    return;
+  case SDL_MULTI_TAP_INPUT_RIGHT:
+    psMultiTapDelayLine->m_pfInputRight = DataLocation;
+    return;
+  case SDL_MULTI_TAP_OUTPUT_LEFT:
+    psMultiTapDelayLine->m_pfOutputLeft = DataLocation;
+    return;
+  case SDL_MULTI_TAP_OUTPUT_RIGHT:
+    psMultiTapDelayLine->m_pfOutputRight = DataLocation;
+    return;
+  }
+
+  // -----------------------------------------------------------------
+
+  Port -= SDL_MULTI_TAP_SHARED_PORTS;
+  psTap = (psMultiTapDelayLine->m_asTaps
+	   + Port % psMultiTapDelayLine->m_lTapCount);
+  switch (Port / psMultiTapDelayLine->m_lTapCount) {
+  case SDL_TAP_DELAY_LENGTH:
+    psTap->m_pfDelay = DataLocation;
+    break;
+  case SDL_TAP_GAIN:
+    psTap->m_pfGain = DataLocation;
+    break;
+  case SDL_TAP_PAN:
+    psTap->m_pfPan = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Add lTapCount taps at delays of plDelays samples and with the gains
+// ppsGains to SampleCount samples of pfAccumulator, using the kernel
+// fnAccumulateTapsSpan. The first sample of the accumulator is the
+// one written to the ring buffer at lWriteOffset, and the gains are
+// lSampleOffset samples into their ramps. The taps are taken in groups
+// of SDL_TAP_GROUP_SIZE, whose spans are split wherever one of their
+// reads wraps around the end of the buffer or one of their ramps ends.
+static void accumulateTaps(const LADSPA_Data* pfBuffer,
+			   unsigned long lBufferSize,
+			   unsigned long lWriteOffset,
+			   const unsigned long* plDelays,
+			   SmoothedGain* const* ppsGains,
+			   unsigned long lTapCount,
+			   unsigned long lSampleOffset,
+			   LADSPA_Data* pfAccumulator,
+			   unsigned long SampleCount,
+			   AccumulateTapsSpanFunction fnAccumulateTapsSpan) {
+
+  const LADSPA_Data* apfRead[SDL_TAP_GROUP_SIZE];
+  LADSPA_Data afGain[SDL_TAP_GROUP_SIZE];
+  LADSPA_Data afGainIncrement[SDL_TAP_GROUP_SIZE];
+  const SmoothedGain* psGain;
+  unsigned long lFirstTap;
+  unsigned long lGroupSize;
+  unsigned long lReadOffset;
+  unsigned long lRamp;
+  unsigned long lSampleIndex;
+  unsigned long lSpan;
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  for (lFirstTap = 0; lFirstTap < lTapCount; lFirstTap += lGroupSize) {
+    lGroupSize = lTapCount - lFirstTap;
+    if (lGroupSize > SDL_TAP_GROUP_SIZE)
+      lGroupSize = SDL_TAP_GROUP_SIZE;
+
+    // ---------------------------------------------------------------
+
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lSpan) {
+      lSpan = SampleCount - lSampleIndex;
+      for (lTap = 0; lTap < lGroupSize; lTap++) {
+	lReadOffset = ((lWriteOffset + lSampleIndex + lBufferSize
+			- plDelays[lFirstTap + lTap])
+		       & (lBufferSize - 1));
+	apfRead[lTap] = pfBuffer + lReadOffset;
+	if (lSpan > lBufferSize - lReadOffset)
+	  lSpan = lBufferSize - lReadOffset;
+	psGain = ppsGains[lFirstTap + lTap];
+	lRamp = lSampleOffset + lSampleIndex;
+	if (psGain->m_lRemaining > lRamp) {
+	  afGain[lTap] = psGain->m_fValue + psGain->m_fIncrement * lRamp;
+	  afGainIncrement[lTap] = psGain->m_fIncrement;
+	  if (lSpan > psGain->m_lRemaining - lRamp)
+	    lSpan = psGain->m_lRemaining - lRamp;
+	} else {
+	  afGain[lTap] = psGain->m_fTarget;
+	  afGainIncrement[lTap] = 0;
+	}
+      }
+      fnAccumulateTapsSpan(apfRead,
+			   afGain,
+			   afGainIncrement,
+			   lGroupSize,
+			   pfAccumulator + lSampleIndex,
+			   lSpan);
+    }
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run an instance of the multi-tap delay line for a block of
+// SampleCount samples using the provided set of kernels. The output
+// is scaled by fGain.
+//
+// The block is processed in chunks of up to SDL_CHUNK_SIZE samples.
+// Each chunk is stored in the ring buffers first. Then the dry signal,
+// read as a tap with a delay of zero, and all taps with a gain are
+// summed up for each channel in a scratch buffer, which stays in the
+// cache while the taps are added one group after the other. Taps
+// without a gain in a channel cost nothing there.
+static inline void
+runMultiTapDelayLineWithKernels(LADSPA_Handle Instance,
+				unsigned long SampleCount,
+				const SimpleDelayKernels* psKernels,
+				LADSPA_Data fGain) {
+
+  LADSPA_Data afAccumulatorLeft[SDL_CHUNK_SIZE];
+  LADSPA_Data afAccumulatorRight[SDL_CHUNK_SIZE];
+  unsigned long alDelaysLeft[SDL_MAX_TAPS + 1];
+  unsigned long alDelaysRight[SDL_MAX_TAPS + 1];
+  SmoothedGain* apsGainsLeft[SDL_MAX_TAPS + 1];
+  SmoothedGain* apsGainsRight[SDL_MAX_TAPS + 1];
+  MultiTapDelayLine* psMultiTapDelayLine;
+  DelayTap* psTap;
+  LADSPA_Data fTapGain;
+  LADSPA_Data fPan;
+  unsigned long lBufferSize;
+  unsigned long lChunk;
+  unsigned long lMaxDelay;
+  unsigned long lSampleIndex;
+  unsigned long lSmoothingLength;
+  unsigned long lTap;
+  unsigned long lTapCountLeft;
+  unsigned long lTapCountRight;
+  unsigned long lTrailingSilenceLeft;
+  unsigned long lTrailingSilenceRight;
+  unsigned long lWriteOffset;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+
+  psMultiTapDelayLine = (MultiTapDelayLine*)Instance;
+  lBufferSize = psMultiTapDelayLine->m_lBufferSize;
+  lMaxDelay = psMultiTapDelayLine->m_lMaxDelay;
+  lWriteOffset = psMultiTapDelayLine->m_lWritePointer;
+  lSmoothingLength
+    = (unsigned long)(SMOOTHING_TIME * psMultiTapDelayLine->m_fSampleRate);
+
+  // -----------------------------------------------------------------
+
+  // The dry signal is the first tap of both channels. The balance of
+  // a tap attenuates the channel it pans away from.
+  setSmoothedGainTarget(&psMultiTapDelayLine->m_sDry,
+			LIMIT_BETWEEN_0_AND_1(*(psMultiTapDelayLine
+						->m_pfDry)),
+			lSmoothingLength);
+  alDelaysLeft[0] = 0;
+  alDelaysRight[0] = 0;
+  apsGainsLeft[0] = &psMultiTapDelayLine->m_sDry;
+  apsGainsRight[0] = &psMultiTapDelayLine->m_sDry;
+  lTapCountLeft = 1;
+  lTapCountRight = 1;
+
+  for (lTap = 0; lTap < psMultiTapDelayLine->m_lTapCount; lTap++) {
+    psTap = psMultiTapDelayLine->m_asTaps + lTap;
+    psTap->m_lDelay
+      = (unsigned long)(LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psTap->m_pfDelay))
+			* psMultiTapDelayLine->m_fSampleRate);
+    fTapGain = LIMIT_BETWEEN_0_AND_1(*(psTap->m_pfGain));
+    fPan = LIMIT_BETWEEN_MINUS_1_AND_1(*(psTap->m_pfPan));
+    setSmoothedGainTarget(&psTap->m_sGainLeft,
+			  fPan > 0 ? fTapGain * (1 - fPan) : fTapGain,
+			  lSmoothingLength);
+    setSmoothedGainTarget(&psTap->m_sGainRight,
+			  fPan < 0 ? fTapGain * (1 + fPan) : fTapGain,
+			  lSmoothingLength);
+    if (psTap->m_sGainLeft.m_fValue != 0
+	|| psTap->m_sGainLeft.m_fTarget != 0) {
+      alDelaysLeft[lTapCountLeft] = psTap->m_lDelay;
+      apsGainsLeft[lTapCountLeft++] = &psTap->m_sGainLeft;
+    }
+    if (psTap->m_sGainRight.m_fValue != 0
+	|| psTap->m_sGainRight.m_fTarget != 0) {
+      alDelaysRight[lTapCountRight] = psTap->m_lDelay;
+      apsGainsRight[lTapCountRight++] = &psTap->m_sGainRight;
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  // Both channels are idle like in runInterleavedDelayLine().
+  lTrailingSilenceLeft
+    = psKernels->m_fnCountTrailingSilence((psMultiTapDelayLine
+					   ->m_pfInputLeft),
+					  SampleCount);
+  lTrailingSilenceRight
+    = psKernels->m_fnCountTrailingSilence((psMultiTapDelayLine
+					   ->m_pfInputRight),
+					  SampleCount);
+  if (lTrailingSilenceLeft == SampleCount
+      && lTrailingSilenceRight == SampleCount
+      && psMultiTapDelayLine->m_lSilentSamplesLeft >= lMaxDelay
+      && psMultiTapDelayLine->m_lSilentSamplesRight >= lMaxDelay) {
+    psKernels->m_fnSilenceSpan(psMultiTapDelayLine->m_pfInputLeft,
+			       psMultiTapDelayLine->m_pfOutputLeft,
+			       SampleCount);
+    psKernels->m_fnSilenceSpan(psMultiTapDelayLine->m_pfInputRight,
+			       psMultiTapDelayLine->m_pfOutputRight,
+			       SampleCount);
+    psMultiTapDelayLine->m_lUnwrittenSamples += SampleCount;
+    if (psMultiTapDelayLine->m_lUnwrittenSamples > lMaxDelay)
+      psMultiTapDelayLine->m_lUnwrittenSamples = lMaxDelay;
+  } else {
+
+    // ---------------------------------------------------------------
+
+    if (psMultiTapDelayLine->m_lUnwrittenSamples > 0) {
+      zeroRingBuffer(psMultiTapDelayLine->m_pfBufferLeft, lBufferSize,
+		     ((lWriteOffset + lBufferSize
+		       - psMultiTapDelayLine->m_lUnwrittenSamples)
+		      & (lBufferSize - 1)),
+		     psMultiTapDelayLine->m_lUnwrittenSamples);
+      zeroRingBuffer(psMultiTapDelayLine->m_pfBufferRight, lBufferSize,
+		     ((lWriteOffset + lBufferSize
+		       - psMultiTapDelayLine->m_lUnwrittenSamples)
+		      & (lBufferSize - 1)),
+		     psMultiTapDelayLine->m_lUnwrittenSamples);
+      psMultiTapDelayLine->m_lUnwrittenSamples = 0;
+    }
+    countSilentSamples(&psMultiTapDelayLine->m_lSilentSamplesLeft,
+		       lTrailingSilenceLeft, lMaxDelay, SampleCount);
+    countSilentSamples(&psMultiTapDelayLine->m_lSilentSamplesRight,
+		       lTrailingSilenceRight, lMaxDelay, SampleCount);
+
+    // ---------------------------------------------------------------
+
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      copyToRingBuffer(psMultiTapDelayLine->m_pfInputLeft + lSampleIndex,
+		       psMultiTapDelayLine->m_pfBufferLeft, lBufferSize,
+		       lWriteOffset, lChunk, psKernels->m_fnFlushSpan);
+      copyToRingBuffer(psMultiTapDelayLine->m_pfInputRight + lSampleIndex,
+		       psMultiTapDelayLine->m_pfBufferRight, lBufferSize,
+		       lWriteOffset, lChunk, psKernels->m_fnFlushSpan);
+
+      // -------------------------------------------------------------
+
+      memset(afAccumulatorLeft, 0, sizeof(LADSPA_Data) * lChunk);
+      memset(afAccumulatorRight, 0, sizeof(LADSPA_Data) * lChunk);
+      accumulateTaps(psMultiTapDelayLine->m_pfBufferLeft, lBufferSize,
+		     lWriteOffset, alDelaysLeft, apsGainsLeft, lTapCountLeft,
+		     lSampleIndex, afAccumulatorLeft, lChunk,
+		     psKernels->m_fnAccumulateTapsSpan);
+      accumulateTaps(psMultiTapDelayLine->m_pfBufferRight, lBufferSize,
+		     lWriteOffset, alDelaysRight, apsGainsRight,
+		     lTapCountRight, lSampleIndex, afAccumulatorRight, lChunk,
+		     psKernels->m_fnAccumulateTapsSpan);
+
+      // -------------------------------------------------------------
+
+      psKernels->m_fnCopySpan(afAccumulatorLeft,
+			      psMultiTapDelayLine->m_pfOutputLeft
+			      + lSampleIndex,
+			      fGain,
+			      lChunk);
+      psKernels->m_fnCopySpan(afAccumulatorRight,
+			      psMultiTapDelayLine->m_pfOutputRight
+			      + lSampleIndex,
+			      fGain,
+			      lChunk);
+      lWriteOffset = (lWriteOffset + lChunk) & (lBufferSize - 1);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(&psMultiTapDelayLine->m_sDry, SampleCount);
+  for (lTap = 0; lTap < psMultiTapDelayLine->m_lTapCount; lTap++) {
+    psTap = psMultiTapDelayLine->m_asTaps + lTap;
+    advanceSmoothedGain(&psTap->m_sGainLeft, SampleCount);
+    advanceSmoothedGain(&psTap->m_sGainRight, SampleCount);
+  }
+  psMultiTapDelayLine->m_lWritePointer
+    = ((psMultiTapDelayLine->m_lWritePointer + SampleCount)
+       & (lBufferSize - 1));
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding() of the multi-tap delay line.
+static void setRunAddingGainMultiTapDelayLine(LADSPA_Handle Instance,
+					      LADSPA_Data Gain) {
+  ((MultiTapDelayLine*)Instance)->m_fRunAddingGain = Gain;
+}
+
+DEFINE_ALL_RUN_FUNCTIONS(MultiTapDelayLine)
+DEFINE_SELECT_RUN_FUNCTIONS(MultiTapDelayLine)
+
+// -------------------------------------------------------------------
+
+// Throw away a multi-tap delay line.
+static void cleanupMultiTapDelayLine(LADSPA_Handle Instance) {
+
+  MultiTapDelayLine* psMultiTapDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psMultiTapDelayLine = (MultiTapDelayLine*)Instance;
+  free(psMultiTapDelayLine->m_pfBufferLeft);
+  free(psMultiTapDelayLine->m_pfBufferRight);
+  free(psMultiTapDelayLine);
+}
+
+// -------------------------------------------------------------------
+
+// Fill in the twiddle factors and the bit reversed indices of an FFT.
+static void setupFft(Fft* psFft) {
+
+  unsigned long lBit;
+  unsigned long lIndex;
+  unsigned long lReversed;
+
+  // -----------------------------------------------------------------
+
+  for (lIndex = 0; lIndex < SDL_FFT_SIZE / 2; lIndex++) {
+    psFft->m_afCos[lIndex]
+      = (LADSPA_Data)cos(2 * M_PI * lIndex / SDL_FFT_SIZE);
+    psFft->m_afSin[lIndex]
+      = (LADSPA_Data)sin(2 * M_PI * lIndex / SDL_FFT_SIZE);
+  }
+  for (lIndex = 0; lIndex < SDL_FFT_SIZE; lIndex++) {
+    lReversed = 0;
+    for (lBit = 1; lBit < SDL_FFT_SIZE; lBit <<= 1) {
+      lReversed <<= 1;
+      if (lIndex & lBit)
+	lReversed |= 1;
+    }
+    psFft->m_aiBitReversed[lIndex] = (unsigned short)lReversed;
+  }
+}
+
+// Transform SDL_FFT_SIZE complex values with the real parts at pfReal
+// and the imaginary parts at pfImag in place. The inverse transform is
+// not scaled. This is the iterative radix-2 algorithm, decimating in
+// time after the values have been put in bit reversed order.
+static void transformFft(const Fft* psFft,
+			 LADSPA_Data* pfReal,
+			 LADSPA_Data* pfImag,
+			 int iInverse) {
+
+  LADSPA_Data fTwiddleReal;
+  LADSPA_Data fTwiddleImag;
+  LADSPA_Data fReal;
+  LADSPA_Data fImag;
+  unsigned long lHalf;
+  unsigned long lIndex;
+  unsigned long lOther;
+  unsigned long lOffset;
+  unsigned long lStep;
+
+  // -----------------------------------------------------------------
+
+  for (lIndex = 0; lIndex < SDL_FFT_SIZE; lIndex++) {
+    lOther = psFft->m_aiBitReversed[lIndex];
+    if (lOther > lIndex) {
+      fReal = pfReal[lIndex];
+      pfReal[lIndex] = pfReal[lOther];
+      pfReal[lOther] = fReal;
+      fImag = pfImag[lIndex];
+      pfImag[lIndex] = pfImag[lOther];
+      pfImag[lOther] = fImag;
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  for (lHalf = 1; lHalf < SDL_FFT_SIZE; lHalf <<= 1) {
+    lStep = SDL_FFT_SIZE / (2 * lHalf);
+    for (lOffset = 0; lOffset < lHalf; lOffset++) {
+      fTwiddleReal = psFft->m_afCos[lOffset * lStep];
+      fTwiddleImag = (iInverse
+		      ? psFft->m_afSin[lOffset * lStep]
+		      : -psFft->m_afSin[lOffset * lStep]);
+      for (lIndex = lOffset; lIndex < SDL_FFT_SIZE; lIndex += 2 * lHalf) {
+	lOther = lIndex + lHalf;
+	fReal = fTwiddleReal * pfReal[lOther] - fTwiddleImag * pfImag[lOther];
+	fImag = fTwiddleReal * pfImag[lOther] + fTwiddleImag * pfReal[lOther];
+	pfReal[lOther] = pfReal[lIndex] - fReal;
+	pfImag[lOther] = pfImag[lIndex] - fImag;
+	pfReal[lIndex] += fReal;
+	pfImag[lIndex] += fImag;
+      }
+    }
+  }
+}
+
+// The FFT used by all convolutions, set up when the library is loaded.
+static Fft g_sFft;
+
+// -------------------------------------------------------------------
+
+// Read a tap list from psFile. Each line holds the delay of a tap (in
+// seconds) and its gain, blank lines and lines starting with # are
+// skipped. The delays are converted to samples at fSampleRate and
+// limited like the delay controls, taps without a gain are dropped.
+// The arrays allocated for the delays and the gains are returned in
+// pplDelays and ppfGains. Returns the number of taps, or -1 if the
+// file cannot be parsed or there is not enough memory.
+static long readTapFile(FILE* psFile,
+			LADSPA_Data fSampleRate,
+			unsigned long** pplDelays,
+			LADSPA_Data** ppfGains) {
+
+  char acLine[256];
+  char cFirst;
+  unsigned long* plDelays;
+  LADSPA_Data* pfGains;
+  LADSPA_Data fDelay;
+  LADSPA_Data fGain;
+  unsigned long lCapacity;
+  unsigned long lTapCount;
+
+  // -----------------------------------------------------------------
+
+  *pplDelays = NULL;
+  *ppfGains = NULL;
+  lCapacity = 0;
+  lTapCount = 0;
+  while (fgets(acLine, sizeof(acLine), psFile) != NULL) {
+    if (sscanf(acLine, " %c", &cFirst) != 1 || cFirst == '#')
+      continue;
+    if (sscanf(acLine, "%f %f", &fDelay, &fGain) != 2)
+      goto failed;
+    if (fGain == 0)
+      continue;
+
+    // ---------------------------------------------------------------
+
+    if (lTapCount == lCapacity) {
+      lCapacity = lCapacity ? 2 * lCapacity : 64;
+      plDelays = (unsigned long*)realloc(*pplDelays,
+					 lCapacity * sizeof(unsigned long));
+      if (plDelays == NULL)
+	goto failed;
+      *pplDelays = plDelays;
+      pfGains = (LADSPA_Data*)realloc(*ppfGains,
+				      lCapacity * sizeof(LADSPA_Data));
+      if (pfGains == NULL)
+	goto failed;
+      *ppfGains = pfGains;
+    }
+    (*pplDelays)[lTapCount]
+      = (unsigned long)(LIMIT_BETWEEN_0_AND_MAX_DELAY(fDelay) * fSampleRate);
+    (*ppfGains)[lTapCount] = fGain;
+    lTapCount++;
+  }
+  return (long)lTapCount;
+
+ failed:
+  free(*pplDelays);
+  free(*ppfGains);
+  *pplDelays = NULL;
+  *ppfGains = NULL;
+  return -1;
+}
+
+// -------------------------------------------------------------------
+
+// Set up the convolution with the lTapCount taps of a tap list with
+// delays of at least SDL_PARTITION_SIZE samples, up to lLongestDelay.
+// Returns NULL if there is not enough memory.
+static Convolution* createConvolution(const unsigned long* plDelays,
+				      const LADSPA_Data* pfGains,
+				      unsigned long lTapCount,
+				      unsigned long lLongestDelay) {
+
+  Convolution* psConvolution;
+  LADSPA_Data* pfSpectrum;
+  unsigned long lIndex;
+  unsigned long lPartition;
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  psConvolution = (Convolution*)malloc(sizeof(Convolution));
+  if (psConvolution == NULL)
+    return NULL;
+  psConvolution->m_lPartitionCount
+    = (lLongestDelay - SDL_PARTITION_SIZE) / SDL_PARTITION_SIZE + 1;
+  psConvolution->m_pfFilterSpectra
+    = (LADSPA_Data*)calloc(psConvolution->m_lPartitionCount
+			   * 2 * SDL_FFT_SIZE,
+			   sizeof(LADSPA_Data));
+  psConvolution->m_pfInputSpectra
+    = (LADSPA_Data*)calloc(psConvolution->m_lPartitionCount
+			   * 2 * SDL_FFT_SIZE,
+			   sizeof(LADSPA_Data));
+  if (psConvolution->m_pfFilterSpectra == NULL
+      || psConvolution->m_pfInputSpectra == NULL) {
+    free(psConvolution->m_pfFilterSpectra);
+    free(psConvolution->m_pfInputSpectra);
+    free(psConvolution);
+    return NULL;
+  }
+
+  // -----------------------------------------------------------------
+
+  // Each tap goes to the first half of its partition, the second half
+  // stays empty so that the circular convolution of the FFT does not
+  // wrap around.
+  for (lTap = 0; lTap < lTapCount; lTap++) {
+    lIndex = plDelays[lTap] - SDL_PARTITION_SIZE;
+    psConvolution->m_pfFilterSpectra[(lIndex / SDL_PARTITION_SIZE)
+				     * 2 * SDL_FFT_SIZE
+				     + lIndex % SDL_PARTITION_SIZE]
+      += pfGains[lTap];
+  }
+  for (lPartition = 0;
+       lPartition < psConvolution->m_lPartitionCount;
+       lPartition++) {
+    pfSpectrum = (psConvolution->m_pfFilterSpectra
+		  + lPartition * 2 * SDL_FFT_SIZE);
+    transformFft(&g_sFft, pfSpectrum, pfSpectrum + SDL_FFT_SIZE, 0);
+    for (lIndex = 0; lIndex < 2 * SDL_FFT_SIZE; lIndex++)
+      pfSpectrum[lIndex] *= (LADSPA_Data)(1.0 / SDL_FFT_SIZE);
+  }
+
+  // -----------------------------------------------------------------
+
+  return psConvolution;
+}
+
+// Free a convolution allocated by createConvolution(), if any.
+static void deleteConvolution(Convolution* psConvolution) {
+  if (psConvolution) {
+    free(psConvolution->m_pfFilterSpectra);
+    free(psConvolution->m_pfInputSpectra);
+    free(psConvolution);
+  }
+}
+
+// Forget all input of a convolution.
+static void resetConvolution(Convolution* psConvolution) {
+  psConvolution->m_lNewestSpectrum = 0;
+  psConvolution->m_lValidSpectra = 0;
+  psConvolution->m_lPosition = 0;
+  memset(psConvolution->m_afOutputLeft,
+	 0,
+	 sizeof(psConvolution->m_afOutputLeft));
+  memset(psConvolution->m_afOutputRight,
+	 0,
+	 sizeof(psConvolution->m_afOutputRight));
+}
+
+// Compute the output of a convolution for the next block once a block
+// of input has been written to the ring buffers, ending just before
+// lWriteOffset. The last two blocks are transformed and the product
+// of each partition with the spectrum of the input it applies to is
+// summed up, using the kernel fnMultiplyAddSpectraSpan. Of the inverse
+// transform of the sum, the second half is the output (overlap-save).
+static void runConvolutionBlock(Convolution* psConvolution,
+				const LADSPA_Data* pfBufferLeft,
+				const LADSPA_Data* pfBufferRight,
+				unsigned long lBufferSize,
+				unsigned long lWriteOffset,
+				MultiplyAddSpectraSpanFunction
+				fnMultiplyAddSpectraSpan) {
+
+  LADSPA_Data* pfSpectrum;
+  LADSPA_Data* pfSum;
+  LADSPA_Data* pfInputSpectrum;
+  unsigned long lIndex;
+  unsigned long lPartition;
+  unsigned long lPartitionCount;
+  unsigned long lReadOffset;
+
+  // -----------------------------------------------------------------
+
+  pfSpectrum = psConvolution->m_afSpectrum;
+  pfSum = psConvolution->m_afSum;
+  lReadOffset = lWriteOffset + lBufferSize - SDL_FFT_SIZE;
+  for (lIndex = 0; lIndex < SDL_FFT_SIZE; lIndex++) {
+    pfSpectrum[lIndex]
+      = pfBufferLeft[(lReadOffset + lIndex) & (lBufferSize - 1)];
+    pfSpectrum[SDL_FFT_SIZE + lIndex]
+      = pfBufferRight[(lReadOffset + lIndex) & (lBufferSize - 1)];
+  }
+  transformFft(&g_sFft, pfSpectrum, pfSpectrum + SDL_FFT_SIZE, 0);
+
+  // -----------------------------------------------------------------
+
+  lPartitionCount = psConvolution->m_lPartitionCount;
+  psConvolution->m_lNewestSpectrum
+    = (psConvolution->m_lNewestSpectrum + 1) % lPartitionCount;
+  memcpy(psConvolution->m_pfInputSpectra
+	 + psConvolution->m_lNewestSpectrum * 2 * SDL_FFT_SIZE,
+	 pfSpectrum,
+	 sizeof(psConvolution->m_afSpectrum));
+  if (psConvolution->m_lValidSpectra < lPartitionCount)
+    psConvolution->m_lValidSpectra++;
+
+  // -----------------------------------------------------------------
+
+  memset(pfSum, 0, sizeof(psConvolution->m_afSum));
+  for (lPartition = 0;
+       lPartition < psConvolution->m_lValidSpectra;
+       lPartition++) {
+    pfInputSpectrum
+      = (psConvolution->m_pfInputSpectra
+	 + (((psConvolution->m_lNewestSpectrum + lPartitionCount - lPartition)
+	     % lPartitionCount)
+	    * 2 * SDL_FFT_SIZE));
+    fnMultiplyAddSpectraSpan(pfInputSpectrum,
+			     (psConvolution->m_pfFilterSpectra
+			      + lPartition * 2 * SDL_FFT_SIZE),
+			     pfSum,
+			     SDL_FFT_SIZE);
+  }
+  transformFft(&g_sFft, pfSum, pfSum + SDL_FFT_SIZE, 1);
+  memcpy(psConvolution->m_afOutputLeft,
+	 pfSum + SDL_FFT_SIZE - SDL_PARTITION_SIZE,
+	 sizeof(psConvolution->m_afOutputLeft));
+  memcpy(psConvolution->m_afOutputRight,
+	 pfSum + 2 * SDL_FFT_SIZE - SDL_PARTITION_SIZE,
+	 sizeof(psConvolution->m_afOutputRight));
+}
+
+// -------------------------------------------------------------------
+
+// Construct a new instance of the tap file delay line and load its tap
+// list from the file named by SDL_TAP_FILE_VARIABLE. Without the
+// variable the delay line has no taps. Returns NULL if the file cannot
+// be read.
+//
+// The taps shorter than SDL_PARTITION_SIZE are always read directly.
+// The longer ones are convolved if reading them would cost more than
+// the convolution, which is the case for dense tap lists.
+static LADSPA_Handle 
+instantiateTapFileDelayLine(const LADSPA_Descriptor* Descriptor,
+			    unsigned long SampleRate) {
+
+  TapFileDelayLine* psDelayLine;
+  FILE* psFile;
+  const char* pcPath;
+  unsigned long* plDelays;
+  LADSPA_Data* pfGains;
+  LADSPA_Data fTapGain;
+  unsigned long lDelay;
+  unsigned long lDirectTapCount;
+  unsigned long lLongTapCount;
+  unsigned long lLongestDelay;
+  unsigned long lTap;
+  long lTapCount;
+
+  // -----------------------------------------------------------------
+
+  plDelays = NULL;
+  pfGains = NULL;
+  lTapCount = 0;
+  pcPath = getenv(SDL_TAP_FILE_VARIABLE);
+  if (pcPath != NULL) {
+    psFile = fopen(pcPath, "r");
+    if (psFile == NULL)
+      return NULL;
+    lTapCount = readTapFile(psFile, (LADSPA_Data)SampleRate,
+			    &plDelays, &pfGains);
+    fclose(psFile);
+    if (lTapCount < 0)
+      return NULL;
+  }
+
+  // -----------------------------------------------------------------
+
+  psDelayLine = (TapFileDelayLine*)calloc(1, sizeof(TapFileDelayLine));
+  if (psDelayLine == NULL) {
+    free(plDelays);
+    free(pfGains);
+    return NULL;
+  }
+  psDelayLine->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psDelayLine->m_lMaxDelay = getMaxDelay(SampleRate);
+  psDelayLine->m_lBufferSize = getBufferSize(psDelayLine->m_lMaxDelay);
+  psDelayLine->m_pfBufferLeft
+    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
+  psDelayLine->m_pfBufferRight
+    = (LADSPA_Data*)calloc(psDelayLine->m_lBufferSize, sizeof(LADSPA_Data));
+  psDelayLine->m_lWritePointer = 0;
+  psDelayLine->m_fRunAddingGain = 1;
+
+  // -----------------------------------------------------------------
+
+  lLongTapCount = 0;
+  lLongestDelay = 0;
+  for (lTap = 0; lTap < (unsigned long)lTapCount; lTap++) {
+    if (plDelays[lTap] >= SDL_PARTITION_SIZE) {
+      lLongTapCount++;
+      if (plDelays[lTap] > lLongestDelay)
+	lLongestDelay = plDelays[lTap];
+    }
+  }
+  if (lLongTapCount > (SDL_CONVOLUTION_COST
+		       + SDL_PARTITION_COST
+		       * ((lLongestDelay - SDL_PARTITION_SIZE)
+			  / SDL_PARTITION_SIZE + 1))) {
+
+    // Swap the short taps to the front, they are read directly.
+    lDirectTapCount = 0;
+    for (lTap = 0; lTap < (unsigned long)lTapCount; lTap++) {
+      if (plDelays[lTap] < SDL_PARTITION_SIZE) {
+	lDelay = plDelays[lTap];
+	plDelays[lTap] = plDelays[lDirectTapCount];
+	plDelays[lDirectTapCount] = lDelay;
+	fTapGain = pfGains[lTap];
+	pfGains[lTap] = pfGains[lDirectTapCount];
+	pfGains[lDirectTapCount] = fTapGain;
+	lDirectTapCount++;
+      }
+    }
+    psDelayLine->m_psConvolution
+      = createConvolution(plDelays + lDirectTapCount,
+			  pfGains + lDirectTapCount,
+			  lTapCount - lDirectTapCount,
+			  lLongestDelay);
+  } else {
+    lDirectTapCount = lTapCount;
+    psDelayLine->m_psConvolution = NULL;
+  }
+
+  // -----------------------------------------------------------------
+
+  psDelayLine->m_lDirectTapCount = lDirectTapCount;
+  psDelayLine->m_plDirectDelays = plDelays;
+  psDelayLine->m_psDirectGains
+    = (SmoothedGain*)calloc(lDirectTapCount + 1, sizeof(SmoothedGain));
+  psDelayLine->m_ppsDirectGains
+    = (SmoothedGain**)calloc(lDirectTapCount + 1, sizeof(SmoothedGain*));
+  if (psDelayLine->m_psDirectGains != NULL
+      && psDelayLine->m_ppsDirectGains != NULL) {
+    for (lTap = 0; lTap < lDirectTapCount; lTap++) {
+      setSmoothedGainTarget(psDelayLine->m_psDirectGains + lTap,
+			    pfGains[lTap],
+			    0);
+      psDelayLine->m_ppsDirectGains[lTap]
+	= psDelayLine->m_psDirectGains + lTap;
+    }
+  }
+  free(pfGains);
+
+  // -----------------------------------------------------------------
+
+  if (psDelayLine->m_pfBufferLeft == NULL
+      || psDelayLine->m_pfBufferRight == NULL
+      || psDelayLine->m_psDirectGains == NULL
+      || psDelayLine->m_ppsDirectGains == NULL
+      || (psDelayLine->m_psConvolution == NULL
+	  && lDirectTapCount < (unsigned long)lTapCount)) {
+    deleteConvolution(psDelayLine->m_psConvolution);
+    free(psDelayLine->m_psDirectGains);
+    free(psDelayLine->m_ppsDirectGains);
+    free(psDelayLine->m_pfBufferLeft);
+    free(psDelayLine->m_pfBufferRight);
+    free(plDelays);
+    free(psDelayLine);
+    return NULL;
+  }
+  return psDelayLine;
+}
+
+// -------------------------------------------------------------------
+
+// Initialise and activate an instance of the tap file delay line.
+static void activateTapFileDelayLine(LADSPA_Handle Instance) {
+
+  TapFileDelayLine* psTapFileDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psTapFileDelayLine = (TapFileDelayLine*)Instance;
+  memset(psTapFileDelayLine->m_pfBufferLeft,
+	 0,
+	 sizeof(LADSPA_Data) * psTapFileDelayLine->m_lBufferSize);
+  memset(psTapFileDelayLine->m_pfBufferRight,
+	 0,
+	 sizeof(LADSPA_Data) * psTapFileDelayLine->m_lBufferSize);
+
+  // -----------------------------------------------------------------
+
+  psTapFileDelayLine->m_lSilentSamplesLeft = psTapFileDelayLine->m_lMaxDelay;
+  psTapFileDelayLine->m_lSilentSamplesRight
+    = psTapFileDelayLine->m_lMaxDelay;
+  psTapFileDelayLine->m_lUnwrittenSamples = 0;
+  resetSmoothedGain(&psTapFileDelayLine->m_sWet);
+  if (psTapFileDelayLine->m_psConvolution != NULL)
+    resetConvolution(psTapFileDelayLine->m_psConvolution);
+}
+
+// -------------------------------------------------------------------
+
+// Connect a port of the tap file delay line to a data location.
+static void 
+connectPortToTapFileDelayLine(LADSPA_Handle Instance,
+			      unsigned long Port,
+			      LADSPA_Data* DataLocation) {
+
+  TapFileDelayLine* psTapFileDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psTapFileDelayLine = (TapFileDelayLine*)Instance;
+
+  // -----------------------------------------------------------------
+
+  switch (Port) {
+  case SDL_TAP_FILE_DRY_WET:
+    psTapFileDelayLine->m_pfDryWet = DataLocation;
+    break;
+  case SDL_TAP_FILE_INPUT_LEFT:
+    psTapFileDelayLine->m_pfInputLeft = DataLocation;
+    break;
+  case SDL_TAP_FILE_INPUT_RIGHT:
+    psTapFileDelayLine->m_pfInputRight = DataLocation;
+    break;
+  case SDL_TAP_FILE_OUTPUT_LEFT:
+    psTapFileDelayLine->m_pfOutputLeft = DataLocation;
+    break;
+  case SDL_TAP_FILE_OUTPUT_RIGHT:
+    psTapFileDelayLine->m_pfOutputRight = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run an instance of the tap file delay line for a block of
+// SampleCount samples using the provided set of kernels. The output
+// is scaled by fGain.
+//
+// The block is processed in chunks like in the multi-tap delay line.
+// The taps read directly are summed up in a scratch buffer for each
+// channel, which the output of the convolution is added to. With a
+// convolution, the chunks also end where its blocks do, so that the
+// output for the next block is computed as soon as a block of input is
+// in the ring buffers.
+static inline void
+runTapFileDelayLineWithKernels(LADSPA_Handle Instance,
+			       unsigned long SampleCount,
+			       const SimpleDelayKernels* psKernels,
+			       LADSPA_Data fGain) {
+
+  static const LADSPA_Data fOne = 1;
+  static const LADSPA_Data fZero = 0;
+  LADSPA_Data afAccumulatorLeft[SDL_CHUNK_SIZE];
+  LADSPA_Data afAccumulatorRight[SDL_CHUNK_SIZE];
+  TapFileDelayLine* psTapFileDelayLine;
+  Convolution* psConvolution;
+  const LADSPA_Data* pfConvolved;
+  SmoothedGain* psWet;
+  LADSPA_Data fWet;
+  LADSPA_Data fWetIncrement;
+  unsigned long lBufferSize;
+  unsigned long lChunk;
+  unsigned long lMaxDelay;
+  unsigned long lSampleIndex;
+  unsigned long lTrailingSilenceLeft;
+  unsigned long lTrailingSilenceRight;
+  unsigned long lWriteOffset;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+
+  psTapFileDelayLine = (TapFileDelayLine*)Instance;
+  psConvolution = psTapFileDelayLine->m_psConvolution;
+  psWet = &psTapFileDelayLine->m_sWet;
+  lBufferSize = psTapFileDelayLine->m_lBufferSize;
+  lMaxDelay = psTapFileDelayLine->m_lMaxDelay;
+  lWriteOffset = psTapFileDelayLine->m_lWritePointer;
+  setSmoothedGainTarget(psWet,
+			LIMIT_BETWEEN_0_AND_1(*(psTapFileDelayLine
+						->m_pfDryWet)),
+			(unsigned long)(SMOOTHING_TIME
+					* psTapFileDelayLine->m_fSampleRate));
+
+  // -----------------------------------------------------------------
+
+  // Both channels are idle like in the multi-tap delay line. As no tap
+  // reaches back beyond the silence, neither does the convolution,
+  // which starts over once the input returns.
+  lTrailingSilenceLeft
+    = psKernels->m_fnCountTrailingSilence(psTapFileDelayLine->m_pfInputLeft,
+					  SampleCount);
+  lTrailingSilenceRight
+    = psKernels->m_fnCountTrailingSilence(psTapFileDelayLine->m_pfInputRight,
+					  SampleCount);
+  if (lTrailingSilenceLeft == SampleCount
+      && lTrailingSilenceRight == SampleCount
+      && psTapFileDelayLine->m_lSilentSamplesLeft >= lMaxDelay
+      && psTapFileDelayLine->m_lSilentSamplesRight >= lMaxDelay) {
+    psKernels->m_fnSilenceSpan(psTapFileDelayLine->m_pfInputLeft,
+			       psTapFileDelayLine->m_pfOutputLeft,
+			       SampleCount);
+    psKernels->m_fnSilenceSpan(psTapFileDelayLine->m_pfInputRight,
+			       psTapFileDelayLine->m_pfOutputRight,
+			       SampleCount);
+    psTapFileDelayLine->m_lUnwrittenSamples += SampleCount;
+    if (psTapFileDelayLine->m_lUnwrittenSamples > lMaxDelay)
+      psTapFileDelayLine->m_lUnwrittenSamples = lMaxDelay;
+  } else {
+
+    // ---------------------------------------------------------------
+
+    if (psTapFileDelayLine->m_lUnwrittenSamples > 0) {
+      zeroRingBuffer(psTapFileDelayLine->m_pfBufferLeft, lBufferSize,
+		     ((lWriteOffset + lBufferSize
+		       - psTapFileDelayLine->m_lUnwrittenSamples)
+		      & (lBufferSize - 1)),
+		     psTapFileDelayLine->m_lUnwrittenSamples);
+      zeroRingBuffer(psTapFileDelayLine->m_pfBufferRight, lBufferSize,
+		     ((lWriteOffset + lBufferSize
+		       - psTapFileDelayLine->m_lUnwrittenSamples)
+		      & (lBufferSize - 1)),
+		     psTapFileDelayLine->m_lUnwrittenSamples);
+      psTapFileDelayLine->m_lUnwrittenSamples = 0;
+      if (psConvolution != NULL)
+	resetConvolution(psConvolution);
+    }
+    countSilentSamples(&psTapFileDelayLine->m_lSilentSamplesLeft,
+		       lTrailingSilenceLeft, lMaxDelay, SampleCount);
+    countSilentSamples(&psTapFileDelayLine->m_lSilentSamplesRight,
+		       lTrailingSilenceRight, lMaxDelay, SampleCount);
+
+    // ---------------------------------------------------------------
+
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      if (psConvolution != NULL
+	  && lChunk > SDL_PARTITION_SIZE - psConvolution->m_lPosition)
+	lChunk = SDL_PARTITION_SIZE - psConvolution->m_lPosition;
+      if (psWet->m_lRemaining > lSampleIndex) {
+	if (lChunk > psWet->m_lRemaining - lSampleIndex)
+	  lChunk = psWet->m_lRemaining - lSampleIndex;
+	fWet = psWet->m_fValue + psWet->m_fIncrement * lSampleIndex;
+	fWetIncrement = psWet->m_fIncrement;
+      } else {
+	fWet = psWet->m_fTarget;
+	fWetIncrement = 0;
+      }
+      copyToRingBuffer(psTapFileDelayLine->m_pfInputLeft + lSampleIndex,
+		       psTapFileDelayLine->m_pfBufferLeft, lBufferSize,
+		       lWriteOffset, lChunk, psKernels->m_fnFlushSpan);
+      copyToRingBuffer(psTapFileDelayLine->m_pfInputRight + lSampleIndex,
+		       psTapFileDelayLine->m_pfBufferRight, lBufferSize,
+		       lWriteOffset, lChunk, psKernels->m_fnFlushSpan);
+
+      // -------------------------------------------------------------
+
+      memset(afAccumulatorLeft, 0, sizeof(LADSPA_Data) * lChunk);
+      memset(afAccumulatorRight, 0, sizeof(LADSPA_Data) * lChunk);
+      accumulateTaps(psTapFileDelayLine->m_pfBufferLeft, lBufferSize,
+		     lWriteOffset, psTapFileDelayLine->m_plDirectDelays,
+		     psTapFileDelayLine->m_ppsDirectGains,
+		     psTapFileDelayLine->m_lDirectTapCount, lSampleIndex,
+		     afAccumulatorLeft, lChunk,
+		     psKernels->m_fnAccumulateTapsSpan);
+      accumulateTaps(psTapFileDelayLine->m_pfBufferRight, lBufferSize,
+		     lWriteOffset, psTapFileDelayLine->m_plDirectDelays,
+		     psTapFileDelayLine->m_ppsDirectGains,
+		     psTapFileDelayLine->m_lDirectTapCount, lSampleIndex,
+		     afAccumulatorRight, lChunk,
+		     psKernels->m_fnAccumulateTapsSpan);
+
+      // -------------------------------------------------------------
+
+      if (psConvolution != NULL) {
+	pfConvolved = (psConvolution->m_afOutputLeft
+		       + psConvolution->m_lPosition);
+	psKernels->m_fnAccumulateTapsSpan(&pfConvolved, &fOne, &fZero, 1,
+					  afAccumulatorLeft, lChunk);
+	pfConvolved = (psConvolution->m_afOutputRight
+		       + psConvolution->m_lPosition);
+	psKernels->m_fnAccumulateTapsSpan(&pfConvolved, &fOne, &fZero, 1,
+					  afAccumulatorRight, lChunk);
+	psConvolution->m_lPosition += lChunk;
+	if (psConvolution->m_lPosition == SDL_PARTITION_SIZE) {
+	  runConvolutionBlock(psConvolution,
+			      psTapFileDelayLine->m_pfBufferLeft,
+			      psTapFileDelayLine->m_pfBufferRight,
+			      lBufferSize,
+			      lWriteOffset + lChunk,
+			      psKernels->m_fnMultiplyAddSpectraSpan);
+	  psConvolution->m_lPosition = 0;
+	}
+      }
+
+      // -------------------------------------------------------------
+
+      psKernels->m_fnMixRampSpan(psTapFileDelayLine->m_pfInputLeft
+				 + lSampleIndex,
+				 afAccumulatorLeft,
+				 psTapFileDelayLine->m_pfOutputLeft
+				 + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+      psKernels->m_fnMixRampSpan(psTapFileDelayLine->m_pfInputRight
+				 + lSampleIndex,
+				 afAccumulatorRight,
+				 psTapFileDelayLine->m_pfOutputRight
+				 + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+      lWriteOffset = (lWriteOffset + lChunk) & (lBufferSize - 1);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(psWet, SampleCount);
+  psTapFileDelayLine->m_lWritePointer
+    = ((psTapFileDelayLine->m_lWritePointer + SampleCount)
+       & (lBufferSize - 1));
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding() of the tap file delay line.
+static void setRunAddingGainTapFileDelayLine(LADSPA_Handle Instance,
+					     LADSPA_Data Gain) {
+  ((TapFileDelayLine*)Instance)->m_fRunAddingGain = Gain;
+}
+
+DEFINE_ALL_RUN_FUNCTIONS(TapFileDelayLine)
+DEFINE_SELECT_RUN_FUNCTIONS(TapFileDelayLine)
+
+// -------------------------------------------------------------------
+
+// Throw away a tap file delay line.
+static void cleanupTapFileDelayLine(LADSPA_Handle Instance) {
+
+  TapFileDelayLine* psTapFileDelayLine;
+
+  // -----------------------------------------------------------------
+
+  psTapFileDelayLine = (TapFileDelayLine*)Instance;
+  deleteConvolution(psTapFileDelayLine->m_psConvolution);
+  free(psTapFileDelayLine->m_plDirectDelays);
+  free(psTapFileDelayLine->m_psDirectGains);
+  free(psTapFileDelayLine->m_ppsDirectGains);
+  free(psTapFileDelayLine->m_pfBufferLeft);
+  free(psTapFileDelayLine->m_pfBufferRight);
+  free(psTapFileDelayLine);
+}
+
+// -------------------------------------------------------------------
+
+// Return the smallest prime not below lNumber.
+static unsigned long getNextPrime(unsigned long lNumber) {
+
+  unsigned long lDivisor;
+
+  // -----------------------------------------------------------------
+
+  if (lNumber <= 2)
+    return 2;
+  for (lNumber |= 1; ; lNumber += 2) {
+    for (lDivisor = 3; lDivisor * lDivisor <= lNumber; lDivisor += 2)
+      if (lNumber % lDivisor == 0)
+	break;
+    if (lDivisor * lDivisor > lNumber)
+      return lNumber;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Construct a new instance of a feedback delay network reverb. The
+// line count is stored as the ImplementationData of the descriptor.
+// The ring buffer has room for the longest lines at the largest size.
+static LADSPA_Handle 
+instantiateFeedbackDelayNetwork(const LADSPA_Descriptor* Descriptor,
+				unsigned long SampleRate) {
+
+  FeedbackDelayNetwork* psNetwork;
+  LADSPA_Data fOutputGain;
+  unsigned long lLine;
+
+  // -----------------------------------------------------------------
+
+  psNetwork = (FeedbackDelayNetwork*)malloc(sizeof(FeedbackDelayNetwork));
+  if (psNetwork == NULL) 
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psNetwork->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psNetwork->m_lLineCount
+    = *(const unsigned long*)Descriptor->ImplementationData;
+  psNetwork->m_lFrameCount
+    = getBufferSize((unsigned long)((LADSPA_Data)SampleRate * MAX_FDN_SIZE));
+  psNetwork->m_pfFrames
+    = (LADSPA_Data*)calloc(psNetwork->m_lFrameCount * psNetwork->m_lLineCount,
+			   sizeof(LADSPA_Data));
+  if (psNetwork->m_pfFrames == NULL) {
+    free(psNetwork);
+    return NULL;
+  }
+  psNetwork->m_lWritePointer = 0;
+  psNetwork->m_fRunAddingGain = 1;
+
+  // -----------------------------------------------------------------
+
+  // The left input feeds the even lines and the right one the odd
+  // lines. The outputs take the lines with the signs of two rows of a
+  // Hadamard matrix, which keeps them apart from each other and from
+  // the sum of all lines the Householder matrix inverts.
+  fOutputGain = (LADSPA_Data)(1 / sqrt((double)psNetwork->m_lLineCount));
+  memset(psNetwork->m_afInputLeft, 0, sizeof(psNetwork->m_afInputLeft));
+  memset(psNetwork->m_afInputRight, 0, sizeof(psNetwork->m_afInputRight));
+  memset(psNetwork->m_afOutputLeft, 0, sizeof(psNetwork->m_afOutputLeft));
+  memset(psNetwork->m_afOutputRight, 0, sizeof(psNetwork->m_afOutputRight));
+  for (lLine = 0; lLine < psNetwork->m_lLineCount; lLine++) {
+    if (lLine & 1)
+      psNetwork->m_afInputRight[lLine] = 1;
+    else
+      psNetwork->m_afInputLeft[lLine] = 1;
+    psNetwork->m_afOutputLeft[lLine]
+      = (lLine & 2) ? -fOutputGain : fOutputGain;
+    psNetwork->m_afOutputRight[lLine]
+      = (lLine & 1) ? -fOutputGain : fOutputGain;
+  }
+
+  // -----------------------------------------------------------------
+
+  return psNetwork;
+}
+
+// -------------------------------------------------------------------
+
+// Initialise and activate an instance of a feedback delay network
+// reverb. The lines are set up in the first run.
+static void activateFeedbackDelayNetwork(LADSPA_Handle Instance) {
+
+  FeedbackDelayNetwork* psNetwork;
+
+  // -----------------------------------------------------------------
+
+  psNetwork = (FeedbackDelayNetwork*)Instance;
+  memset(psNetwork->m_pfFrames,
+	 0,
+	 (sizeof(LADSPA_Data)
+	  * psNetwork->m_lFrameCount * psNetwork->m_lLineCount));
+  memset(psNetwork->m_afFilterStates,
+	 0,
+	 sizeof(psNetwork->m_afFilterStates));
+
+  // -----------------------------------------------------------------
+
+  psNetwork->m_lSilentSamples = 0;
+  psNetwork->m_iCleared = 1;
+  psNetwork->m_fSize = -1;
+  psNetwork->m_fDecayTime = -1;
+  psNetwork->m_fDamping = -1;
+  resetSmoothedGain(&psNetwork->m_sWet);
+}
+
+// -------------------------------------------------------------------
+
+// Connect a port of a feedback delay network reverb to a data
+// location.
+static void 
+connectPortToFeedbackDelayNetwork(LADSPA_Handle Instance,
+				  unsigned long Port,
+				  LADSPA_Data* DataLocation) {
+
+  FeedbackDelayNetwork* psNetwork;
+
+  // -----------------------------------------------------------------
+
+  psNetwork = (FeedbackDelayNetwork*)Instance;
+
+  // -----------------------------------------------------------------
+
+  switch (Port) {
+  case SDL_FDN_SIZE:
+    psNetwork->m_pfSize = DataLocation;
+    break;
+  case SDL_FDN_DECAY_TIME:
+    psNetwork->m_pfDecayTime = DataLocation;
+    break;
+  case SDL_FDN_DAMPING:
+    psNetwork->m_pfDamping = DataLocation;
+    break;
+  case SDL_FDN_DRY_WET:
+    psNetwork->m_pfDryWet = DataLocation;
+    break;
+  case SDL_FDN_INPUT_LEFT:
+    psNetwork->m_pfInputLeft = DataLocation;
+    break;
+  case SDL_FDN_INPUT_RIGHT:
+    psNetwork->m_pfInputRight = DataLocation;
+    break;
+  case SDL_FDN_OUTPUT_LEFT:
+    psNetwork->m_pfOutputLeft = DataLocation;
+    break;
+  case SDL_FDN_OUTPUT_RIGHT:
+    psNetwork->m_pfOutputRight = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Set up the damping filter of a line fed back into itself after
+// dDelay samples. The one-pole low-pass has a gain at 0 Hz which makes
+// a signal decay by 60 dB within the decay time, however often it
+// passes the line. At the Nyquist frequency, the gain does the same
+// for a decay time shortened by the damping.
+//
+// Returns the gain at 0 Hz.
+static double setupDecayFilter(double dDelay,
+			       LADSPA_Data fDecayTime,
+			       LADSPA_Data fDamping,
+			       LADSPA_Data fSampleRate,
+			       LADSPA_Data* pfFilterGain,
+			       LADSPA_Data* pfFilterPole) {
+
+  double dGain;
+  double dDampedRatio;
+  double dPole;
+
+  // -----------------------------------------------------------------
+
+  dGain = pow(10, -3.0 * dDelay / (fDecayTime * fSampleRate));
+  dDampedRatio = pow(dGain, 1 / (1 - SDL_FDN_MAX_DAMPING * fDamping) - 1);
+  dPole = (1 - dDampedRatio) / (1 + dDampedRatio);
+  *pfFilterGain = (LADSPA_Data)(dGain * (1 - dPole));
+  *pfFilterPole = (LADSPA_Data)dPole;
+  return dGain;
+}
+
+// -------------------------------------------------------------------
+
+// Follow the size, decay time and damping controls of a feedback
+// delay network reverb.
+//
+// The delays are distinct primes, and so mutually prime, spread
+// between SDL_FDN_SHORTEST times the size and the size. A change of
+// the size makes the reads jump like a change of the delay of
+// c_delay_5s_stereo.
+static void updateFeedbackDelayNetwork(FeedbackDelayNetwork* psNetwork) {
+
+  LADSPA_Data fSize;
+  LADSPA_Data fDecayTime;
+  LADSPA_Data fDamping;
+  double dTarget;
+  unsigned long lDelay;
+  unsigned long lLine;
+  unsigned long lLineCount;
+
+  // -----------------------------------------------------------------
+
+  lLineCount = psNetwork->m_lLineCount;
+  fSize = LIMIT_BETWEEN_MIN_AND_MAX_FDN_SIZE(*(psNetwork->m_pfSize));
+  fDecayTime
+    = LIMIT_BETWEEN_MIN_AND_MAX_DECAY_TIME(*(psNetwork->m_pfDecayTime));
+  fDamping = LIMIT_BETWEEN_0_AND_1(*(psNetwork->m_pfDamping));
+
+  // -----------------------------------------------------------------
+
+  if (fSize != psNetwork->m_fSize) {
+    psNetwork->m_fSize = fSize;
+    psNetwork->m_fDecayTime = -1;
+    lDelay = 0;
+    for (lLine = 0; lLine < lLineCount; lLine++) {
+      dTarget = (fSize * psNetwork->m_fSampleRate
+		 * pow(SDL_FDN_SHORTEST,
+		       ((double)(lLineCount - 1 - lLine)
+			/ (lLineCount - 1))));
+      if ((double)(lDelay + 1) > dTarget)
+	lDelay = getNextPrime(lDelay + 1);
+      else
+	lDelay = getNextPrime((unsigned long)dTarget);
+      psNetwork->m_alDelays[lLine] = lDelay;
+      psNetwork->m_afReadIndices[lLine]
+	= (LADSPA_Data)lLine - (LADSPA_Data)(lDelay * lLineCount);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  if (fDecayTime != psNetwork->m_fDecayTime
+      || fDamping != psNetwork->m_fDamping) {
+    psNetwork->m_fDecayTime = fDecayTime;
+    psNetwork->m_fDamping = fDamping;
+    for (lLine = 0; lLine < lLineCount; lLine++)
+      setupDecayFilter((double)psNetwork->m_alDelays[lLine],
+		       fDecayTime, fDamping, psNetwork->m_fSampleRate,
+		       &psNetwork->m_afFilterGains[lLine],
+		       &psNetwork->m_afFilterPoles[lLine]);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run an instance of a feedback delay network reverb for a block of
+// SampleCount samples using the provided set of kernels. The output
+// is scaled by fGain.
+//
+// The lines are run in chunks into scratch buffers, which are mixed
+// with the dry input. Once the input has been silent long enough for
+// the tail to die away, the lines are cleared and left alone until
+// the input returns.
+static inline void
+runFeedbackDelayNetworkWithKernels(LADSPA_Handle Instance,
+				   unsigned long SampleCount,
+				   const SimpleDelayKernels* psKernels,
+				   LADSPA_Data fGain) {
+
+  LADSPA_Data afWetLeft[SDL_CHUNK_SIZE];
+  LADSPA_Data afWetRight[SDL_CHUNK_SIZE];
+  FeedbackDelayNetwork* psNetwork;
+  FdnSpanFunction fnFdnSpan;
+  SmoothedGain* psWet;
+  LADSPA_Data fWet;
+  LADSPA_Data fWetIncrement;
+  unsigned long lChunk;
+  unsigned long lSampleIndex;
+  unsigned long lTail;
+  unsigned long lTrailingSilence;
+  unsigned long lTrailingSilenceRight;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+
+  psNetwork = (FeedbackDelayNetwork*)Instance;
+  psWet = &psNetwork->m_sWet;
+  updateFeedbackDelayNetwork(psNetwork);
+  setSmoothedGainTarget(psWet,
+			LIMIT_BETWEEN_0_AND_1(*(psNetwork->m_pfDryWet)),
+			(unsigned long)(SMOOTHING_TIME
+					* psNetwork->m_fSampleRate));
+  fnFdnSpan
+    = psKernels->m_afnFdnSpan[psNetwork->m_lLineCount == SDL_MAX_FDN_LINES];
+  lTail = ((unsigned long)(SDL_FDN_TAIL_DECAYS
+			   * psNetwork->m_fDecayTime
+			   * psNetwork->m_fSampleRate)
+	   + psNetwork->m_alDelays[psNetwork->m_lLineCount - 1]);
+
+  // -----------------------------------------------------------------
+
+  lTrailingSilence
+    = psKernels->m_fnCountTrailingSilence(psNetwork->m_pfInputLeft,
+					  SampleCount);
+  lTrailingSilenceRight
+    = psKernels->m_fnCountTrailingSilence(psNetwork->m_pfInputRight,
+					  SampleCount);
+  if (lTrailingSilence > lTrailingSilenceRight)
+    lTrailingSilence = lTrailingSilenceRight;
+  if (lTrailingSilence == SampleCount
+      && (psNetwork->m_iCleared || psNetwork->m_lSilentSamples >= lTail)) {
+    if (!psNetwork->m_iCleared) {
+      memset(psNetwork->m_pfFrames,
+	     0,
+	     (sizeof(LADSPA_Data)
+	      * psNetwork->m_lFrameCount * psNetwork->m_lLineCount));
+      memset(psNetwork->m_afFilterStates,
+	     0,
+	     sizeof(psNetwork->m_afFilterStates));
+      psNetwork->m_iCleared = 1;
+    }
+    psKernels->m_fnSilenceSpan(psNetwork->m_pfInputLeft,
+			       psNetwork->m_pfOutputLeft,
+			       SampleCount);
+    psKernels->m_fnSilenceSpan(psNetwork->m_pfInputRight,
+			       psNetwork->m_pfOutputRight,
+			       SampleCount);
+  } else {
+
+    // ---------------------------------------------------------------
+
+    psNetwork->m_iCleared = 0;
+    countSilentSamples(&psNetwork->m_lSilentSamples,
+		       lTrailingSilence, lTail, SampleCount);
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      if (psWet->m_lRemaining > lSampleIndex) {
+	if (lChunk > psWet->m_lRemaining - lSampleIndex)
+	  lChunk = psWet->m_lRemaining - lSampleIndex;
+	fWet = psWet->m_fValue + psWet->m_fIncrement * lSampleIndex;
+	fWetIncrement = psWet->m_fIncrement;
+      } else {
+	fWet = psWet->m_fTarget;
+	fWetIncrement = 0;
+      }
+      fnFdnSpan(psNetwork->m_pfInputLeft + lSampleIndex,
+		psNetwork->m_pfInputRight + lSampleIndex,
+		afWetLeft,
+		afWetRight,
+		psNetwork,
+		lChunk);
+      psKernels->m_fnMixRampSpan(psNetwork->m_pfInputLeft + lSampleIndex,
+				 afWetLeft,
+				 psNetwork->m_pfOutputLeft + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+      psKernels->m_fnMixRampSpan(psNetwork->m_pfInputRight + lSampleIndex,
+				 afWetRight,
+				 psNetwork->m_pfOutputRight + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(psWet, SampleCount);
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding() of a feedback delay network
+// reverb.
+static void setRunAddingGainFeedbackDelayNetwork(LADSPA_Handle Instance,
+						 LADSPA_Data Gain) {
+  ((FeedbackDelayNetwork*)Instance)->m_fRunAddingGain = Gain;
+}
+
+DEFINE_ALL_RUN_FUNCTIONS(FeedbackDelayNetwork)
+DEFINE_SELECT_RUN_FUNCTIONS(FeedbackDelayNetwork)
+
+// -------------------------------------------------------------------
+
+// Throw away a feedback delay network reverb.
+static void cleanupFeedbackDelayNetwork(LADSPA_Handle Instance) {
+
+  FeedbackDelayNetwork* psNetwork;
+
+  // -----------------------------------------------------------------
+
+  psNetwork = (FeedbackDelayNetwork*)Instance;
+  free(psNetwork->m_pfFrames);
+  free(psNetwork);
+}
+
+// -------------------------------------------------------------------
+
+// Frequency (in Hz) of a MIDI note number.
+static double getNoteFrequency(LADSPA_Data fNote) {
+  return 440 * pow(2, (fNote - 69) / 12.0);
+}
+
+// Interval (in semitones) between the root note and comb lComb of a
+// comb filter bank in the tuning lTuning. The first comb is always
+// tuned to the root note and the others lie above it.
+static double getCombInterval(unsigned long lTuning, unsigned long lComb) {
+
+  static const double adMajor[3] = { 0, 4, 7 };
+  static const double adMinor[3] = { 0, 3, 7 };
+
+  // -----------------------------------------------------------------
+
+  switch (lTuning) {
+  case SDL_TUNING_FIFTHS:
+    return 12.0 * (lComb / 2) + 7.0 * (lComb % 2);
+  case SDL_TUNING_MAJOR:
+    return 12.0 * (lComb / 3) + adMajor[lComb % 3];
+  case SDL_TUNING_MINOR:
+    return 12.0 * (lComb / 3) + adMinor[lComb % 3];
+  default:
+    return 12 * log((double)(lComb + 1)) / log(2.0);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Construct a new instance of a comb filter bank. The comb count is
+// stored as the ImplementationData of the descriptor. The ring buffer
+// has room for the longest comb at the lowest root note and the one
+// sample more its interpolation reads.
+static LADSPA_Handle 
+instantiateCombFilterBank(const LADSPA_Descriptor* Descriptor,
+			  unsigned long SampleRate) {
+
+  CombFilterBank* psBank;
+
+  // -----------------------------------------------------------------
+
+  psBank = (CombFilterBank*)malloc(sizeof(CombFilterBank));
+  if (psBank == NULL) 
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psBank->m_fSampleRate = (LADSPA_Data)SampleRate;
+  psBank->m_lCombCount = *(const unsigned long*)Descriptor->ImplementationData;
+  psBank->m_lFrameCount = 1;
+  while (psBank->m_lFrameCount
+	 < SampleRate / getNoteFrequency(MIN_ROOT_NOTE) + 2)
+    psBank->m_lFrameCount <<= 1;
+  psBank->m_pfFrames
+    = (LADSPA_Data*)calloc(psBank->m_lFrameCount * psBank->m_lCombCount,
+			   sizeof(LADSPA_Data));
+  if (psBank->m_pfFrames == NULL) {
+    free(psBank);
+    return NULL;
+  }
+  psBank->m_lWritePointer = 0;
+  psBank->m_fRunAddingGain = 1;
+
+  // -----------------------------------------------------------------
+
+  return psBank;
+}
+
+// -------------------------------------------------------------------
+
+// Initialise and activate an instance of a comb filter bank. The
+// combs are set up in the first run.
+static void activateCombFilterBank(LADSPA_Handle Instance) {
+
+  CombFilterBank* psBank;
+
+  // -----------------------------------------------------------------
+
+  psBank = (CombFilterBank*)Instance;
+  memset(psBank->m_pfFrames,
+	 0,
+	 sizeof(LADSPA_Data) * psBank->m_lFrameCount * psBank->m_lCombCount);
+  memset(psBank->m_afFilterStates, 0, sizeof(psBank->m_afFilterStates));
+
+  // -----------------------------------------------------------------
+
+  psBank->m_lSilentSamples = 0;
+  psBank->m_iCleared = 1;
+  psBank->m_fRootNote = -1;
+  psBank->m_lTuning = 0;
+  psBank->m_fDecayTime = -1;
+  psBank->m_fDamping = -1;
+  resetSmoothedGain(&psBank->m_sWet);
+}
+
+// -------------------------------------------------------------------
+
+// Connect a port of a comb filter bank to a data location.
+static void 
+connectPortToCombFilterBank(LADSPA_Handle Instance,
+			    unsigned long Port,
+			    LADSPA_Data* DataLocation) {
+
+  CombFilterBank* psBank;
+
+  // -----------------------------------------------------------------
+
+  psBank = (CombFilterBank*)Instance;
+
+  // -----------------------------------------------------------------
+
+  switch (Port) {
+  case SDL_COMB_ROOT_NOTE:
+    psBank->m_pfRootNote = DataLocation;
+    break;
+  case SDL_COMB_TUNING:
+    psBank->m_pfTuning = DataLocation;
+    break;
+  case SDL_COMB_DECAY_TIME:
+    psBank->m_pfDecayTime = DataLocation;
+    break;
+  case SDL_COMB_DAMPING:
+    psBank->m_pfDamping = DataLocation;
+    break;
+  case SDL_COMB_DRY_WET:
+    psBank->m_pfDryWet = DataLocation;
+    break;
+  case SDL_COMB_INPUT_LEFT:
+    psBank->m_pfInputLeft = DataLocation;
+    break;
+  case SDL_COMB_INPUT_RIGHT:
+    psBank->m_pfInputRight = DataLocation;
+    break;
+  case SDL_COMB_OUTPUT_LEFT:
+    psBank->m_pfOutputLeft = DataLocation;
+    break;
+  case SDL_COMB_OUTPUT_RIGHT:
+    psBank->m_pfOutputRight = DataLocation;
+    break;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Follow the root note, tuning, decay time and damping controls of a
+// comb filter bank.
+//
+// Each comb is tuned to the root note raised by its interval, which
+// makes the first comb the longest one. A change of the tuning makes
+// the reads jump like a change of the delay of c_delay_5s_stereo.
+//
+// The combs are damped like the lines of the feedback delay network,
+// so they all ring for the same time. The even combs go to the left
+// output and the odd ones to the right. Their gains make up for the
+// resonance of the feedback, so that each comb passes on about as
+// much energy as it is fed with, whatever the decay time.
+static void updateCombFilterBank(CombFilterBank* psBank) {
+
+  LADSPA_Data fRootNote;
+  LADSPA_Data fDecayTime;
+  LADSPA_Data fDamping;
+  LADSPA_Data fOutputGain;
+  double dDelay;
+  double dGain;
+  double dRootFrequency;
+  unsigned long lComb;
+  unsigned long lCombCount;
+  unsigned long lTuning;
+
+  // -----------------------------------------------------------------
+
+  lCombCount = psBank->m_lCombCount;
+  fRootNote = LIMIT_BETWEEN_MIN_AND_MAX_ROOT_NOTE(*(psBank->m_pfRootNote));
+  lTuning
+    = (unsigned long)(LIMIT_BETWEEN_0_AND_MINOR(*(psBank->m_pfTuning))
+		      + 0.5f);
+  fDecayTime
+    = LIMIT_BETWEEN_MIN_AND_MAX_DECAY_TIME(*(psBank->m_pfDecayTime));
+  fDamping = LIMIT_BETWEEN_0_AND_1(*(psBank->m_pfDamping));
+
+  // -----------------------------------------------------------------
+
+  if (fRootNote != psBank->m_fRootNote || lTuning != psBank->m_lTuning) {
+    psBank->m_fRootNote = fRootNote;
+    psBank->m_lTuning = lTuning;
+    psBank->m_fDecayTime = -1;
+    dRootFrequency = getNoteFrequency(fRootNote);
+    for (lComb = 0; lComb < lCombCount; lComb++) {
+      dDelay = (psBank->m_fSampleRate
+		/ (dRootFrequency
+		   * pow(2, getCombInterval(lTuning, lComb) / 12)));
+      if (dDelay < SDL_MIN_COMB_DELAY) {
+	psBank->m_afDelays[lComb] = 0;
+	dDelay = SDL_MIN_COMB_DELAY;
+      } else {
+	psBank->m_afDelays[lComb] = (LADSPA_Data)dDelay;
+      }
+      psBank->m_alDelays[lComb] = (unsigned long)dDelay;
+      psBank->m_afFractions[lComb]
+	= (LADSPA_Data)(dDelay - psBank->m_alDelays[lComb]);
+      psBank->m_afReadIndices[lComb]
+	= ((LADSPA_Data)lComb
+	   - (LADSPA_Data)(psBank->m_alDelays[lComb] * lCombCount));
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  if (fDecayTime != psBank->m_fDecayTime
+      || fDamping != psBank->m_fDamping) {
+    psBank->m_fDecayTime = fDecayTime;
+    psBank->m_fDamping = fDamping;
+    fOutputGain = (LADSPA_Data)(1 / sqrt(lCombCount / 2.0));
+    for (lComb = 0; lComb < lCombCount; lComb++) {
+      psBank->m_afOutputLeft[lComb] = 0;
+      psBank->m_afOutputRight[lComb] = 0;
+      if (psBank->m_afDelays[lComb] == 0) {
+	psBank->m_afFilterGains[lComb] = 0;
+	psBank->m_afFilterPoles[lComb] = 0;
+	continue;
+      }
+      dGain = setupDecayFilter(psBank->m_afDelays[lComb],
+			       fDecayTime, fDamping, psBank->m_fSampleRate,
+			       &psBank->m_afFilterGains[lComb],
+			       &psBank->m_afFilterPoles[lComb]);
+      if (lComb & 1)
+	psBank->m_afOutputRight[lComb]
+	  = fOutputGain * (LADSPA_Data)sqrt(1 - dGain * dGain);
+      else
+	psBank->m_afOutputLeft[lComb]
+	  = fOutputGain * (LADSPA_Data)sqrt(1 - dGain * dGain);
+    }
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Run an instance of a comb filter bank for a block of SampleCount
+// samples using the provided set of kernels. The output is scaled by
+// fGain.
+//
+// The combs are run and left alone while the input is silent just
+// like the lines of the feedback delay network.
+static inline void
+runCombFilterBankWithKernels(LADSPA_Handle Instance,
+			     unsigned long SampleCount,
+			     const SimpleDelayKernels* psKernels,
+			     LADSPA_Data fGain) {
+
+  LADSPA_Data afWetLeft[SDL_CHUNK_SIZE];
+  LADSPA_Data afWetRight[SDL_CHUNK_SIZE];
+  CombFilterBank* psBank;
+  CombSpanFunction fnCombSpan;
+  SmoothedGain* psWet;
+  LADSPA_Data fWet;
+  LADSPA_Data fWetIncrement;
+  unsigned long lChunk;
+  unsigned long lSampleIndex;
+  unsigned long lTail;
+  unsigned long lTrailingSilence;
+  unsigned long lTrailingSilenceRight;
+  SDL_BEGIN_DENORMAL_PROTECTION;
+
+  // -----------------------------------------------------------------
+
+  psBank = (CombFilterBank*)Instance;
+  psWet = &psBank->m_sWet;
+  updateCombFilterBank(psBank);
+  setSmoothedGainTarget(psWet,
+			LIMIT_BETWEEN_0_AND_1(*(psBank->m_pfDryWet)),
+			(unsigned long)(SMOOTHING_TIME
+					* psBank->m_fSampleRate));
+  fnCombSpan
+    = psKernels->m_afnCombSpan[((psBank->m_lCombCount > 8)
+				+ (psBank->m_lCombCount > 16))];
+  lTail = ((unsigned long)(SDL_FDN_TAIL_DECAYS
+			   * psBank->m_fDecayTime
+			   * psBank->m_fSampleRate)
+	   + psBank->m_alDelays[0] + 1);
+
+  // -----------------------------------------------------------------
+
+  lTrailingSilence
+    = psKernels->m_fnCountTrailingSilence(psBank->m_pfInputLeft,
+					  SampleCount);
+  lTrailingSilenceRight
+    = psKernels->m_fnCountTrailingSilence(psBank->m_pfInputRight,
+					  SampleCount);
+  if (lTrailingSilence > lTrailingSilenceRight)
+    lTrailingSilence = lTrailingSilenceRight;
+  if (lTrailingSilence == SampleCount
+      && (psBank->m_iCleared || psBank->m_lSilentSamples >= lTail)) {
+    if (!psBank->m_iCleared) {
+      memset(psBank->m_pfFrames,
+	     0,
+	     (sizeof(LADSPA_Data)
+	      * psBank->m_lFrameCount * psBank->m_lCombCount));
+      memset(psBank->m_afFilterStates,
+	     0,
+	     sizeof(psBank->m_afFilterStates));
+      psBank->m_iCleared = 1;
+    }
+    psKernels->m_fnSilenceSpan(psBank->m_pfInputLeft,
+			       psBank->m_pfOutputLeft,
+			       SampleCount);
+    psKernels->m_fnSilenceSpan(psBank->m_pfInputRight,
+			       psBank->m_pfOutputRight,
+			       SampleCount);
+  } else {
+
+    // ---------------------------------------------------------------
+
+    psBank->m_iCleared = 0;
+    countSilentSamples(&psBank->m_lSilentSamples,
+		       lTrailingSilence, lTail, SampleCount);
+    for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex += lChunk) {
+      lChunk = SampleCount - lSampleIndex;
+      if (lChunk > SDL_CHUNK_SIZE)
+	lChunk = SDL_CHUNK_SIZE;
+      if (psWet->m_lRemaining > lSampleIndex) {
+	if (lChunk > psWet->m_lRemaining - lSampleIndex)
+	  lChunk = psWet->m_lRemaining - lSampleIndex;
+	fWet = psWet->m_fValue + psWet->m_fIncrement * lSampleIndex;
+	fWetIncrement = psWet->m_fIncrement;
+      } else {
+	fWet = psWet->m_fTarget;
+	fWetIncrement = 0;
+      }
+      fnCombSpan(psBank->m_pfInputLeft + lSampleIndex,
+		 psBank->m_pfInputRight + lSampleIndex,
+		 afWetLeft,
+		 afWetRight,
+		 psBank,
+		 lChunk);
+      psKernels->m_fnMixRampSpan(psBank->m_pfInputLeft + lSampleIndex,
+				 afWetLeft,
+				 psBank->m_pfOutputLeft + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+      psKernels->m_fnMixRampSpan(psBank->m_pfInputRight + lSampleIndex,
+				 afWetRight,
+				 psBank->m_pfOutputRight + lSampleIndex,
+				 fWet, fWetIncrement, fGain, lChunk);
+    }
+  }
+
+  // -----------------------------------------------------------------
+
+  advanceSmoothedGain(psWet, SampleCount);
+
+  SDL_END_DENORMAL_PROTECTION;
+}
+
+// -------------------------------------------------------------------
+
+// Set the gain applied by run_adding() of a comb filter bank.
+static void setRunAddingGainCombFilterBank(LADSPA_Handle Instance,
+					   LADSPA_Data Gain) {
+  ((CombFilterBank*)Instance)->m_fRunAddingGain = Gain;
+}
+
+DEFINE_ALL_RUN_FUNCTIONS(CombFilterBank)
+DEFINE_SELECT_RUN_FUNCTIONS(CombFilterBank)
+
+// -------------------------------------------------------------------
+
+// Throw away a comb filter bank.
+static void cleanupCombFilterBank(LADSPA_Handle Instance) {
+
+  CombFilterBank* psBank;
+
+  // -----------------------------------------------------------------
+
+  psBank = (CombFilterBank*)Instance;
+  free(psBank->m_pfFrames);
+  free(psBank);
+}
+
+// -------------------------------------------------------------------
+
+// All descriptors of the library in the order ladspa_descriptor()
+// hands them out. The first g_lDescriptorCount entries are in use.
+#define SDL_MAX_DESCRIPTORS 32
+static LADSPA_Descriptor* g_apsDescriptors[SDL_MAX_DESCRIPTORS] = { NULL };
+static unsigned long g_lDescriptorCount = 0;
+
+// The unique IDs of the families of plugins below are assigned from
+// these bases, one per descriptor. Once released, an ID must never
+// change, so a family growing into the range of the next one has to
+// be given a new base.
+#define SDL_MULTI_UNIQUE_ID 406
+#define SDL_MULTI_TAP_UNIQUE_ID 411
+#define SDL_TAP_FILE_UNIQUE_ID 413
+#define SDL_FDN_UNIQUE_ID 414
+#define SDL_COMB_UNIQUE_ID 416
+#define SDL_REVERSE_UNIQUE_ID 419
+#define SDL_PITCH_SHIFT_UNIQUE_ID 420
+
+// The N-channel delay lines come with these channel counts.
+#define SDL_MULTI_DESCRIPTOR_COUNT 5
+static const unsigned long
+g_alMultiChannelCounts[SDL_MULTI_DESCRIPTOR_COUNT] = { 1, 2, 6, 8, 16 };
+
+// The multi-tap delay lines come with these tap counts.
+#define SDL_MULTI_TAP_DESCRIPTOR_COUNT 2
+static const unsigned long
+g_alMultiTapCounts[SDL_MULTI_TAP_DESCRIPTOR_COUNT] = { 8, SDL_MAX_TAPS };
+
+// The feedback delay network reverbs come with these line counts.
+#define SDL_FDN_DESCRIPTOR_COUNT 2
+static const unsigned long
+g_alFdnLineCounts[SDL_FDN_DESCRIPTOR_COUNT] = { 8, SDL_MAX_FDN_LINES };
+
+// The comb filter banks come with these comb counts.
+#define SDL_COMB_DESCRIPTOR_COUNT 3
+static const unsigned long
+g_alCombCounts[SDL_COMB_DESCRIPTOR_COUNT] = { 8, 16, SDL_MAX_COMBS };
+
+// The port numbers of the chorus flavour mapped to the ones of the
+// instance.
+static const unsigned long g_alChorusPortRoles[SDL_CHORUS_PORT_COUNT] = {
+  SDL_DELAY_LENGTH_LEFT,
+  SDL_DELAY_LENGTH_RIGHT,
+  SDL_DRY_WET_LEFT,
+  SDL_DRY_WET_RIGHT,
+  SDL_INPUT_LEFT,
+  SDL_INPUT_RIGHT,
+  SDL_OUTPUT_LEFT,
+  SDL_OUTPUT_RIGHT,
+  SDL_INTERPOLATION,
+  SDL_DELAY_CHANGE,
+  SDL_CROSSFADE_TIME,
+  SDL_GLIDE_RATE,
+  SDL_LFO_RATE,
+  SDL_LFO_DEPTH,
+  SDL_LFO_SHAPE,
+  SDL_LFO_STEREO_PHASE
+};
+
+// The port numbers of the echo flavour mapped to the ones of the
+// instance.
+static const unsigned long g_alEchoPortRoles[SDL_ECHO_PORT_COUNT] = {
+  SDL_DELAY_LENGTH_LEFT,
+  SDL_DELAY_LENGTH_RIGHT,
+  SDL_DRY_WET_LEFT,
+  SDL_DRY_WET_RIGHT,
+  SDL_INPUT_LEFT,
+  SDL_INPUT_RIGHT,
+  SDL_OUTPUT_LEFT,
+  SDL_OUTPUT_RIGHT,
+  SDL_INTERPOLATION,
+  SDL_DELAY_CHANGE,
+  SDL_CROSSFADE_TIME,
+  SDL_GLIDE_RATE,
+  SDL_FEEDBACK,
+  SDL_FEEDBACK_LOW_PASS,
+  SDL_FEEDBACK_HIGH_PASS,
+  SDL_SATURATION
+};
+
+// The port numbers of the ping-pong flavour mapped to the ones of the
+// instance.
+static const unsigned long g_alPingPongPortRoles[SDL_PING_PONG_PORT_COUNT] = {
+  SDL_DELAY_LENGTH_LEFT,
+  SDL_DELAY_LENGTH_RIGHT,
+  SDL_DRY_WET_LEFT,
+  SDL_DRY_WET_RIGHT,
+  SDL_INPUT_LEFT,
+  SDL_INPUT_RIGHT,
+  SDL_OUTPUT_LEFT,
+  SDL_OUTPUT_RIGHT,
+  SDL_INTERPOLATION,
+  SDL_DELAY_CHANGE,
+  SDL_CROSSFADE_TIME,
+  SDL_GLIDE_RATE,
+  SDL_FEEDBACK,
+  SDL_FEEDBACK_LOW_PASS,
+  SDL_FEEDBACK_HIGH_PASS,
+  SDL_SATURATION,
+  SDL_CROSS_FEEDBACK
+};
+
+// The port numbers of the reverse flavour mapped to the ones of the
+// instance.
+static const unsigned long g_alReversePortRoles[SDL_REVERSE_PORT_COUNT] = {
+  SDL_DELAY_LENGTH_LEFT,
+  SDL_DELAY_LENGTH_RIGHT,
+  SDL_DRY_WET_LEFT,
+  SDL_DRY_WET_RIGHT,
+  SDL_INPUT_LEFT,
+  SDL_INPUT_RIGHT,
+  SDL_OUTPUT_LEFT,
+  SDL_OUTPUT_RIGHT,
+  SDL_REVERSE
+};
+
+// The port numbers of the pitch shifting flavour mapped to the ones
+// of the instance.
+static const unsigned long g_alPitchShiftPortRoles[SDL_PITCH_PORT_COUNT] = {
+  SDL_DELAY_LENGTH_LEFT,
+  SDL_DELAY_LENGTH_RIGHT,
+  SDL_DRY_WET_LEFT,
+  SDL_DRY_WET_RIGHT,
+  SDL_INPUT_LEFT,
+  SDL_INPUT_RIGHT,
+  SDL_OUTPUT_LEFT,
+  SDL_OUTPUT_RIGHT,
+  SDL_PITCH_SHIFT,
+  SDL_FOUR_READ_HEADS
+};
+
+// -------------------------------------------------------------------
+
+// Fill the table of the window of the pitch shifting flavour.
+static void fillPitchWindow(void) {
+
+  unsigned long lIndex;
+  double dSine;
+
+  // -----------------------------------------------------------------
+
+  for (lIndex = 0; lIndex < SDL_PITCH_WINDOW_SIZE; lIndex++) {
+    dSine = sin(M_PI * lIndex / SDL_PITCH_WINDOW_SIZE);
+    g_afPitchWindow[lIndex] = (LADSPA_Data)(dSine * dSine);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Allocate a descriptor of a delay line plugin with lPortCount ports,
+// each of which still has to be described by describePort().
+static LADSPA_Descriptor* createDescriptor(unsigned long lUniqueID,
+					   const char* pcLabel,
+					   const char* pcName,
+					   unsigned long lPortCount) {
+
+  LADSPA_Descriptor* psDescriptor;
 
   // -----------------------------------------------------------------
   
-  lBufferSizeMinusOne = psSimpleDelayLine->m_lBufferSize - 1;
-  
+  psDescriptor
+    = (LADSPA_Descriptor*)malloc(sizeof(LADSPA_Descriptor));
+  if (psDescriptor == NULL)
+    return NULL;
+
   // -----------------------------------------------------------------
   
-  lDelayLeft = (unsigned long)
-    (LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psSimpleDelayLine->m_pfDelayLeft)) 
-     * psSimpleDelayLine->m_fSampleRate);
-  lDelayRight = (unsigned long)
-    (LIMIT_BETWEEN_0_AND_MAX_DELAY(*(psSimpleDelayLine->m_pfDelayRight))
-     * psSimpleDelayLine->m_fSampleRate);
+  psDescriptor->UniqueID
+    = lUniqueID;
+  psDescriptor->Label
+    = strdup(pcLabel);
+  psDescriptor->Properties
+    = LADSPA_PROPERTY_HARD_RT_CAPABLE;
+  psDescriptor->Name 
+    = strdup(pcName);
+  psDescriptor->Maker
+    = strdup("Richard Furse (LADSPA example plugins)");
+  psDescriptor->Copyright
+    = strdup("None");
+  psDescriptor->PortCount 
+    = lPortCount;
+  psDescriptor->PortDescriptors
+    = ((const LADSPA_PortDescriptor*)
+       calloc(lPortCount, sizeof(LADSPA_PortDescriptor)));
+  psDescriptor->PortNames
+    = (const char **)calloc(lPortCount, sizeof(char *));
+  psDescriptor->PortRangeHints
+    = ((const LADSPA_PortRangeHint*)
+       calloc(lPortCount, sizeof(LADSPA_PortRangeHint)));
+  psDescriptor->ImplementationData
+    = NULL;
 
   // -----------------------------------------------------------------
-  
-  pfInputLeft = psSimpleDelayLine->m_pfInputLeft;
-  pfInputRight = psSimpleDelayLine->m_pfInputRight;
-  
+        
+  psDescriptor->instantiate
+    = instantiateSimpleDelayLine;
+  psDescriptor->connect_port 
+    = connectPortToSimpleDelayLine;
+  psDescriptor->activate
+    = activateSimpleDelayLine;
+  selectSimpleDelayLineRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainSimpleDelayLine;
+  psDescriptor->deactivate
+    = NULL;
+  psDescriptor->cleanup
+    = cleanupSimpleDelayLine;
+
   // -----------------------------------------------------------------
   
-  pfOutputLeft = psSimpleDelayLine->m_pfOutputLeft;
-  pfOutputRight = psSimpleDelayLine->m_pfOutputRight;
-  
+  return psDescriptor;
+}
+
+// -------------------------------------------------------------------
+
+// Describe port lPort of a descriptor allocated by createDescriptor().
+static void describePort(LADSPA_Descriptor* psDescriptor,
+			 unsigned long lPort,
+			 LADSPA_PortDescriptor iPortDescriptor,
+			 const char* pcName,
+			 LADSPA_PortRangeHintDescriptor iHintDescriptor,
+			 LADSPA_Data fLowerBound,
+			 LADSPA_Data fUpperBound) {
+
+  LADSPA_PortRangeHint* psPortRangeHint;
+
   // -----------------------------------------------------------------
   
-  pfBufferLeft = psSimpleDelayLine->m_pfBufferLeft;
-  pfBufferRight = psSimpleDelayLine->m_pfBufferRight;
-  
+  ((LADSPA_PortDescriptor*)psDescriptor->PortDescriptors)[lPort]
+    = iPortDescriptor;
+  ((char**)psDescriptor->PortNames)[lPort]
+    = strdup(pcName);
+
   // -----------------------------------------------------------------
   
-  lBufferWriteOffset = psSimpleDelayLine->m_lWritePointer;
-  
+  psPortRangeHint
+    = (LADSPA_PortRangeHint*)psDescriptor->PortRangeHints + lPort;
+  psPortRangeHint->HintDescriptor
+    = iHintDescriptor;
+  psPortRangeHint->LowerBound 
+    = fLowerBound;
+  psPortRangeHint->UpperBound
+    = fUpperBound;
+}
+
+// -------------------------------------------------------------------
+
+// Describe the ports all flavours of the plugin have in common.
+static void describeStereoDelayPorts(LADSPA_Descriptor* psDescriptor) {
+  describePort(psDescriptor, SDL_DELAY_LENGTH_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Delay (Seconds) (Left)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_1),
+	       0, (LADSPA_Data)MAX_DELAY);
+  describePort(psDescriptor, SDL_DELAY_LENGTH_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Delay (Seconds) (Right)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_1),
+	       0, (LADSPA_Data)MAX_DELAY);
+  describePort(psDescriptor, SDL_DRY_WET_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry/Wet Balance (Left)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_DRY_WET_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry/Wet Balance (Right)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_INPUT_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_INPUT_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Right)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_OUTPUT_LEFT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_OUTPUT_RIGHT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Right)",
+	       0, 0, 0);
+}
+
+// -------------------------------------------------------------------
+
+// Describe the additional ports of the fractional flavours.
+static void describeFractionalDelayPorts(LADSPA_Descriptor* psDescriptor) {
+  describePort(psDescriptor, SDL_INTERPOLATION,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Interpolation (0 = None, 1 = Linear, 2 = Cubic, "
+	       "3 = Allpass)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_INTEGER
+		| LADSPA_HINT_DEFAULT_1),
+	       SDL_INTERPOLATION_NONE, SDL_INTERPOLATION_ALLPASS);
+  describePort(psDescriptor, SDL_DELAY_CHANGE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Delay Change (0 = Jump, 1 = Crossfade, 2 = Glide)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_INTEGER
+		| LADSPA_HINT_DEFAULT_0),
+	       SDL_DELAY_CHANGE_JUMP, SDL_DELAY_CHANGE_GLIDE);
+  describePort(psDescriptor, SDL_CROSSFADE_TIME,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Crossfade Time (Seconds)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_LOW),
+	       0, (LADSPA_Data)MAX_CROSSFADE_TIME);
+  describePort(psDescriptor, SDL_GLIDE_RATE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Glide Rate (Seconds per Second)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_LOGARITHMIC
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       (LADSPA_Data)MIN_GLIDE_RATE, (LADSPA_Data)MAX_GLIDE_RATE);
+}
+
+// -------------------------------------------------------------------
+
+// Describe the additional ports of the echo flavours.
+static void describeFeedbackPorts(LADSPA_Descriptor* psDescriptor) {
+  describePort(psDescriptor, SDL_ECHO_FEEDBACK,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Feedback",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_ECHO_FEEDBACK_LOW_PASS,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Feedback Low-Pass (Hz)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_LOGARITHMIC
+		| LADSPA_HINT_DEFAULT_HIGH),
+	       (LADSPA_Data)MIN_FEEDBACK_CUTOFF,
+	       (LADSPA_Data)MAX_FEEDBACK_CUTOFF);
+  describePort(psDescriptor, SDL_ECHO_FEEDBACK_HIGH_PASS,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Feedback High-Pass (Hz)",
+	       (LADSPA_HINT_BOUNDED_BELOW
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_LOGARITHMIC
+		| LADSPA_HINT_DEFAULT_MINIMUM),
+	       (LADSPA_Data)MIN_FEEDBACK_CUTOFF,
+	       (LADSPA_Data)MAX_FEEDBACK_CUTOFF);
+  describePort(psDescriptor, SDL_ECHO_SATURATION,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Saturation",
+	       LADSPA_HINT_TOGGLED | LADSPA_HINT_DEFAULT_0,
+	       0, 0);
+}
+
+// -------------------------------------------------------------------
+
+// Create the descriptor of an N-channel delay line with lChannelCount
+// channels. All of them are built from this one template: the ports
+// of each group of SDL_MULTI_PORT_GROUPS follow each other, one per
+// channel.
+static LADSPA_Descriptor*
+createMultiDelayDescriptor(unsigned long lUniqueID,
+			   unsigned long lChannelCount) {
+
+  LADSPA_Descriptor* psDescriptor;
+  char acLabel[64];
+  char acName[64];
+  unsigned long lChannel;
+
   // -----------------------------------------------------------------
-  
-  lBufferReadOffsetLeft
-    = lBufferWriteOffset + psSimpleDelayLine->m_lBufferSize - lDelayLeft;
-  lBufferReadOffsetRight
-    = lBufferWriteOffset + psSimpleDelayLine->m_lBufferSize - lDelayRight;
-  
+
+  snprintf(acLabel, sizeof(acLabel), "c_delay_5s_%luch", lChannelCount);
+  snprintf(acName, sizeof(acName), "Simple %lu Channel Delay Line",
+	   lChannelCount);
+  psDescriptor = createDescriptor(lUniqueID,
+				  acLabel,
+				  acName,
+				  lChannelCount * SDL_MULTI_PORT_GROUPS);
+  if (psDescriptor == NULL)
+    return NULL;
+
   // -----------------------------------------------------------------
-  
-  fWetLeft = LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine->m_pfDryWetLeft));
-  fWetRight = LIMIT_BETWEEN_0_AND_1(*(psSimpleDelayLine->m_pfDryWetRight));
-  
+
+  psDescriptor->instantiate
+    = instantiateMultiDelayLine;
+  psDescriptor->connect_port 
+    = connectPortToMultiDelayLine;
+  psDescriptor->activate
+    = activateMultiDelayLine;
+  selectMultiDelayLineRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainMultiDelayLine;
+  psDescriptor->cleanup
+    = cleanupMultiDelayLine;
+
   // -----------------------------------------------------------------
-  
-  fDryLeft = 1 - fWetLeft;
-  fDryRight = 1 - fWetRight;
+
+  for (lChannel = 0; lChannel < lChannelCount; lChannel++) {
+    snprintf(acName, sizeof(acName),
+	     "Delay (Seconds) (Channel %lu)", lChannel + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_DELAY_LENGTH * lChannelCount + lChannel,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 acName,
+		 (LADSPA_HINT_BOUNDED_BELOW 
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_1),
+		 0, (LADSPA_Data)MAX_DELAY);
+    snprintf(acName, sizeof(acName),
+	     "Dry/Wet Balance (Channel %lu)", lChannel + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_DRY_WET * lChannelCount + lChannel,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 acName,
+		 (LADSPA_HINT_BOUNDED_BELOW 
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_MIDDLE),
+		 0, 1);
+    snprintf(acName, sizeof(acName), "Input (Channel %lu)", lChannel + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_INPUT * lChannelCount + lChannel,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+		 acName,
+		 0, 0, 0);
+    snprintf(acName, sizeof(acName), "Output (Channel %lu)", lChannel + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_OUTPUT * lChannelCount + lChannel,
+		 LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+		 acName,
+		 0, 0, 0);
+  }
 
   // -----------------------------------------------------------------
-  
-  for (lSampleIndex = 0; lSampleIndex < SampleCount; lSampleIndex++) {
-    fInputSampleLeft = *(pfInputLeft++);
-    fInputSampleRight = *(pfInputRight++);
-    
-    // ---------------------------------------------------------------
-    
-    *(pfOutputLeft++) = (fDryLeft * fInputSampleLeft
-			 + fWetLeft * pfBufferLeft[((lSampleIndex + lBufferReadOffsetLeft)
-						    & lBufferSizeMinusOne)]);
-    *(pfOutputRight++) = (fDryRight * fInputSampleRight
-			  + fWetRight * pfBufferRight[((lSampleIndex + lBufferReadOffsetRight)
-						       & lBufferSizeMinusOne)]);
-    
-    // ---------------------------------------------------------------
-    
-    pfBufferLeft[((lSampleIndex + lBufferWriteOffset)
-		  & lBufferSizeMinusOne)] = fInputSampleLeft;
-    pfBufferRight[((lSampleIndex + lBufferWriteOffset)
-		   & lBufferSizeMinusOne)] = fInputSampleRight;
+
+  return psDescriptor;
+}
+
+// -------------------------------------------------------------------
+
+// Create the descriptor of a multi-tap delay line with lTapCount taps.
+// The ports shared by all taps come first, followed by the groups of
+// SDL_TAP_PORT_GROUPS with one port per tap. Only the first tap is
+// heard by default.
+static LADSPA_Descriptor*
+createMultiTapDescriptor(unsigned long lUniqueID,
+			 unsigned long lTapCount) {
+
+  LADSPA_Descriptor* psDescriptor;
+  char acLabel[64];
+  char acName[64];
+  unsigned long lTap;
+
+  // -----------------------------------------------------------------
+
+  snprintf(acLabel, sizeof(acLabel), "c_delay_5s_stereo_%lutap", lTapCount);
+  snprintf(acName, sizeof(acName), "Stereo %lu Tap Delay Line", lTapCount);
+  psDescriptor = createDescriptor(lUniqueID,
+				  acLabel,
+				  acName,
+				  (SDL_MULTI_TAP_SHARED_PORTS
+				   + lTapCount * SDL_TAP_PORT_GROUPS));
+  if (psDescriptor == NULL)
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psDescriptor->instantiate
+    = instantiateMultiTapDelayLine;
+  psDescriptor->connect_port 
+    = connectPortToMultiTapDelayLine;
+  psDescriptor->activate
+    = activateMultiTapDelayLine;
+  selectMultiTapDelayLineRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainMultiTapDelayLine;
+  psDescriptor->cleanup
+    = cleanupMultiTapDelayLine;
+
+  // -----------------------------------------------------------------
+
+  describePort(psDescriptor, SDL_MULTI_TAP_DRY,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry Level",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_1),
+	       0, 1);
+  describePort(psDescriptor, SDL_MULTI_TAP_INPUT_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_MULTI_TAP_INPUT_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Right)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_MULTI_TAP_OUTPUT_LEFT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_MULTI_TAP_OUTPUT_RIGHT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Right)",
+	       0, 0, 0);
+
+  // -----------------------------------------------------------------
+
+  for (lTap = 0; lTap < lTapCount; lTap++) {
+    snprintf(acName, sizeof(acName), "Delay (Seconds) (Tap %lu)", lTap + 1);
+    describePort(psDescriptor,
+		 (SDL_MULTI_TAP_SHARED_PORTS
+		  + SDL_TAP_DELAY_LENGTH * lTapCount + lTap),
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 acName,
+		 (LADSPA_HINT_BOUNDED_BELOW 
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_1),
+		 0, (LADSPA_Data)MAX_DELAY);
+    snprintf(acName, sizeof(acName), "Gain (Tap %lu)", lTap + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_TAP_SHARED_PORTS + SDL_TAP_GAIN * lTapCount + lTap,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 acName,
+		 (LADSPA_HINT_BOUNDED_BELOW 
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | (lTap == 0
+		     ? LADSPA_HINT_DEFAULT_MIDDLE
+		     : LADSPA_HINT_DEFAULT_0)),
+		 0, 1);
+    snprintf(acName, sizeof(acName),
+	     "Pan (-1 = Left, 1 = Right) (Tap %lu)", lTap + 1);
+    describePort(psDescriptor,
+		 SDL_MULTI_TAP_SHARED_PORTS + SDL_TAP_PAN * lTapCount + lTap,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 acName,
+		 (LADSPA_HINT_BOUNDED_BELOW 
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_0),
+		 -1, 1);
   }
 
   // -----------------------------------------------------------------
-  
-  psSimpleDelayLine->m_lWritePointer
-    = ((psSimpleDelayLine->m_lWritePointer + SampleCount)
-       & lBufferSizeMinusOne);
+
+  return psDescriptor;
 }
 
 // -------------------------------------------------------------------
 
-// Throw away a simple delay line.
-static void cleanupSimpleDelayLine(LADSPA_Handle Instance) {
+// Create the descriptor of the tap file delay line.
+static LADSPA_Descriptor* createTapFileDescriptor(unsigned long lUniqueID) {
 
-  SimpleDelayLine* psSimpleDelayLine;
+  LADSPA_Descriptor* psDescriptor;
 
   // -----------------------------------------------------------------
-  
-  psSimpleDelayLine = (SimpleDelayLine*)Instance;
+
+  psDescriptor = createDescriptor(lUniqueID,
+				  "c_delay_5s_stereo_tap_file",
+				  "Stereo Tap File Delay Line",
+				  SDL_TAP_FILE_PORT_COUNT);
+  if (psDescriptor == NULL)
+    return NULL;
 
   // -----------------------------------------------------------------
-  
-  free(psSimpleDelayLine->m_pfBufferLeft);
-  free(psSimpleDelayLine->m_pfBufferRight);
-  free(psSimpleDelayLine);
+
+  psDescriptor->instantiate
+    = instantiateTapFileDelayLine;
+  psDescriptor->connect_port 
+    = connectPortToTapFileDelayLine;
+  psDescriptor->activate
+    = activateTapFileDelayLine;
+  selectTapFileDelayLineRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainTapFileDelayLine;
+  psDescriptor->cleanup
+    = cleanupTapFileDelayLine;
+
+  // -----------------------------------------------------------------
+
+  describePort(psDescriptor, SDL_TAP_FILE_DRY_WET,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry/Wet Balance",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_TAP_FILE_INPUT_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_TAP_FILE_INPUT_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Right)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_TAP_FILE_OUTPUT_LEFT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_TAP_FILE_OUTPUT_RIGHT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Right)",
+	       0, 0, 0);
+
+  // -----------------------------------------------------------------
+
+  return psDescriptor;
 }
 
 // -------------------------------------------------------------------
 
-static LADSPA_Descriptor* g_psDescriptor = NULL;
+// Create the descriptor of the feedback delay network reverb with
+// the line count *plLineCount.
+static LADSPA_Descriptor* 
+createFdnDescriptor(unsigned long lUniqueID,
+		    const unsigned long* plLineCount) {
+
+  LADSPA_Descriptor* psDescriptor;
+  char acLabel[64];
+  char acName[64];
+
+  // -----------------------------------------------------------------
+
+  snprintf(acLabel, sizeof(acLabel), "c_delay_stereo_fdn%lu", *plLineCount);
+  snprintf(acName, sizeof(acName), "Stereo %lu Line FDN Reverb",
+	   *plLineCount);
+  psDescriptor = createDescriptor(lUniqueID,
+				  acLabel,
+				  acName,
+				  SDL_FDN_PORT_COUNT);
+  if (psDescriptor == NULL)
+    return NULL;
+
+  // -----------------------------------------------------------------
+
+  psDescriptor->ImplementationData
+    = (void*)plLineCount;
+  psDescriptor->instantiate
+    = instantiateFeedbackDelayNetwork;
+  psDescriptor->connect_port 
+    = connectPortToFeedbackDelayNetwork;
+  psDescriptor->activate
+    = activateFeedbackDelayNetwork;
+  selectFeedbackDelayNetworkRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainFeedbackDelayNetwork;
+  psDescriptor->cleanup
+    = cleanupFeedbackDelayNetwork;
+
+  // -----------------------------------------------------------------
+
+  describePort(psDescriptor, SDL_FDN_SIZE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Size (Seconds)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       (LADSPA_Data)MIN_FDN_SIZE, (LADSPA_Data)MAX_FDN_SIZE);
+  describePort(psDescriptor, SDL_FDN_DECAY_TIME,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Decay Time (Seconds)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_LOGARITHMIC
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       (LADSPA_Data)MIN_DECAY_TIME, (LADSPA_Data)MAX_DECAY_TIME);
+  describePort(psDescriptor, SDL_FDN_DAMPING,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Damping",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_FDN_DRY_WET,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry/Wet Balance",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_FDN_INPUT_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_FDN_INPUT_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Right)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_FDN_OUTPUT_LEFT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_FDN_OUTPUT_RIGHT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Right)",
+	       0, 0, 0);
+
+  // -----------------------------------------------------------------
+
+  return psDescriptor;
+}
 
 // -------------------------------------------------------------------
 
-// Called automatically when the plugin library is first loaded.
-ON_LOAD_ROUTINE {
+// Create the descriptor of the comb filter bank with the comb count
+// *plCombCount.
+static LADSPA_Descriptor* 
+createCombDescriptor(unsigned long lUniqueID,
+		     const unsigned long* plCombCount) {
 
-  char** pcPortNames;
-  LADSPA_PortDescriptor* piPortDescriptors;
-  LADSPA_PortRangeHint* psPortRangeHints;
+  LADSPA_Descriptor* psDescriptor;
+  char acLabel[64];
+  char acName[64];
 
   // -----------------------------------------------------------------
-  
-  g_psDescriptor
-    = (LADSPA_Descriptor*)malloc(sizeof(LADSPA_Descriptor));
-  
+
+  snprintf(acLabel, sizeof(acLabel), "c_delay_stereo_comb%lu", *plCombCount);
+  snprintf(acName, sizeof(acName), "Stereo %lu Comb Filter Bank",
+	   *plCombCount);
+  psDescriptor = createDescriptor(lUniqueID,
+				  acLabel,
+				  acName,
+				  SDL_COMB_PORT_COUNT);
+  if (psDescriptor == NULL)
+    return NULL;
+
   // -----------------------------------------------------------------
-  
-  if (g_psDescriptor) {
-    g_psDescriptor->UniqueID
-      = 399;
-    g_psDescriptor->Label
-      = strdup("c_delay_5s_stereo");
-    g_psDescriptor->Properties
-      = LADSPA_PROPERTY_HARD_RT_CAPABLE;
-    g_psDescriptor->Name 
-      = strdup("Simple Stereo Delay Line");
-    g_psDescriptor->Maker
-      = strdup("Richard Furse (LADSPA example plugins)");
-    g_psDescriptor->Copyright
-      = strdup("None");
-    g_psDescriptor->PortCount 
-      = 8;
-    
-    // ---------------------------------------------------------------
-    
-    piPortDescriptors
-      = (LADSPA_PortDescriptor*)calloc(8, sizeof(LADSPA_PortDescriptor));
-    g_psDescriptor->PortDescriptors 
-      = (const LADSPA_PortDescriptor*)piPortDescriptors;
-    
-    // ---------------------------------------------------------------
-    
-    piPortDescriptors[SDL_DELAY_LENGTH_LEFT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL;
-    piPortDescriptors[SDL_DELAY_LENGTH_RIGHT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL;
-    piPortDescriptors[SDL_DRY_WET_LEFT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL;
-    piPortDescriptors[SDL_DRY_WET_RIGHT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL;
-    piPortDescriptors[SDL_INPUT_LEFT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO;
-    piPortDescriptors[SDL_INPUT_RIGHT]
-      = LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO;
-    piPortDescriptors[SDL_OUTPUT_LEFT]
-      = LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO;
-    piPortDescriptors[SDL_OUTPUT_RIGHT]
-      = LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO;
-    
-    // ---------------------------------------------------------------
-    
-    pcPortNames
-      = (char **)calloc(8, sizeof(char *));
-    g_psDescriptor->PortNames
-      = (const char **)pcPortNames;
-    
-    // ---------------------------------------------------------------
-    
-    pcPortNames[SDL_DELAY_LENGTH_LEFT]
-      = strdup("Delay (Seconds) (Left)");
-    pcPortNames[SDL_DELAY_LENGTH_RIGHT]
-      = strdup("Delay (Seconds) (Right)");
-    pcPortNames[SDL_DRY_WET_LEFT] 
-      = strdup("Dry/Wet Balance (Left)");
-    pcPortNames[SDL_DRY_WET_RIGHT] 
-      = strdup("Dry/Wet Balance (Right)");
-    pcPortNames[SDL_INPUT_LEFT] 
-      = strdup("Input (Left)");
-    pcPortNames[SDL_INPUT_RIGHT] 
-      = strdup("Input (Right)");
-    pcPortNames[SDL_OUTPUT_LEFT]
-      = strdup("Output (Left)");
-    pcPortNames[SDL_OUTPUT_RIGHT]
-      = strdup("Output (Right)");
 
-    // ---------------------------------------------------------------
-        
-    psPortRangeHints = ((LADSPA_PortRangeHint*)
-			calloc(8, sizeof(LADSPA_PortRangeHint)));
-    g_psDescriptor->PortRangeHints
-      = (const LADSPA_PortRangeHint*)psPortRangeHints;
+  psDescriptor->ImplementationData
+    = (void*)plCombCount;
+  psDescriptor->instantiate
+    = instantiateCombFilterBank;
+  psDescriptor->connect_port 
+    = connectPortToCombFilterBank;
+  psDescriptor->activate
+    = activateCombFilterBank;
+  selectCombFilterBankRunFunctions(psDescriptor);
+  psDescriptor->set_run_adding_gain
+    = setRunAddingGainCombFilterBank;
+  psDescriptor->cleanup
+    = cleanupCombFilterBank;
 
-    // ---------------------------------------------------------------
-        
-    psPortRangeHints[SDL_DELAY_LENGTH_LEFT].HintDescriptor
-      = (LADSPA_HINT_BOUNDED_BELOW 
-	 | LADSPA_HINT_BOUNDED_ABOVE
-	 | LADSPA_HINT_DEFAULT_1);
-    psPortRangeHints[SDL_DELAY_LENGTH_LEFT].LowerBound 
-      = 0;
-    psPortRangeHints[SDL_DELAY_LENGTH_LEFT].UpperBound
-      = (LADSPA_Data)MAX_DELAY;
-    psPortRangeHints[SDL_DELAY_LENGTH_RIGHT].HintDescriptor
-      = psPortRangeHints[SDL_DELAY_LENGTH_LEFT].HintDescriptor;
-    psPortRangeHints[SDL_DELAY_LENGTH_RIGHT].LowerBound
-      = psPortRangeHints[SDL_DELAY_LENGTH_LEFT].LowerBound;
-    psPortRangeHints[SDL_DELAY_LENGTH_RIGHT].UpperBound
-      = psPortRangeHints[SDL_DELAY_LENGTH_LEFT].UpperBound;
-    
-    // ---------------------------------------------------------------
-    
-    psPortRangeHints[SDL_DRY_WET_LEFT].HintDescriptor
-      = (LADSPA_HINT_BOUNDED_BELOW 
-	 | LADSPA_HINT_BOUNDED_ABOVE
-	 | LADSPA_HINT_DEFAULT_MIDDLE);
-    psPortRangeHints[SDL_DRY_WET_LEFT].LowerBound 
-      = 0;
-    psPortRangeHints[SDL_DRY_WET_LEFT].UpperBound
-      = 1;
-    psPortRangeHints[SDL_DRY_WET_RIGHT].HintDescriptor
-      = psPortRangeHints[SDL_DRY_WET_LEFT].HintDescriptor;
-    psPortRangeHints[SDL_DRY_WET_RIGHT].LowerBound
-      = psPortRangeHints[SDL_DRY_WET_LEFT].LowerBound;
-    psPortRangeHints[SDL_DRY_WET_RIGHT].UpperBound
-      = psPortRangeHints[SDL_DRY_WET_LEFT].UpperBound;
-    
-    // ---------------------------------------------------------------
-    
-    psPortRangeHints[SDL_INPUT_LEFT].HintDescriptor
-      = 0;
-    psPortRangeHints[SDL_INPUT_RIGHT].UpperBound
-      = psPortRangeHints[SDL_INPUT_LEFT].UpperBound;
-    
-    // ---------------------------------------------------------------
-    
-    psPortRangeHints[SDL_OUTPUT_LEFT].HintDescriptor
-      = 0;
-    psPortRangeHints[SDL_OUTPUT_RIGHT].UpperBound
-      = psPortRangeHints[SDL_OUTPUT_LEFT].UpperBound;
+  // -----------------------------------------------------------------
 
-    // ---------------------------------------------------------------
-        
-    g_psDescriptor->instantiate
-      = instantiateSimpleDelayLine;
-    g_psDescriptor->connect_port 
-      = connectPortToSimpleDelayLine;
-    g_psDescriptor->activate
-      = activateSimpleDelayLine;
-    g_psDescriptor->run 
-      = runSimpleDelayLine;
-    g_psDescriptor->run_adding
-      = NULL;
-    g_psDescriptor->set_run_adding_gain
-      = NULL;
-    g_psDescriptor->deactivate
-      = NULL;
-    g_psDescriptor->cleanup
-      = cleanupSimpleDelayLine;
-  }
+  describePort(psDescriptor, SDL_COMB_ROOT_NOTE,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Root Note (MIDI)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       MIN_ROOT_NOTE, MAX_ROOT_NOTE);
+  describePort(psDescriptor, SDL_COMB_TUNING,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       ("Tuning (0 = Harmonics, 1 = Fifths, 2 = Major, "
+		"3 = Minor)"),
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_INTEGER
+		| LADSPA_HINT_DEFAULT_0),
+	       SDL_TUNING_HARMONICS, SDL_TUNING_MINOR);
+  describePort(psDescriptor, SDL_COMB_DECAY_TIME,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Decay Time (Seconds)",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_LOGARITHMIC
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       (LADSPA_Data)MIN_DECAY_TIME, (LADSPA_Data)MAX_DECAY_TIME);
+  describePort(psDescriptor, SDL_COMB_DAMPING,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Damping",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_COMB_DRY_WET,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+	       "Dry/Wet Balance",
+	       (LADSPA_HINT_BOUNDED_BELOW 
+		| LADSPA_HINT_BOUNDED_ABOVE
+		| LADSPA_HINT_DEFAULT_MIDDLE),
+	       0, 1);
+  describePort(psDescriptor, SDL_COMB_INPUT_LEFT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_COMB_INPUT_RIGHT,
+	       LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+	       "Input (Right)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_COMB_OUTPUT_LEFT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Left)",
+	       0, 0, 0);
+  describePort(psDescriptor, SDL_COMB_OUTPUT_RIGHT,
+	       LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+	       "Output (Right)",
+	       0, 0, 0);
+
+  // -----------------------------------------------------------------
+
+  return psDescriptor;
 }
 
 // -------------------------------------------------------------------
 
-// Called automatically when the library is unloaded.
-ON_UNLOAD_ROUTINE {
+// Free a descriptor allocated by createDescriptor().
+static void deleteDescriptor(LADSPA_Descriptor* psDescriptor) {
+
   long lIndex;
   
   // -----------------------------------------------------------------
   
-  if (g_psDescriptor) {
-    free((char*)g_psDescriptor->Label);
-    free((char*)g_psDescriptor->Name);
-    free((char*)g_psDescriptor->Maker);
-    free((char*)g_psDescriptor->Copyright);
+  if (psDescriptor) {
+    free((char*)psDescriptor->Label);
+    free((char*)psDescriptor->Name);
+    free((char*)psDescriptor->Maker);
+    free((char*)psDescriptor->Copyright);
     
     // ---------------------------------------------------------------
     
-    free((LADSPA_PortDescriptor*)g_psDescriptor->PortDescriptors);
+    free((LADSPA_PortDescriptor*)psDescriptor->PortDescriptors);
     
     // ---------------------------------------------------------------
     
-    for (lIndex = 0; lIndex < g_psDescriptor->PortCount; lIndex++) {
-      free((char*)(g_psDescriptor->PortNames[lIndex]));
+    for (lIndex = 0; lIndex < psDescriptor->PortCount; lIndex++) {
+      free((char*)(psDescriptor->PortNames[lIndex]));
     }
     
     // ---------------------------------------------------------------
     
-    free((char**)g_psDescriptor->PortNames);
+    free((char**)psDescriptor->PortNames);
     
     // ---------------------------------------------------------------
     
-    free((LADSPA_PortRangeHint*)g_psDescriptor->PortRangeHints);
+    free((LADSPA_PortRangeHint*)psDescriptor->PortRangeHints);
     
     // ---------------------------------------------------------------
     
-    free(g_psDescriptor);
+    free(psDescriptor);
   }
 }
 
 // -------------------------------------------------------------------
 
-// Return a descriptor of the requested plugin type. Only one plugin
-// type is available in this library.
-const LADSPA_Descriptor* ladspa_descriptor(unsigned long Index) {
-  if (Index == 0)
-    return g_psDescriptor;
-  else
+// Append psDescriptor to the descriptors handed out by
+// ladspa_descriptor(), so its index follows from the order in which
+// the descriptors are added. Return psDescriptor, or NULL if there is
+// no room left in g_apsDescriptors, in which case it is deleted. A
+// descriptor that could not be created (NULL) takes no slot, so
+// ladspa_descriptor() still hands out all the others.
+static LADSPA_Descriptor* addDescriptor(LADSPA_Descriptor* psDescriptor) {
+  if (psDescriptor == NULL)
     return NULL;
+  if (g_lDescriptorCount == SDL_MAX_DESCRIPTORS) {
+    deleteDescriptor(psDescriptor);
+    return NULL;
+  }
+  g_apsDescriptors[g_lDescriptorCount++] = psDescriptor;
+  return psDescriptor;
+}
+
+// -------------------------------------------------------------------
+
+// Called automatically when the plugin library is first loaded.
+ON_LOAD_ROUTINE {
+
+  LADSPA_Descriptor* psDescriptor;
+  unsigned long lIndex;
+
+  // -----------------------------------------------------------------
+  
+  setupFft(&g_sFft);
+
+  // -----------------------------------------------------------------
+  
+  psDescriptor = addDescriptor(createDescriptor(399,
+						 "c_delay_5s_stereo",
+						 "Simple Stereo Delay Line",
+						 8));
+  if (psDescriptor) {
+    describeStereoDelayPorts(psDescriptor);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The same delay line with sub-sample delays and a choice of
+  // interpolators.
+  psDescriptor
+    = addDescriptor(createDescriptor(401,
+				     "c_delay_5s_stereo_fractional",
+				     "Fractional Stereo Delay Line",
+				     12));
+  if (psDescriptor) {
+    describeStereoDelayPorts(psDescriptor);
+    describeFractionalDelayPorts(psDescriptor);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The fractional delay line with audio rate modulation of the
+  // delays.
+  psDescriptor
+    = addDescriptor(createDescriptor(402,
+				     "c_delay_5s_stereo_modulated",
+				     "Modulated Stereo Delay Line",
+				     14));
+  if (psDescriptor) {
+    describeStereoDelayPorts(psDescriptor);
+    describeFractionalDelayPorts(psDescriptor);
+    describePort(psDescriptor, SDL_MODULATION_LEFT,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+		 "Delay Modulation (Seconds) (Left)",
+		 0, 0, 0);
+    describePort(psDescriptor, SDL_MODULATION_RIGHT,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+		 "Delay Modulation (Seconds) (Right)",
+		 0, 0, 0);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The fractional delay line with the delays swept by a built-in LFO
+  // for chorus, flanger and vibrato effects.
+  psDescriptor
+    = addDescriptor(createDescriptor(403,
+				     "c_delay_5s_stereo_chorus",
+				     "Stereo Chorus Delay Line",
+				     SDL_CHORUS_PORT_COUNT));
+  if (psDescriptor) {
+    psDescriptor->ImplementationData
+      = (void*)g_alChorusPortRoles;
+    describeStereoDelayPorts(psDescriptor);
+    describeFractionalDelayPorts(psDescriptor);
+    describePort(psDescriptor, SDL_CHORUS_LFO_RATE,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "LFO Rate (Hz)",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_LOGARITHMIC
+		  | LADSPA_HINT_DEFAULT_MIDDLE),
+		 (LADSPA_Data)MIN_LFO_RATE, (LADSPA_Data)MAX_LFO_RATE);
+    describePort(psDescriptor, SDL_CHORUS_LFO_DEPTH,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "LFO Depth (Seconds)",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_LOW),
+		 0, (LADSPA_Data)MAX_LFO_DEPTH);
+    describePort(psDescriptor, SDL_CHORUS_LFO_SHAPE,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "LFO Shape (0 = Sine, 1 = Triangle)",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_INTEGER
+		  | LADSPA_HINT_DEFAULT_0),
+		 SDL_LFO_SHAPE_SINE, SDL_LFO_SHAPE_TRIANGLE);
+    describePort(psDescriptor, SDL_CHORUS_LFO_STEREO_PHASE,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "LFO Stereo Phase (Degrees)",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_MIDDLE),
+		 0, (LADSPA_Data)MAX_LFO_STEREO_PHASE);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The fractional delay line with its output fed back through a tone
+  // filter and an optional saturation, for tape and analogue style
+  // echoes.
+  psDescriptor
+    = addDescriptor(createDescriptor(404,
+				     "c_delay_5s_stereo_echo",
+				     "Stereo Echo Delay Line",
+				     SDL_ECHO_PORT_COUNT));
+  if (psDescriptor) {
+    psDescriptor->ImplementationData
+      = (void*)g_alEchoPortRoles;
+    describeStereoDelayPorts(psDescriptor);
+    describeFractionalDelayPorts(psDescriptor);
+    describeFeedbackPorts(psDescriptor);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The echo with part of the feedback of each channel crossing over
+  // to the other one, for ping-pong echoes.
+  psDescriptor
+    = addDescriptor(createDescriptor(405,
+				     "c_delay_5s_stereo_ping_pong",
+				     "Stereo Ping-Pong Delay Line",
+				     SDL_PING_PONG_PORT_COUNT));
+  if (psDescriptor) {
+    psDescriptor->ImplementationData
+      = (void*)g_alPingPongPortRoles;
+    describeStereoDelayPorts(psDescriptor);
+    describeFractionalDelayPorts(psDescriptor);
+    describeFeedbackPorts(psDescriptor);
+    describePort(psDescriptor, SDL_PING_PONG_CROSS_FEEDBACK,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "Cross Feedback",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_1),
+		 0, 1);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The plain delay line for other channel counts, for example to
+  // compensate the latencies of surround or ambisonic busses.
+  for (lIndex = 0; lIndex < SDL_MULTI_DESCRIPTOR_COUNT; lIndex++) {
+    addDescriptor(createMultiDelayDescriptor(SDL_MULTI_UNIQUE_ID + lIndex,
+					     g_alMultiChannelCounts[lIndex]));
+  }
+
+  // -----------------------------------------------------------------
+  
+  // Several delays of the same stereo signal read from one ring
+  // buffer, for rhythmic delays and early reflections.
+  for (lIndex = 0; lIndex < SDL_MULTI_TAP_DESCRIPTOR_COUNT; lIndex++) {
+    addDescriptor(createMultiTapDescriptor(SDL_MULTI_TAP_UNIQUE_ID + lIndex,
+					   g_alMultiTapCounts[lIndex]));
+  }
+
+  // -----------------------------------------------------------------
+  
+  // A fixed pattern of any number of taps loaded from a file, for
+  // early reflections and other sparse impulse responses.
+  addDescriptor(createTapFileDescriptor(SDL_TAP_FILE_UNIQUE_ID));
+
+  // -----------------------------------------------------------------
+  
+  // Reverbs made of delay lines feeding each other back through a
+  // Householder matrix.
+  for (lIndex = 0; lIndex < SDL_FDN_DESCRIPTOR_COUNT; lIndex++) {
+    addDescriptor(createFdnDescriptor(SDL_FDN_UNIQUE_ID + lIndex,
+				      &g_alFdnLineCounts[lIndex]));
+  }
+
+  // -----------------------------------------------------------------
+  
+  // Banks of combs tuned to a chord, for resonators.
+  for (lIndex = 0; lIndex < SDL_COMB_DESCRIPTOR_COUNT; lIndex++) {
+    addDescriptor(createCombDescriptor(SDL_COMB_UNIQUE_ID + lIndex,
+				       &g_alCombCounts[lIndex]));
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The plain delay line playing segments of the input backwards,
+  // for reverse echoes and swells.
+  psDescriptor
+    = addDescriptor(createDescriptor(SDL_REVERSE_UNIQUE_ID,
+				     "c_delay_5s_stereo_reverse",
+				     "Stereo Reverse Delay Line",
+				     SDL_REVERSE_PORT_COUNT));
+  if (psDescriptor) {
+    psDescriptor->ImplementationData
+      = (void*)g_alReversePortRoles;
+    describeStereoDelayPorts(psDescriptor);
+    describePort(psDescriptor, SDL_REVERSE_SWITCH,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "Reverse",
+		 LADSPA_HINT_TOGGLED | LADSPA_HINT_DEFAULT_1,
+		 0, 0);
+  }
+
+  // -----------------------------------------------------------------
+  
+  // The plain delay line read by heads sweeping through it at another
+  // speed, for octave echoes and shimmer.
+  fillPitchWindow();
+  psDescriptor
+    = addDescriptor(createDescriptor(SDL_PITCH_SHIFT_UNIQUE_ID,
+				     "c_delay_5s_stereo_pitch_shift",
+				     "Stereo Pitch Shifting Delay Line",
+				     SDL_PITCH_PORT_COUNT));
+  if (psDescriptor) {
+    psDescriptor->ImplementationData
+      = (void*)g_alPitchShiftPortRoles;
+    describeStereoDelayPorts(psDescriptor);
+    describePort(psDescriptor, SDL_PITCH_SHIFT_SEMITONES,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "Pitch Shift (Semitones)",
+		 (LADSPA_HINT_BOUNDED_BELOW
+		  | LADSPA_HINT_BOUNDED_ABOVE
+		  | LADSPA_HINT_DEFAULT_MIDDLE),
+		 MIN_PITCH_SHIFT, MAX_PITCH_SHIFT);
+    describePort(psDescriptor, SDL_PITCH_FOUR_READ_HEADS,
+		 LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+		 "Four Read Heads",
+		 LADSPA_HINT_TOGGLED | LADSPA_HINT_DEFAULT_0,
+		 0, 0);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Called automatically when the library is unloaded.
+ON_UNLOAD_ROUTINE {
+
+  unsigned long lIndex;
+
+  // -----------------------------------------------------------------
+
+  for (lIndex = 0; lIndex < g_lDescriptorCount; lIndex++)
+    deleteDescriptor(g_apsDescriptors[lIndex]);
+  g_lDescriptorCount = 0;
+}
+
+// -------------------------------------------------------------------
+
+// Return a descriptor of the requested plugin type. There are six
+// flavours of the stereo plugin in this library: the plain one with
+// whole sample delays, a fractional one, a modulated one, a chorus, an
+// echo and a ping-pong echo. They are followed by the N-channel delay
+// lines, one for each channel count, the multi-tap delay lines, one
+// for each tap count, the tap file delay line, the feedback delay
+// network reverbs, one for each line count, the comb filter banks,
+// one for each comb count, and the reverse and the pitch shifting
+// flavours of the stereo plugin. The order is the one in which
+// ON_LOAD_ROUTINE adds them to g_apsDescriptors.
+const LADSPA_Descriptor* ladspa_descriptor(unsigned long Index) {
+  if (Index < g_lDescriptorCount)
+    return g_apsDescriptors[Index];
+  return NULL;
 }
 
 // -------------------------------------------------------------------
@@ -0,0 +1,455 @@
+// -------------------------------------------------------------------
+// test_inplace.c
+//
+// Test for the in-place processing of the delay plugins. LADSPA hosts
+// may connect an input port and an output port to the same buffer,
+// and none of the plugins sets LADSPA_PROPERTY_INPLACE_BROKEN. This
+// test runs every plugin in the library twice side by side, once in
+// place and once with separate buffers, and checks that both produce
+// exactly the same output, bit for bit.
+//
+// The plugin source is included directly, so the run and run_adding
+// functions of every kernel set the CPU supports are called, not just
+// the one selected when the library is loaded. Block sizes, delays,
+// the other controls and stretches of silence are chosen at random.
+// The tap file delay line is given a list of taps dense enough to be
+// convolved.
+//
+// Usage: test_inplace
+// -------------------------------------------------------------------
+
+#include <unistd.h>
+
+#include "delay_stereo.c"
+
+// -------------------------------------------------------------------
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_BLOCKS 800
+#define TEST_MAX_BLOCK_SIZE 5000
+
+// The delays are kept short most of the time, so the read heads pass
+// through the block being written as often as possible.
+#define TEST_MAX_SHORT_DELAY 64
+#define TEST_MAX_DELAY 0.2
+
+// The tap list holds a few sparse taps and a dense run of
+// TEST_DENSE_TAPS taps on consecutive samples.
+#define TEST_DENSE_TAPS 2048
+
+// -------------------------------------------------------------------
+
+// The run and run_adding functions of one kernel set.
+typedef struct {
+
+  const char* m_pcName;
+  void (*m_fnRun)(LADSPA_Handle, unsigned long);
+  void (*m_fnRunAdding)(LADSPA_Handle, unsigned long);
+
+} KernelSet;
+
+#define KERNEL_SET(Plugin, Isa, Name)			\
+  { Name, run##Plugin##Isa, runAdding##Plugin##Isa }
+
+#ifdef SDL_X86_SIMD
+#define TEST_KERNEL_SET_COUNT 4
+#define KERNEL_SETS(Plugin)				\
+  {							\
+    KERNEL_SET(Plugin, Generic, "generic"),		\
+    KERNEL_SET(Plugin, Sse2, "sse2"),			\
+    KERNEL_SET(Plugin, Avx2, "avx2"),			\
+    KERNEL_SET(Plugin, Avx512, "avx512")		\
+  }
+#else
+#define TEST_KERNEL_SET_COUNT 1
+#define KERNEL_SETS(Plugin)				\
+  {							\
+    KERNEL_SET(Plugin, Generic, "generic")		\
+  }
+#endif
+
+// The kernel sets of each core of the library, told apart by the
+// instantiate function of their descriptors.
+typedef struct {
+
+  LADSPA_Handle (*m_fnInstantiate)(const LADSPA_Descriptor*,
+				   unsigned long);
+  KernelSet m_asKernelSets[TEST_KERNEL_SET_COUNT];
+
+} PluginCore;
+
+#define PLUGIN_CORE(Plugin)				\
+  { instantiate##Plugin, KERNEL_SETS(Plugin) }
+
+static const PluginCore g_asPluginCores[] = {
+  PLUGIN_CORE(SimpleDelayLine),
+  PLUGIN_CORE(MultiDelayLine),
+  PLUGIN_CORE(MultiTapDelayLine),
+  PLUGIN_CORE(TapFileDelayLine),
+  PLUGIN_CORE(FeedbackDelayNetwork),
+  PLUGIN_CORE(CombFilterBank),
+};
+
+#define TEST_PLUGIN_CORE_COUNT \
+  (sizeof(g_asPluginCores) / sizeof(g_asPluginCores[0]))
+
+// -------------------------------------------------------------------
+
+// Check whether the CPU can run the kernel set at lKernelSet in the
+// kernel sets of a core.
+static int isKernelSetSupported(unsigned long lKernelSet) {
+#ifdef SDL_X86_SIMD
+  __builtin_cpu_init();
+  switch (lKernelSet) {
+  case 1:
+    return __builtin_cpu_supports("sse2");
+  case 2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case 3:
+    return __builtin_cpu_supports("avx512f");
+  }
+#endif
+  return 1;
+}
+
+// Find the core psDescriptor belongs to.
+static const PluginCore*
+findPluginCore(const LADSPA_Descriptor* psDescriptor) {
+
+  unsigned long lCore;
+
+  // -----------------------------------------------------------------
+
+  for (lCore = 0; lCore < TEST_PLUGIN_CORE_COUNT; lCore++)
+    if (g_asPluginCores[lCore].m_fnInstantiate == psDescriptor->instantiate)
+      return g_asPluginCores + lCore;
+  return NULL;
+}
+
+// -------------------------------------------------------------------
+
+// Write the tap list to a temporary file and point the tap file delay
+// line to it. Return the path of the file, to be removed afterwards.
+static char* writeTapFile(void) {
+
+  static char acPath[] = "/tmp/test_inplace_taps_XXXXXX";
+  FILE* psFile;
+  unsigned long lTap;
+  int iFile;
+
+  // -----------------------------------------------------------------
+
+  iFile = mkstemp(acPath);
+  if (iFile < 0)
+    return NULL;
+  psFile = fdopen(iFile, "w");
+  if (psFile == NULL) {
+    close(iFile);
+    return NULL;
+  }
+  fprintf(psFile, "# delay gain\n0 0.5\n0.0113 0.42\n0.0171 -0.31\n");
+  for (lTap = 0; lTap < TEST_DENSE_TAPS; lTap++)
+    fprintf(psFile, "%.9f %.6f\n",
+	    0.03 + (double)lTap / TEST_SAMPLE_RATE,
+	    0.01 * ((long)(lTap % 7) - 3));
+  fclose(psFile);
+  setenv(SDL_TAP_FILE_VARIABLE, acPath, 1);
+  return acPath;
+}
+
+// -------------------------------------------------------------------
+
+// Return a random number between 0 and 1.
+static LADSPA_Data getRandom(void) {
+  return (LADSPA_Data)rand() / RAND_MAX;
+}
+
+// Choose a random value for every control input port. Delays are
+// mostly a few samples long, everything else ranges over its bounds.
+static void randomiseControls(const LADSPA_Descriptor* psDescriptor,
+			      LADSPA_Data* pfControls) {
+
+  const LADSPA_PortRangeHint* psHint;
+  unsigned long lPort;
+
+  // -----------------------------------------------------------------
+
+  for (lPort = 0; lPort < psDescriptor->PortCount; lPort++) {
+    psHint = psDescriptor->PortRangeHints + lPort;
+    if (!LADSPA_IS_PORT_CONTROL(psDescriptor->PortDescriptors[lPort]))
+      continue;
+    if (strncmp(psDescriptor->PortNames[lPort], "Delay", 5) == 0)
+      pfControls[lPort]
+	= (rand() % 2
+	   ? (LADSPA_Data)(rand() % TEST_MAX_SHORT_DELAY) / TEST_SAMPLE_RATE
+	   : (LADSPA_Data)(getRandom() * TEST_MAX_DELAY));
+    else if (LADSPA_IS_HINT_TOGGLED(psHint->HintDescriptor))
+      pfControls[lPort] = (LADSPA_Data)(rand() % 2);
+    else if (LADSPA_IS_HINT_BOUNDED_BELOW(psHint->HintDescriptor)
+	     && LADSPA_IS_HINT_BOUNDED_ABOVE(psHint->HintDescriptor))
+      pfControls[lPort] = (psHint->LowerBound
+			   + getRandom() * (psHint->UpperBound
+					    - psHint->LowerBound));
+    else
+      pfControls[lPort] = 0;
+    if (LADSPA_IS_HINT_INTEGER(psHint->HintDescriptor))
+      pfControls[lPort] = floorf(pfControls[lPort] + 0.5f);
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Count the audio input and output ports of psDescriptor.
+static void countAudioPorts(const LADSPA_Descriptor* psDescriptor,
+			    unsigned long* plInputCount,
+			    unsigned long* plOutputCount) {
+
+  LADSPA_PortDescriptor iPortDescriptor;
+  unsigned long lPort;
+
+  // -----------------------------------------------------------------
+
+  *plInputCount = 0;
+  *plOutputCount = 0;
+  for (lPort = 0; lPort < psDescriptor->PortCount; lPort++) {
+    iPortDescriptor = psDescriptor->PortDescriptors[lPort];
+    if (!LADSPA_IS_PORT_AUDIO(iPortDescriptor))
+      continue;
+    if (LADSPA_IS_PORT_INPUT(iPortDescriptor))
+      (*plInputCount)++;
+    else
+      (*plOutputCount)++;
+  }
+}
+
+// Connect the ports of an instance. The audio ports are connected to
+// the buffers of ppfInputs and ppfOutputs in port order.
+static void connectPorts(const LADSPA_Descriptor* psDescriptor,
+			 LADSPA_Handle hInstance,
+			 LADSPA_Data* pfControls,
+			 LADSPA_Data** ppfInputs,
+			 LADSPA_Data** ppfOutputs) {
+
+  LADSPA_PortDescriptor iPortDescriptor;
+  unsigned long lPort;
+  unsigned long lInputCount;
+  unsigned long lOutputCount;
+
+  // -----------------------------------------------------------------
+
+  lInputCount = 0;
+  lOutputCount = 0;
+  for (lPort = 0; lPort < psDescriptor->PortCount; lPort++) {
+    iPortDescriptor = psDescriptor->PortDescriptors[lPort];
+    if (LADSPA_IS_PORT_CONTROL(iPortDescriptor))
+      psDescriptor->connect_port(hInstance, lPort, pfControls + lPort);
+    else if (LADSPA_IS_PORT_INPUT(iPortDescriptor))
+      psDescriptor->connect_port(hInstance, lPort,
+				 ppfInputs[lInputCount++]);
+    else
+      psDescriptor->connect_port(hInstance, lPort,
+				 ppfOutputs[lOutputCount++]);
+  }
+}
+
+// Allocate lCount buffers of TEST_MAX_BLOCK_SIZE samples.
+static LADSPA_Data** allocateBuffers(unsigned long lCount) {
+
+  LADSPA_Data** ppfBuffers;
+  unsigned long lBuffer;
+
+  // -----------------------------------------------------------------
+
+  ppfBuffers = malloc(sizeof(LADSPA_Data*) * lCount);
+  for (lBuffer = 0; lBuffer < lCount; lBuffer++)
+    ppfBuffers[lBuffer] = malloc(sizeof(LADSPA_Data) * TEST_MAX_BLOCK_SIZE);
+  return ppfBuffers;
+}
+
+static void freeBuffers(LADSPA_Data** ppfBuffers, unsigned long lCount) {
+
+  unsigned long lBuffer;
+
+  // -----------------------------------------------------------------
+
+  for (lBuffer = 0; lBuffer < lCount; lBuffer++)
+    free(ppfBuffers[lBuffer]);
+  free(ppfBuffers);
+}
+
+// -------------------------------------------------------------------
+
+// Run random blocks through an instance in place and through another
+// one out of place with the kernel set psKernelSet, in adding mode if
+// iAdding is set. In place, each output shares its buffer with the
+// input of the same number, where there is one. Return the number of
+// blocks whose output differs.
+static unsigned long testKernelSet(const LADSPA_Descriptor* psDescriptor,
+				   const KernelSet* psKernelSet,
+				   int iAdding) {
+
+  void (*fnRun)(LADSPA_Handle, unsigned long);
+  LADSPA_Handle hInPlace;
+  LADSPA_Handle hOutOfPlace;
+  LADSPA_Data** ppfInPlaceInputs;
+  LADSPA_Data** ppfInPlaceOutputs;
+  LADSPA_Data** ppfInputs;
+  LADSPA_Data** ppfOutputs;
+  LADSPA_Data* pfControls;
+  LADSPA_Data fGain;
+  int iSilent;
+  unsigned long lInputCount;
+  unsigned long lOutputCount;
+  unsigned long lSharedCount;
+  unsigned long lFailures;
+  unsigned long lBlock;
+  unsigned long lSampleCount;
+  unsigned long lSampleIndex;
+  unsigned long lPort;
+
+  // -----------------------------------------------------------------
+
+  fnRun = iAdding ? psKernelSet->m_fnRunAdding : psKernelSet->m_fnRun;
+  countAudioPorts(psDescriptor, &lInputCount, &lOutputCount);
+  lSharedCount = lInputCount < lOutputCount ? lInputCount : lOutputCount;
+  ppfInPlaceInputs = allocateBuffers(lInputCount);
+  ppfInPlaceOutputs = allocateBuffers(lOutputCount);
+  ppfInputs = allocateBuffers(lInputCount);
+  ppfOutputs = allocateBuffers(lOutputCount);
+  for (lPort = 0; lPort < lSharedCount; lPort++) {
+    free(ppfInPlaceOutputs[lPort]);
+    ppfInPlaceOutputs[lPort] = ppfInPlaceInputs[lPort];
+  }
+  pfControls = calloc(psDescriptor->PortCount, sizeof(LADSPA_Data));
+
+  hInPlace = psDescriptor->instantiate(psDescriptor, TEST_SAMPLE_RATE);
+  hOutOfPlace = psDescriptor->instantiate(psDescriptor, TEST_SAMPLE_RATE);
+  connectPorts(psDescriptor, hInPlace, pfControls,
+	       ppfInPlaceInputs, ppfInPlaceOutputs);
+  connectPorts(psDescriptor, hOutOfPlace, pfControls,
+	       ppfInputs, ppfOutputs);
+  psDescriptor->activate(hInPlace);
+  psDescriptor->activate(hOutOfPlace);
+
+  // -----------------------------------------------------------------
+
+  srand(1);
+  lFailures = 0;
+  iSilent = 0;
+
+  for (lBlock = 0; lBlock < TEST_BLOCKS; lBlock++) {
+
+    if (lBlock % 8 == 0) {
+      randomiseControls(psDescriptor, pfControls);
+      iSilent = rand() % 4 == 0;
+    }
+    if (iAdding && lBlock % 8 == 0) {
+      fGain = getRandom();
+      psDescriptor->set_run_adding_gain(hInPlace, fGain);
+      psDescriptor->set_run_adding_gain(hOutOfPlace, fGain);
+    }
+
+    // Favour the block sizes of real hosts, but also try odd ones.
+    lSampleCount = (rand() % 3
+		    ? 32ul << (rand() % 7)
+		    : 1 + (unsigned long)rand() % TEST_MAX_BLOCK_SIZE);
+
+    // In adding mode the outputs start out as copies of the inputs,
+    // as they do in place.
+    for (lPort = 0; lPort < lInputCount; lPort++)
+      for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+	ppfInputs[lPort][lSampleIndex] = iSilent ? 0 : getRandom() - 0.5f;
+	ppfInPlaceInputs[lPort][lSampleIndex]
+	  = ppfInputs[lPort][lSampleIndex];
+      }
+    for (lPort = 0; lPort < lOutputCount; lPort++)
+      for (lSampleIndex = 0; lSampleIndex < lSampleCount; lSampleIndex++) {
+	ppfOutputs[lPort][lSampleIndex]
+	  = (lPort < lSharedCount
+	     ? ppfInputs[lPort][lSampleIndex]
+	     : getRandom() - 0.5f);
+	ppfInPlaceOutputs[lPort][lSampleIndex]
+	  = ppfOutputs[lPort][lSampleIndex];
+      }
+
+    fnRun(hInPlace, lSampleCount);
+    fnRun(hOutOfPlace, lSampleCount);
+
+    for (lPort = 0; lPort < lOutputCount; lPort++)
+      if (memcmp(ppfInPlaceOutputs[lPort], ppfOutputs[lPort],
+		 sizeof(LADSPA_Data) * lSampleCount) != 0) {
+	lFailures++;
+	break;
+      }
+  }
+
+  // -----------------------------------------------------------------
+
+  psDescriptor->cleanup(hInPlace);
+  psDescriptor->cleanup(hOutOfPlace);
+  for (lPort = 0; lPort < lSharedCount; lPort++)
+    ppfInPlaceOutputs[lPort] = NULL;
+  freeBuffers(ppfInPlaceInputs, lInputCount);
+  freeBuffers(ppfInPlaceOutputs, lOutputCount);
+  freeBuffers(ppfInputs, lInputCount);
+  freeBuffers(ppfOutputs, lOutputCount);
+  free(pfControls);
+  return lFailures;
+}
+
+// -------------------------------------------------------------------
+
+int main(void) {
+
+  const LADSPA_Descriptor* psDescriptor;
+  const PluginCore* psCore;
+  char* pcTapFile;
+  unsigned long lIndex;
+  unsigned long lKernelSet;
+  unsigned long lFailures;
+  unsigned long lTotalFailures;
+  int iAdding;
+
+  // -----------------------------------------------------------------
+
+  pcTapFile = writeTapFile();
+  if (pcTapFile == NULL) {
+    fprintf(stderr, "Unable to write the tap file.\n");
+    return 1;
+  }
+
+  lTotalFailures = 0;
+  for (lIndex = 0; (psDescriptor = ladspa_descriptor(lIndex)); lIndex++) {
+    psCore = findPluginCore(psDescriptor);
+    if (psCore == NULL) {
+      printf("%-40s no kernel sets known\n", psDescriptor->Label);
+      lTotalFailures++;
+      continue;
+    }
+    for (lKernelSet = 0; lKernelSet < TEST_KERNEL_SET_COUNT; lKernelSet++) {
+      if (!isKernelSetSupported(lKernelSet))
+	continue;
+      for (iAdding = 0; iAdding < 2; iAdding++) {
+	lFailures = testKernelSet(psDescriptor,
+				  psCore->m_asKernelSets + lKernelSet,
+				  iAdding);
+	printf("%-40s %-7s %-10s %s\n",
+	       psDescriptor->Label,
+	       psCore->m_asKernelSets[lKernelSet].m_pcName,
+	       iAdding ? "run_adding" : "run",
+	       lFailures ? "FAILED" : "ok");
+	lTotalFailures += lFailures;
+      }
+    }
+  }
+
+  unlink(pcTapFile);
+  if (lTotalFailures) {
+    printf("%lu blocks differ between in-place and out-of-place "
+	   "output.\n", lTotalFailures);
+    return 1;
+  }
+  return 0;
+}
+
+// -------------------------------------------------------------------